@@ -1,5 +1,8 @@
 #include "include/cmd_tree.h"
 
+#include <errno.h>
+#include <math.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -33,53 +36,414 @@ int cmd_tree_node_add_child(cmd_tree_node_t *n, cmd_tree_node_t *child) {
     return cmd_tree_node_add_sibling(n->child, child);
 }
 
-int cmd_tree_search_assign_args(cmd_tree_node_t *root, int i, int argc,
-                                char **argv) {
+static int cmd_tree_node_name_cmp(const void *a, const void *b) {
+    const cmd_tree_node_t *na = *(cmd_tree_node_t *const *)a;
+    const cmd_tree_node_t *nb = *(cmd_tree_node_t *const *)b;
+    return strcmp(na->name, nb->name);
+}
+
+int cmd_tree_compile(cmd_tree_node_t *root) {
+    cmd_tree_node_t *child;
+    uint16_t n = 0;
+
+    if (!root) {
+        return -1;
+    }
+
+    free(root->children);
+    root->children = NULL;
+    root->children_n = 0;
+
+    for (child = root->child; child; child = child->sibling) n++;
+    if (n == 0) return 1;
+
+    root->children = calloc(n, sizeof(*root->children));
+    if (!root->children) return -1;
+
+    n = 0;
+    for (child = root->child; child; child = child->sibling)
+        root->children[n++] = child;
+
+    qsort(root->children, n, sizeof(*root->children), cmd_tree_node_name_cmp);
+
+    // two siblings with the same name would make one of them unreachable.
+    for (uint16_t i = 1; i < n; i++) {
+        if (strcmp(root->children[i - 1]->name, root->children[i]->name) ==
+            0) {
+            fprintf(stderr, "cmd_tree: duplicate command \"%s\"\n",
+                    root->children[i]->name);
+            free(root->children);
+            root->children = NULL;
+            return -1;
+        }
+    }
+    root->children_n = n;
+
+    for (uint16_t i = 0; i < n; i++)
+        if (cmd_tree_compile(root->children[i]) != 1) return -1;
 
-    root->argv = argv + i;
-    root->argc = argc - i;
     return 1;
 }
 
-// recursively search for nodes which matches the latter most token in argv.
-// we enter here only when argc > 0.
-void cmd_tree_search_recur(cmd_tree_node_t *cur, int i, int argc, char *argv[],
-                           cmd_tree_node_t **node) {
-    // out of argv bounds, backtrack.
-    if (i == argc) return;
+static cmd_tree_node_t *cmd_tree_find_child(cmd_tree_node_t *n,
+                                            const char *name) {
+    // compiled, binary search the sorted children.
+    if (n->children) {
+        int lo = 0;
+        int hi = n->children_n - 1;
+        while (lo <= hi) {
+            int mid = lo + (hi - lo) / 2;
+            int cmp = strcmp(name, n->children[mid]->name);
+            if (cmp == 0) return n->children[mid];
+            if (cmp < 0)
+                hi = mid - 1;
+            else
+                lo = mid + 1;
+        }
+        return NULL;
+    }
 
-    char *token = argv[i];
+    for (cmd_tree_node_t *child = n->child; child; child = child->sibling)
+        if (strcmp(child->name, name) == 0) return child;
 
-    cmd_tree_node_t *child = cur->child;
+    return NULL;
+}
 
-    while (child) {
-        if (strcmp(child->name, token) == 0) {
-            *node = child;
-			// assign all trailing arguments to the child node.
-            cmd_tree_search_assign_args(child, i + 1, argc, argv);
-            cmd_tree_search_recur(child, i + 1, argc, argv, node);
-            break;
-        }
-        child = child->sibling;
+int cmd_tree_resolve(cmd_tree_node_t *root, int argc, char *argv[],
+                     cmd_tree_match_t *match) {
+    cmd_tree_node_t *cur = root;
+    int i = 0;
+
+    if (!root || !match || argc < 0) {
+        return -1;
     }
 
-    return;
+    // walk down as long as tokens name a child, whatever is left over are
+    // the matched command's arguments.
+    for (; i < argc; i++) {
+        cmd_tree_node_t *next = cmd_tree_find_child(cur, argv[i]);
+        if (!next) break;
+        cur = next;
+    }
+
+    match->node = cur;
+    match->argc = argc - i;
+    match->argv = argv + i;
+    return 1;
 }
 
 int cmd_tree_search(cmd_tree_node_t *root, int argc, char *argv[],
                     cmd_tree_node_t **cmd_node) {
-    if (!root) {
+    cmd_tree_match_t match;
+
+    if (cmd_tree_resolve(root, argc, argv, &match) != 1) {
         return -1;
     }
 
-	*cmd_node = root;
+    // assign all trailing arguments to the matched node.
+    match.node->argv = match.argv;
+    match.node->argc = match.argc;
+    *cmd_node = match.node;
+    return 1;
+}
+
+static void cmd_tree_error(char *err, size_t err_len, const char *fmt, ...) {
+    va_list ap;
 
-	// if there's no arguments just return root
-    if (argc == 0) {
-		root->argc = 0;
-        return 1;
+    if (!err || err_len == 0) return;
+
+    va_start(ap, fmt);
+    vsnprintf(err, err_len, fmt, ap);
+    va_end(ap);
+}
+
+static int cmd_tree_validate_arg(const cmd_tree_arg_t *spec, const char *val,
+                                 char *err, size_t err_len) {
+    char *end = NULL;
+    double v;
+    int bounded = spec->min != spec->max;
+
+    switch (spec->type) {
+        case CMD_TREE_ARG_STRING:
+            return 1;
+        case CMD_TREE_ARG_INT:
+            errno = 0;
+            v = (double)strtol(val, &end, 10);
+            if (errno || end == val || *end != '\0') {
+                cmd_tree_error(err, err_len,
+                               "%s must be an integer, got \"%s\"", spec->name,
+                               val);
+                return -1;
+            }
+            break;
+        case CMD_TREE_ARG_FLOAT:
+            errno = 0;
+            v = strtod(val, &end);
+            if (errno || end == val || *end != '\0' || isnan(v)) {
+                cmd_tree_error(err, err_len, "%s must be a number, got \"%s\"",
+                               spec->name, val);
+                return -1;
+            }
+            break;
+        case CMD_TREE_ARG_ENUM:
+            for (const char *const *c = spec->choices; c && *c; c++)
+                if (strcmp(*c, val) == 0) return 1;
+            cmd_tree_error(err, err_len, "%s does not accept \"%s\"",
+                           spec->name, val);
+            return -1;
+        default:
+            return -1;
+    }
+
+    if (bounded && (v < spec->min || v > spec->max)) {
+        cmd_tree_error(err, err_len, "%s must be between %g and %g, got %s",
+                       spec->name, spec->min, spec->max, val);
+        return -1;
+    }
+    return 1;
+}
+
+int cmd_tree_validate(const cmd_tree_match_t *match, char *err,
+                      size_t err_len) {
+    const cmd_tree_node_t *node;
+
+    if (!match || !match->node) {
+        return -1;
+    }
+    node = match->node;
+
+    // a command without an arg spec takes no arguments, anything trailing is
+    // an unknown subcommand or a typo.
+    if (!node->args) {
+        if (match->argc == 0) return 1;
+        if (node->child)
+            cmd_tree_error(err, err_len, "unknown command \"%s\"%s%s",
+                           match->argv[0], node->name[0] ? " for " : "",
+                           node->name);
+        else
+            cmd_tree_error(err, err_len, "%s takes no arguments, got \"%s\"",
+                           node->name, match->argv[0]);
+        return -1;
+    }
+
+    if (match->argc != node->args_n) {
+        cmd_tree_error(err, err_len, "%s expects %d argument(s), got %d",
+                       node->name, node->args_n, match->argc);
+        return -1;
+    }
+
+    for (int i = 0; i < node->args_n; i++)
+        if (cmd_tree_validate_arg(&node->args[i], match->argv[i], err,
+                                  err_len) != 1)
+            return -1;
+
+    return 1;
+}
+
+static const char *cmd_tree_arg_type_str(cmd_tree_arg_type type) {
+    switch (type) {
+        case CMD_TREE_ARG_STRING:
+            return "string";
+        case CMD_TREE_ARG_INT:
+            return "int";
+        case CMD_TREE_ARG_FLOAT:
+            return "float";
+        case CMD_TREE_ARG_ENUM:
+            return "enum";
+    }
+    return "unknown";
+}
+
+// Appends " name" to the command path in `path` of length `len`, returns the
+// new length or 0 if the path would not fit.
+static size_t cmd_tree_path_push(char *path, size_t len, const char *name) {
+    size_t name_len = strlen(name);
+    size_t sep = len > 0 ? 1 : 0;
+
+    if (len + sep + name_len + 1 > CMD_TREE_MAX_PATH) return 0;
+    if (sep) path[len] = ' ';
+    memcpy(path + len + sep, name, name_len + 1);
+    return len + sep + name_len;
+}
+
+static void cmd_tree_dump_commands_recur(const cmd_tree_node_t *n, char *path,
+                                         size_t len, FILE *out) {
+    // the root node has no name and is not a command of its own.
+    if (len > 0) {
+        fprintf(out, "%s\t", path);
+        for (int i = 0; i < n->args_n; i++) {
+            const cmd_tree_arg_t *arg = &n->args[i];
+            fprintf(out, "%s%s:%s", i ? " " : "", arg->name,
+                    cmd_tree_arg_type_str(arg->type));
+            if (arg->type == CMD_TREE_ARG_ENUM) {
+                for (const char *const *c = arg->choices; c && *c; c++)
+                    fprintf(out, "%c%s", c == arg->choices ? ':' : ',', *c);
+            } else if (arg->min != arg->max) {
+                fprintf(out, ":%g:%g", arg->min, arg->max);
+            }
+        }
+        fprintf(out, "\t%s\n", n->help ? n->help : "");
+    }
+
+    for (const cmd_tree_node_t *c = n->child; c; c = c->sibling) {
+        size_t l = cmd_tree_path_push(path, len, c->name);
+        if (!l) continue;
+        cmd_tree_dump_commands_recur(c, path, l, out);
+        path[len] = '\0';
+    }
+}
+
+void cmd_tree_dump_commands(const cmd_tree_node_t *root, FILE *out) {
+    char path[CMD_TREE_MAX_PATH] = {0};
+
+    if (!root || !out) return;
+    cmd_tree_dump_commands_recur(root, path, 0, out);
+}
+
+enum cmd_tree_shell {
+    CMD_TREE_SHELL_BASH,
+    CMD_TREE_SHELL_ZSH,
+    CMD_TREE_SHELL_FISH,
+};
+
+// Writes the words completing the command at `path` for bash and zsh case
+// arms: the node's children, or the choices of its first argument.
+static void cmd_tree_dump_words(const cmd_tree_node_t *n, FILE *out) {
+    int first = 1;
+
+    for (const cmd_tree_node_t *c = n->child; c; c = c->sibling) {
+        fprintf(out, "%s%s", first ? "" : " ", c->name);
+        first = 0;
+    }
+    if (n->args_n > 0 && n->args[0].type == CMD_TREE_ARG_ENUM) {
+        for (const char *const *c = n->args[0].choices; c && *c; c++) {
+            fprintf(out, "%s%s", first ? "" : " ", *c);
+            first = 0;
+        }
+    }
+}
+
+static void cmd_tree_dump_completion_recur(const cmd_tree_node_t *n,
+                                           const char *prog, const char *fn,
+                                           char *path, size_t len,
+                                           enum cmd_tree_shell sh, FILE *out) {
+    int has_words =
+        n->child || (n->args_n > 0 && n->args[0].type == CMD_TREE_ARG_ENUM);
+
+    if (has_words) {
+        switch (sh) {
+            case CMD_TREE_SHELL_BASH:
+                fprintf(out, "        \"%s\") words=\"", path);
+                cmd_tree_dump_words(n, out);
+                fprintf(out, "\" ;;\n");
+                break;
+            case CMD_TREE_SHELL_ZSH:
+                fprintf(out, "        \"%s\") opts=(", path);
+                cmd_tree_dump_words(n, out);
+                fprintf(out, ") ;;\n");
+                break;
+            case CMD_TREE_SHELL_FISH:
+                for (const cmd_tree_node_t *c = n->child; c; c = c->sibling) {
+                    fprintf(out, "complete -c %s -n '%s_at \"%s\"' -a '%s'",
+                            prog, fn, path, c->name);
+                    if (c->help) fprintf(out, " -d '%s'", c->help);
+                    fprintf(out, "\n");
+                }
+                if (n->args_n > 0 && n->args[0].type == CMD_TREE_ARG_ENUM) {
+                    for (const char *const *c = n->args[0].choices; c && *c;
+                         c++)
+                        fprintf(out,
+                                "complete -c %s -n '%s_at \"%s\"' -a '%s'\n",
+                                prog, fn, path, *c);
+                }
+                break;
+        }
+    }
+
+    for (const cmd_tree_node_t *c = n->child; c; c = c->sibling) {
+        size_t l = cmd_tree_path_push(path, len, c->name);
+        if (!l) continue;
+        cmd_tree_dump_completion_recur(c, prog, fn, path, l, sh, out);
+        path[len] = '\0';
+    }
+}
+
+int cmd_tree_dump_completion(const cmd_tree_node_t *root, const char *prog,
+                             const char *shell, FILE *out) {
+    char path[CMD_TREE_MAX_PATH] = {0};
+    char fn[CMD_TREE_MAX_NAME + 2] = "__";
+    enum cmd_tree_shell sh;
+
+    if (!root || !prog || !shell || !out) {
+        return -1;
+    }
+
+    if (strcmp(shell, "bash") == 0)
+        sh = CMD_TREE_SHELL_BASH;
+    else if (strcmp(shell, "zsh") == 0)
+        sh = CMD_TREE_SHELL_ZSH;
+    else if (strcmp(shell, "fish") == 0)
+        sh = CMD_TREE_SHELL_FISH;
+    else
+        return -1;
+
+    // shell function names can't hold every character a program name can,
+    // fn is "__<prog>" with anything not alphanumeric replaced by '_'.
+    strncat(fn, prog, CMD_TREE_MAX_NAME - 1);
+    for (char *p = fn + 2; *p; p++)
+        if (!((*p >= 'a' && *p <= 'z') || (*p >= 'A' && *p <= 'Z') ||
+              (*p >= '0' && *p <= '9')))
+            *p = '_';
+
+    switch (sh) {
+        case CMD_TREE_SHELL_BASH:
+            fprintf(out,
+                    "%s() {\n"
+                    "    local cur=\"${COMP_WORDS[COMP_CWORD]}\"\n"
+                    "    local cmdpath=\"${COMP_WORDS[*]:1:COMP_CWORD-1}\"\n"
+                    "    local words=\"\"\n"
+                    "    case \"$cmdpath\" in\n",
+                    fn);
+            cmd_tree_dump_completion_recur(root, prog, fn, path, 0, sh, out);
+            fprintf(out,
+                    "    esac\n"
+                    "    COMPREPLY=($(compgen -W \"$words\" -- \"$cur\"))\n"
+                    "}\n"
+                    "complete -F %s %s\n",
+                    fn, prog);
+            break;
+        case CMD_TREE_SHELL_ZSH:
+            fprintf(out,
+                    "#compdef %s\n"
+                    "%s() {\n"
+                    "    local cmdpath=\"${(j: :)words[2,CURRENT-1]}\"\n"
+                    "    local -a opts\n"
+                    "    case \"$cmdpath\" in\n",
+                    prog, fn);
+            cmd_tree_dump_completion_recur(root, prog, fn, path, 0, sh, out);
+            fprintf(out,
+                    "    esac\n"
+                    "    compadd -a opts\n"
+                    "}\n"
+                    "if [ \"${funcstack[1]}\" = \"_%s\" ]; then\n"
+                    "    %s \"$@\"\n"
+                    "else\n"
+                    "    compdef %s %s\n"
+                    "fi\n",
+                    prog, fn, fn, prog);
+            break;
+        case CMD_TREE_SHELL_FISH:
+            fprintf(out,
+                    "function %s_at -a want\n"
+                    "    set -l tokens (commandline -opc)\n"
+                    "    set -l got (string join ' ' -- $tokens[2..-1])\n"
+                    "    test \"$got\" = \"$want\"\n"
+                    "end\n"
+                    "complete -c %s -f\n",
+                    fn, prog);
+            cmd_tree_dump_completion_recur(root, prog, fn, path, 0, sh, out);
+            break;
     }
 
-    cmd_tree_search_recur(root, 0, argc, argv, cmd_node);
     return 1;
 }
@@ -1,10 +1,15 @@
 #pragma once
 #ifndef CMD_TREE_H
 #define CMD_TREE_H
+#include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #define CMD_TREE_MAX_NAME 256
 
+// Maximum length of a space separated command path, e.g. "volume set".
+#define CMD_TREE_MAX_PATH 1024
+
 /**
  * Function pointer which implements a node's command.
  * @param ctx A pointer to application specific context.
@@ -13,6 +18,35 @@
  */
 typedef int (*cmd_tree_node_exec)(void *ctx, uint8_t argc, char **argv);
 
+/**
+ * The type of a command's positional argument.
+ */
+typedef enum cmd_tree_arg_type {
+    // Any string.
+    CMD_TREE_ARG_STRING,
+    // A base 10 integer, bounded by min and max if they differ.
+    CMD_TREE_ARG_INT,
+    // A floating point number, bounded by min and max if they differ.
+    CMD_TREE_ARG_FLOAT,
+    // One of the strings in choices.
+    CMD_TREE_ARG_ENUM,
+} cmd_tree_arg_type;
+
+/**
+ * Describes a positional argument of a command, used to validate arguments
+ * before the command is exec'd and to generate shell completions.
+ */
+typedef struct cmd_tree_arg {
+    // Name of the argument as displayed in usage and command listings.
+    const char *name;
+    cmd_tree_arg_type type;
+    // Inclusive bounds for CMD_TREE_ARG_INT and CMD_TREE_ARG_FLOAT.
+    double min;
+    double max;
+    // NULL terminated list of accepted values for CMD_TREE_ARG_ENUM.
+    const char *const *choices;
+} cmd_tree_arg_t;
+
 /**
  * A node in the cmd_tree.
  */
@@ -29,8 +63,33 @@ typedef struct cmd_tree_node {
     uint8_t argc;
     // Name of the command
     char name[CMD_TREE_MAX_NAME];
+    // One line description of the command, optional.
+    const char *help;
+    // Positional arguments the command requires. If NULL the command takes
+    // no arguments and cmd_tree_validate rejects any trailing ones.
+    const cmd_tree_arg_t *args;
+    // Number of entries in args.
+    uint8_t args_n;
+    // Application specific flags, not interpreted by cmd_tree.
+    uint32_t flags;
+    // Children sorted by name, built by cmd_tree_compile.
+    struct cmd_tree_node **children;
+    // Number of entries in children.
+    uint16_t children_n;
 } cmd_tree_node_t;
 
+/**
+ * The result of resolving a command line against a cmd_tree.
+ */
+typedef struct cmd_tree_match {
+    // The deepest node matched by the command line.
+    cmd_tree_node_t *node;
+    // Number of trailing arguments after the matched node.
+    int argc;
+    // The trailing arguments after the matched node.
+    char **argv;
+} cmd_tree_match_t;
+
 /**
  * Adds a child node to a given node in the cmd_tree.
  *
@@ -56,4 +115,74 @@ int cmd_tree_node_add_child(cmd_tree_node_t *n, cmd_tree_node_t *child);
 int cmd_tree_search(cmd_tree_node_t *root, int argc, char *argv[],
                     cmd_tree_node_t **cmd_node);
 
+/**
+ * Compiles the cmd_tree rooted at @root into a lookup friendly form.
+ *
+ * Each node's children are collected into an array sorted by name, so
+ * resolving a command is a binary search per level instead of a walk over
+ * every sibling. Must be called again if nodes are added afterwards.
+ *
+ * @param root The root node of the cmd_tree to compile.
+ *
+ * @return 1 on success, -1 on allocation failure or if two siblings share a
+ * name.
+ */
+int cmd_tree_compile(cmd_tree_node_t *root);
+
+/**
+ * Resolves a command line to the deepest matching node.
+ *
+ * Unlike cmd_tree_search, the trailing arguments are returned in @match and
+ * the tree's nodes are not modified. Uses the compiled form if
+ * cmd_tree_compile was called, otherwise walks siblings.
+ *
+ * @param root The root node of the cmd_tree to search from.
+ * @param argc The length of argv.
+ * @param argv An array of string pointers of size @argc
+ * @param match Filled with the matched node and its trailing arguments.
+ *
+ * @return 1 on success and -1 if an error occurred.
+ */
+int cmd_tree_resolve(cmd_tree_node_t *root, int argc, char *argv[],
+                     cmd_tree_match_t *match);
+
+/**
+ * Validates the trailing arguments of @match against its node's argument
+ * specs.
+ *
+ * @param match A match returned by cmd_tree_resolve.
+ * @param err Buffer a description of the first invalid argument is written
+ * to, may be NULL.
+ * @param err_len Size of @err.
+ *
+ * @return 1 if the arguments are valid, -1 otherwise.
+ */
+int cmd_tree_validate(const cmd_tree_match_t *match, char *err,
+                      size_t err_len);
+
+/**
+ * Writes a machine readable listing of every command to @out.
+ *
+ * One command per line, tab separated: the space separated command path, its
+ * argument specs as "name:type[:min:max|:choice,choice]" separated by spaces,
+ * and its help text.
+ *
+ * @param root The root node of the cmd_tree.
+ * @param out The stream to write to.
+ */
+void cmd_tree_dump_commands(const cmd_tree_node_t *root, FILE *out);
+
+/**
+ * Writes a completion script for @shell to @out.
+ *
+ * @param root The root node of the cmd_tree.
+ * @param prog The name of the program being completed.
+ * @param shell One of "bash", "zsh" or "fish".
+ * @param out The stream to write to.
+ *
+ * @return 1 on success, -1 if @shell is not supported.
+ */
+int cmd_tree_dump_completion(const cmd_tree_node_t *root, const char *prog,
+                             const char *shell, FILE *out);
+
 #endif  // CMD_TREE_H
@@ -21,11 +21,24 @@ typedef struct _AppSwitcher {
     GtkScrolledWindow *scrolled;
     GtkBox *app_widget_list;
     GtkEventController *key_controller;
-    int widget_n;
+    // AppSwitcherAppWidget(s) keyed by their app_id.
+    GHashTable *widgets_by_app_id;
+    // AppSwitcherAppWidget(s) in most recently activated order, the order of
+    // app_widget_list's children is derived from this array.
+    GPtrArray *mru;
     gint focused_index;
     gchar *last_activated_app;
     gpointer last_activated_instance;
     gboolean select_alternative_app;
+    // newest toplevel requested for preview, activated on the next frame.
+    gpointer preview_toplevel;
+    // tick callback driving preview activations, 0 when idle.
+    guint preview_tick_id;
+    // whether the switcher is shown and activating toplevels for preview.
+    gboolean previewing;
+    // toplevels whose state changed while previewing, their activation is
+    // applied to the MRU order once previewing ends.
+    GHashTable *preview_deferred;
 } AppSwitcher;
 
 static guint app_switcher_signals[signals_n] = {0};
@@ -48,9 +61,15 @@ static void app_switcher_class_init(AppSwitcherClass *klass) {
 
 static void app_switcher_init_layout(AppSwitcher *self);
 
+static void app_switcher_cancel_preview(AppSwitcher *self);
+
 static void on_window_destroy(GtkWindow *win, AppSwitcher *self) {
     g_debug("activities.c:on_window_destroy called");
 
+    // tick callbacks go with the window.
+    self->preview_tick_id = 0;
+    self->preview_toplevel = NULL;
+
     WaylandKSIService *ksi = wayland_ksi_service_get_global();
     wayland_ksi_inhibit_destroy(ksi);
 
@@ -61,46 +80,27 @@ static void on_window_destroy(GtkWindow *win, AppSwitcher *self) {
 
 AppSwitcherAppWidget *app_switcher_get_widget_at_index(AppSwitcher *self,
                                                        int i) {
-    int ii = 0;
-
-    AppSwitcherAppWidget *app_widget = NULL;
-
-    GtkWidget *w =
-        gtk_widget_get_first_child(GTK_WIDGET(self->app_widget_list));
-    while (w) {
-        if (ii == i) {
-            app_widget = g_object_get_data(G_OBJECT(w), "app-widget");
-            break;
-        }
-        w = gtk_widget_get_next_sibling(w);
-        ii++;
-    }
-
-    return app_widget;
+    if (i < 0 || (guint)i >= self->mru->len) return NULL;
+    return g_ptr_array_index(self->mru, i);
 }
 
-gint app_switcher_find_widget_by_app_id(AppSwitcher *self, gchar *app_id,
-                                        AppSwitcherAppWidget **widget) {
-    int ii = 0;
-
-    AppSwitcherAppWidget *app_widget = NULL;
-
-    GtkWidget *w =
-        gtk_widget_get_first_child(GTK_WIDGET(self->app_widget_list));
-    while (w) {
-        app_widget = g_object_get_data(G_OBJECT(w), "app-widget");
+AppSwitcherAppWidget *app_switcher_find_widget_by_app_id(AppSwitcher *self,
+                                                         gchar *app_id) {
+    return g_hash_table_lookup(self->widgets_by_app_id, app_id);
+}
 
-        if (strcmp(app_switcher_app_widget_get_app_id(app_widget), app_id) ==
-            0) {
-            *widget = app_widget;
-            return ii;
-        }
+// Moves `widget` to the front of the MRU array and the app widget list.
+static void app_switcher_promote_widget(AppSwitcher *self,
+                                        AppSwitcherAppWidget *widget) {
+    if (self->mru->len > 0 && g_ptr_array_index(self->mru, 0) == widget)
+        return;
 
-        w = gtk_widget_get_next_sibling(w);
-        ii++;
-    }
+    g_ptr_array_remove(self->mru, widget);
+    g_ptr_array_insert(self->mru, 0, widget);
 
-    return -1;
+    gtk_box_reorder_child_after(self->app_widget_list,
+                                app_switcher_app_widget_get_widget(widget),
+                                NULL);
 }
 
 static void app_switcher_activate_widget_at_index(AppSwitcher *self,
@@ -116,9 +116,20 @@ static void app_switcher_activate_widget_at_index(AppSwitcher *self,
 static void on_top_level_changed(WaylandForeignToplevelService *wayland,
                                  GHashTable *toplevels,
                                  WaylandWLRForeignTopLevel *toplevel,
-                                 AppSwitcher *self) {
-    AppSwitcherAppWidget *app_widget = NULL;
-    app_switcher_find_widget_by_app_id(self, toplevel->app_id, &app_widget);
+                                 guint changes, AppSwitcher *self) {
+    // previews activate toplevels as the user cycles, reordering the list
+    // under them. defer state changes until previewing ends, everything else
+    // is applied right away.
+    if (self->previewing && (changes & TOPLEVEL_CHANGE_STATE)) {
+        g_hash_table_add(self->preview_deferred, toplevel);
+        changes &= ~TOPLEVEL_CHANGE_STATE;
+    }
+
+    // the switcher does not care which output a toplevel is on.
+    if (!(changes & ~TOPLEVEL_CHANGE_OUTPUT)) return;
+
+    AppSwitcherAppWidget *app_widget =
+        app_switcher_find_widget_by_app_id(self, toplevel->app_id);
 
     if (!app_widget) {
         g_debug(
@@ -130,16 +141,20 @@ static void on_top_level_changed(WaylandForeignToplevelService *wayland,
 
         gtk_box_append(self->app_widget_list,
                        app_switcher_app_widget_get_widget(app_widget));
-
-        self->widget_n++;
+        g_ptr_array_add(self->mru, app_widget);
     }
 
-    app_switcher_app_widget_add_toplevel(app_widget, toplevel);
+    app_switcher_app_widget_add_toplevel(app_widget, toplevel, changes);
 
-    if (toplevel->activated) {
-        gtk_box_reorder_child_after(
-            self->app_widget_list,
-            app_switcher_app_widget_get_widget(app_widget), NULL);
+    // the app widget takes its app_id from its first toplevel, index it once
+    // that is set.
+    if (!g_hash_table_contains(self->widgets_by_app_id, toplevel->app_id))
+        g_hash_table_insert(self->widgets_by_app_id,
+                            app_switcher_app_widget_get_app_id(app_widget),
+                            app_widget);
+
+    if ((changes & TOPLEVEL_CHANGE_STATE) && toplevel->activated) {
+        app_switcher_promote_widget(self, app_widget);
 
         // a bit subtle but this checks to see if the latest activated app
         // matches the previously activated app, but a different instance of it.
@@ -168,13 +183,19 @@ static void app_switcher_focus_widget_at_index(AppSwitcher *self, gint index);
 static void on_top_level_removed(WaylandForeignToplevelService *wayland,
                                  WaylandWLRForeignTopLevel *toplevel,
                                  AppSwitcher *self) {
+    // the pending preview would activate a destroyed handle on the next frame.
+    if (self->preview_toplevel && self->preview_toplevel == toplevel->toplevel)
+        app_switcher_cancel_preview(self);
+
+    g_hash_table_remove(self->preview_deferred, toplevel);
+
     if (toplevel->app_id == NULL) {
         g_critical("app_switcher.c:on_top_level_removed: app_id is NULL");
         return;
     }
 
-    AppSwitcherAppWidget *widget = NULL;
-    app_switcher_find_widget_by_app_id(self, toplevel->app_id, &widget);
+    AppSwitcherAppWidget *widget =
+        app_switcher_find_widget_by_app_id(self, toplevel->app_id);
 
     if (!widget) return;
 
@@ -182,13 +203,24 @@ static void on_top_level_removed(WaylandForeignToplevelService *wayland,
 
     if (!purge) return;
 
+    // the app widget's app_id keys the hash table, drop it from the model
+    // before removing the widget from the list finalizes it.
+    g_hash_table_remove(self->widgets_by_app_id,
+                        app_switcher_app_widget_get_app_id(widget));
+    g_ptr_array_remove(self->mru, widget);
+
     gtk_box_remove(self->app_widget_list,
                    app_switcher_app_widget_get_widget(widget));
-
-    self->widget_n--;
 }
 
 static void app_switcher_init_layout(AppSwitcher *self) {
+    // the layout is rebuilt when the window is destroyed, the old app widgets
+    // go with it.
+    g_hash_table_remove_all(self->widgets_by_app_id);
+    g_ptr_array_set_size(self->mru, 0);
+    self->previewing = false;
+    g_hash_table_remove_all(self->preview_deferred);
+
     self->win = ADW_WINDOW(adw_window_new());
     gtk_widget_set_hexpand(GTK_WIDGET(self->win), true);
     gtk_widget_set_vexpand(GTK_WIDGET(self->win), true);
@@ -235,10 +267,15 @@ static void app_switcher_init_layout(AppSwitcher *self) {
     GList *values = g_hash_table_get_values(toplevels);
     for (GList *l = values; l != NULL; l = l->next) {
         WaylandWLRForeignTopLevel *toplevel = l->data;
-        on_top_level_changed(wayland, toplevels, toplevel, self);
+        if (!toplevel->advertised) continue;
+        on_top_level_changed(wayland, toplevels, toplevel, TOPLEVEL_CHANGE_ALL,
+                             self);
     }
     g_list_free(values);
 
+    // drop handlers connected by a previous layout.
+    g_signal_handlers_disconnect_by_data(wayland, self);
+
     g_signal_connect(wayland, "top-level-changed",
                      G_CALLBACK(on_top_level_changed), self);
 
@@ -247,29 +284,28 @@ static void app_switcher_init_layout(AppSwitcher *self) {
 }
 
 void app_switcher_unfocus_widget_all(AppSwitcher *self) {
-    GtkWidget *w =
-        gtk_widget_get_first_child(GTK_WIDGET(self->app_widget_list));
-    while (w) {
-        AppSwitcherAppWidget *widget =
-            g_object_get_data(G_OBJECT(w), "app-widget");
-        app_switcher_app_widget_unset_focus(widget);
-        w = gtk_widget_get_next_sibling(w);
-    }
+    for (guint i = 0; i < self->mru->len; i++)
+        app_switcher_app_widget_unset_focus(g_ptr_array_index(self->mru, i));
 }
 
+// Only the widget at focused_index can hold focus, unfocusing it is enough to
+// clear focus from the whole list.
 static void app_switcher_unfocus_widget_all_with_focus_reset(
     AppSwitcher *self) {
-    app_switcher_unfocus_widget_all(self);
+    AppSwitcherAppWidget *widget =
+        app_switcher_get_widget_at_index(self, self->focused_index);
+    if (widget) app_switcher_app_widget_unset_focus(widget);
     self->focused_index = -1;
 }
 
 static void app_switcher_focus_widget_at_index(AppSwitcher *self, gint index) {
     app_switcher_unfocus_widget_all_with_focus_reset(self);
 
-    self->focused_index = index;
-
     AppSwitcherAppWidget *widget =
         app_switcher_get_widget_at_index(self, index);
+    if (!widget) return;
+
+    self->focused_index = index;
 
     // don't automatically focus previous instance of selected app, this
     // avoids the case where switching between two apps also swaps the most
@@ -289,7 +325,7 @@ static void select_next(AppSwitcher *self) {
 
     gint index = self->focused_index;
     index++;
-    if (index >= self->widget_n) {
+    if (index >= (gint)self->mru->len) {
         index = 0;
     }
 
@@ -301,7 +337,7 @@ static void select_previous(AppSwitcher *self) {
     g_debug("app_switcher.c:select_previous: index: %d", index);
     index--;
     if (index < 0) {
-        index = self->widget_n - 1;
+        index = self->mru->len - 1;
     }
 
     app_switcher_focus_widget_at_index(self, index);
@@ -316,6 +352,7 @@ static void select_next_instance(AppSwitcher *self) {
 
     AppSwitcherAppWidget *widget =
         app_switcher_get_widget_at_index(self, self->focused_index);
+    if (!widget) return;
 
     app_switcher_app_widget_set_focused_next_instance(widget);
 }
@@ -329,6 +366,7 @@ static void select_prev_instance(AppSwitcher *self) {
 
     AppSwitcherAppWidget *widget =
         app_switcher_get_widget_at_index(self, self->focused_index);
+    if (!widget) return;
 
     app_switcher_app_widget_set_focused_prev_instance(widget);
 }
@@ -394,6 +432,9 @@ static gboolean key_released(GtkEventControllerKey *controller, guint keyval,
 
 static void app_switcher_init(AppSwitcher *self) {
     self->focused_index = -1;
+    self->widgets_by_app_id = g_hash_table_new(g_str_hash, g_str_equal);
+    self->mru = g_ptr_array_new();
+    self->preview_deferred = g_hash_table_new(g_direct_hash, g_direct_equal);
 
     self->key_controller = gtk_event_controller_key_new();
 
@@ -419,7 +460,7 @@ void app_switcher_activate(AdwApplication *app, gpointer user_data) {
 void app_switcher_show(AppSwitcher *self) {
     g_debug("app_switcher.c:app_switcher_show called");
 
-    if (self->widget_n > 1) {
+    if (self->mru->len > 1) {
         if (self->select_alternative_app)
             app_switcher_focus_widget_at_index(self, 1);
         else
@@ -438,7 +479,13 @@ void app_switcher_show(AppSwitcher *self) {
 void app_switcher_hide(AppSwitcher *self) {
     g_debug("app_switcher.c:app_switcher_hide called");
 
-    app_switcher_unfocus_widget_all_with_focus_reset(self);
+    // toplevels may have been removed while shown, shifting focused_index,
+    // clear focus from every widget on the way out.
+    app_switcher_unfocus_widget_all(self);
+    self->focused_index = -1;
+
+    // a preview still pending would override the final activation.
+    app_switcher_cancel_preview(self);
 
     gtk_widget_set_visible(GTK_WIDGET(self->win), false);
     WaylandKSIService *ksi = wayland_ksi_service_get_global();
@@ -459,16 +506,78 @@ GtkWindow *app_switcher_get_window(AppSwitcher *self) {
     return GTK_WINDOW(self->win);
 }
 
-void app_switcher_enter_preview(AppSwitcher *self) {
-    WaylandForeignToplevelService *foreign_toplevel =
+// Runs once per frame while previews are pending.
+//
+// Sway only draws the 'focused' border on a toplevel which holds keyboard
+// focus, which it will not hand out while the switcher has exclusive keyboard
+// interactivity. Instead of unmapping the switcher, which costs a layer-shell
+// reconfigure and a compositor round-trip per step, the switcher drops to
+// on-demand interactivity for the frame the activation is sent in and takes
+// exclusive focus back on the next frame.
+static gboolean app_switcher_preview_tick(GtkWidget *widget,
+                                          GdkFrameClock *clock,
+                                          AppSwitcher *self) {
+    if (!self->preview_toplevel) {
+        gtk_layer_set_keyboard_mode(GTK_WINDOW(self->win),
+                                    GTK_LAYER_SHELL_KEYBOARD_MODE_EXCLUSIVE);
+        self->preview_tick_id = 0;
+        return G_SOURCE_REMOVE;
+    }
+
+    gtk_layer_set_keyboard_mode(GTK_WINDOW(self->win),
+                                GTK_LAYER_SHELL_KEYBOARD_MODE_ON_DEMAND);
+
+    WaylandForeignToplevelService *wayland =
         wayland_foreign_toplevel_service_get_global();
-    g_signal_handlers_block_by_func(foreign_toplevel, on_top_level_changed,
-                                    self);
+    WaylandWLRForeignTopLevel tp = {
+        .toplevel = self->preview_toplevel,
+    };
+    wayland_foreign_toplevel_service_activate(wayland, &tp);
+    self->preview_toplevel = NULL;
+
+    return G_SOURCE_CONTINUE;
+}
+
+static void app_switcher_cancel_preview(AppSwitcher *self) {
+    self->preview_toplevel = NULL;
+    if (!self->preview_tick_id) return;
+
+    gtk_widget_remove_tick_callback(GTK_WIDGET(self->win),
+                                    self->preview_tick_id);
+    self->preview_tick_id = 0;
+    gtk_layer_set_keyboard_mode(GTK_WINDOW(self->win),
+                                GTK_LAYER_SHELL_KEYBOARD_MODE_EXCLUSIVE);
+}
+
+void app_switcher_preview_toplevel(AppSwitcher *self, gpointer wl_toplevel) {
+    // only the newest selection of a frame is activated, cycling faster than
+    // the display refreshes does not queue up activations.
+    self->preview_toplevel = wl_toplevel;
+    if (self->preview_tick_id) return;
+
+    self->preview_tick_id = gtk_widget_add_tick_callback(
+        GTK_WIDGET(self->win), (GtkTickCallback)app_switcher_preview_tick,
+        self, NULL);
+}
+
+void app_switcher_enter_preview(AppSwitcher *self) {
+    self->previewing = true;
 }
 
 void app_switcher_exit_preview(AppSwitcher *self) {
     WaylandForeignToplevelService *foreign_toplevel =
         wayland_foreign_toplevel_service_get_global();
-    g_signal_handlers_unblock_by_func(foreign_toplevel, on_top_level_changed,
-                                      self);
+    GHashTable *toplevels =
+        wayland_foreign_toplevel_service_get_toplevels(foreign_toplevel);
+    GHashTableIter iter;
+    WaylandWLRForeignTopLevel *toplevel;
+
+    self->previewing = false;
+
+    // apply the state changes held back while previewing.
+    g_hash_table_iter_init(&iter, self->preview_deferred);
+    while (g_hash_table_iter_next(&iter, (gpointer *)&toplevel, NULL))
+        on_top_level_changed(foreign_toplevel, toplevels, toplevel,
+                             TOPLEVEL_CHANGE_STATE, self);
+    g_hash_table_remove_all(self->preview_deferred);
 }
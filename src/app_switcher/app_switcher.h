@@ -29,6 +29,11 @@ GtkWindow *app_switcher_get_window(AppSwitcher *self);
 
 void app_switcher_enter_preview(AppSwitcher *self);
 
+// Activates `wl_toplevel`, a zwlr_foreign_toplevel_handle_v1, on the next frame
+// so it can be previewed while the switcher stays open. Requests made within
+// the same frame collapse to the newest one.
+void app_switcher_preview_toplevel(AppSwitcher *self, gpointer wl_toplevel);
+
 void app_switcher_exit_preview(AppSwitcher *self);
 
 void app_switcher_unfocus_widget_all(AppSwitcher *self);
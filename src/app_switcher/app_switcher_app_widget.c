@@ -31,6 +31,11 @@ typedef struct _AppSwitcherAppWidget {
     GtkImage *expand_arrow;
     GtkScrolledWindow *scrolled;
     GtkBox *instances_container;
+    // instance AppSwitcherAppWidget(s) keyed by their wl_toplevel.
+    GHashTable *instances_by_toplevel;
+    // instance AppSwitcherAppWidget(s) in most recently activated order, the
+    // order of instances_container's children is derived from this array.
+    GPtrArray *instances;
     mouse_coords mouse;
     gint focused_index;
     int instances_n;
@@ -44,6 +49,9 @@ static void app_switcher_app_widget_dispose(GObject *object) {
 }
 
 static void app_switcher_app_widget_finalize(GObject *object) {
+    AppSwitcherAppWidget *self = (AppSwitcherAppWidget *)object;
+    g_hash_table_unref(self->instances_by_toplevel);
+    g_ptr_array_unref(self->instances);
     G_OBJECT_CLASS(app_switcher_app_widget_parent_class)->finalize(object);
 }
 
@@ -70,35 +78,13 @@ static void on_button_clicked(GtkButton *button, AppSwitcherAppWidget *self) {
 
 AppSwitcherAppWidget *find_instance_by_toplevel(AppSwitcherAppWidget *self,
                                                 gpointer toplevel) {
-    GtkWidget *w =
-        gtk_widget_get_first_child(GTK_WIDGET(self->instances_container));
-    while (w) {
-        AppSwitcherAppWidget *instance =
-            g_object_get_data(G_OBJECT(w), "app-widget");
-
-        if (instance->wl_toplevel == toplevel) {
-            return instance;
-        }
-        w = gtk_widget_get_next_sibling(w);
-    }
-    return NULL;
+    return g_hash_table_lookup(self->instances_by_toplevel, toplevel);
 }
 
 AppSwitcherAppWidget *find_instance_by_index(AppSwitcherAppWidget *self,
                                              int i) {
-    int ii = 0;
-    GtkWidget *w =
-        gtk_widget_get_first_child(GTK_WIDGET(self->instances_container));
-    while (w) {
-        if (ii == i) {
-            AppSwitcherAppWidget *instance =
-                g_object_get_data(G_OBJECT(w), "app-widget");
-            return instance;
-        }
-        w = gtk_widget_get_next_sibling(w);
-        ii++;
-    }
-    return NULL;
+    if (i < 0 || (guint)i >= self->instances->len) return NULL;
+    return g_ptr_array_index(self->instances, i);
 }
 
 // this ties our class object's lifecycel to the owning container.
@@ -185,6 +171,9 @@ static void app_switcher_app_widget_init_layout(AppSwitcherAppWidget *self) {
 static void app_switcher_app_widget_init(AppSwitcherAppWidget *self) {
     self->ctrl = GTK_EVENT_CONTROLLER_MOTION(gtk_event_controller_motion_new());
     self->focused_index = -1;
+    self->instances_by_toplevel =
+        g_hash_table_new(g_direct_hash, g_direct_equal);
+    self->instances = g_ptr_array_new();
     app_switcher_app_widget_init_layout(self);
 }
 
@@ -244,6 +233,11 @@ gboolean app_switcher_app_widget_remove_toplevel(
 
     if (!instance) return false;
 
+    // drop from the model before removing the instance from its container
+    // finalizes it.
+    g_hash_table_remove(self->instances_by_toplevel, toplevel->toplevel);
+    g_ptr_array_remove(self->instances, instance);
+
     // remove from instances container
     gtk_box_remove(self->instances_container,
                    app_switcher_app_widget_get_widget(instance));
@@ -267,38 +261,16 @@ gboolean app_switcher_app_widget_remove_toplevel(
 }
 
 void app_switcher_app_widget_preview(AppSwitcherAppWidget *self) {
-    AppSwitcher *app_switcher = app_switcher_get_global();
-    GtkWindow *app_switcher_win = app_switcher_get_window(app_switcher);
-
-    // activate toplevel to preview
-    WaylandForeignToplevelService *toplevel =
-        wayland_foreign_toplevel_service_get_global();
-    WaylandWLRForeignTopLevel tp = {
-        .toplevel = self->wl_toplevel,
-    };
-
-    wayland_foreign_toplevel_service_activate(toplevel, &tp);
-
-    // this bit allows the Sway compositor to set the 'focused' border on the
-    // window being previewed.
-    //
-    // we need to temporarily hide the app-switcher window so the Sway
-    // compositor can set the 'focused border' color on the activated window
-    // above.
-    //
-    // if we do not do this, the border of the activated window above remains
-    // the 'unfocused border' color and the user cannot understand which window
-    // is being previewed.
-    gtk_widget_set_visible(GTK_WIDGET(app_switcher_win), false);
-    if (self->parent && self->parent->win)
-        gtk_widget_set_visible(GTK_WIDGET(self->parent->win), false);
-    gtk_widget_set_visible(GTK_WIDGET(app_switcher_win), true);
-    if (self->parent && self->parent->win)
-        gtk_widget_set_visible(GTK_WIDGET(self->parent->win), true);
+    // the switcher activates the toplevel on its next frame and lets the
+    // compositor draw the 'focused' border on it, see
+    // app_switcher_preview_toplevel().
+    app_switcher_preview_toplevel(app_switcher_get_global(),
+                                  self->wl_toplevel);
 }
 
 void app_switcher_app_widget_add_toplevel(AppSwitcherAppWidget *self,
-                                          WaylandWLRForeignTopLevel *toplevel) {
+                                          WaylandWLRForeignTopLevel *toplevel,
+                                          guint changes) {
     // first time we are setting a top level, configure our name and icon.
     if (!self->app_id) {
         set_icon(self, toplevel);
@@ -320,19 +292,29 @@ void app_switcher_app_widget_add_toplevel(AppSwitcherAppWidget *self,
         set_icon(instance, toplevel);
         gtk_box_append(self->instances_container,
                        app_switcher_app_widget_get_widget(instance));
+        g_hash_table_insert(self->instances_by_toplevel, toplevel->toplevel,
+                            instance);
+        g_ptr_array_add(self->instances, instance);
         self->instances_n++;
+        changes |= TOPLEVEL_CHANGE_TITLE;
     }
 
     // whether we created an instance or have an existing, this add maybe
     // just to update the widget's titles, do this in both cases.
-    gtk_label_set_text(instance->id_or_title, toplevel->title);
-    gtk_widget_set_tooltip_text(GTK_WIDGET(instance->button), toplevel->title);
+    if (changes & TOPLEVEL_CHANGE_TITLE) {
+        gtk_label_set_text(instance->id_or_title, toplevel->title);
+        gtk_widget_set_tooltip_text(GTK_WIDGET(instance->button),
+                                    toplevel->title);
+    }
 
     if (self->instances_n > 1) {
         gtk_widget_set_visible(GTK_WIDGET(self->expand_arrow), true);
     }
 
-    if (toplevel->activated) {
+    if ((changes & TOPLEVEL_CHANGE_STATE) && toplevel->activated &&
+        g_ptr_array_index(self->instances, 0) != instance) {
+        g_ptr_array_remove(self->instances, instance);
+        g_ptr_array_insert(self->instances, 0, instance);
         gtk_box_reorder_child_after(
             self->instances_container,
             app_switcher_app_widget_get_widget(instance), 0);
@@ -346,13 +328,9 @@ void app_switcher_app_widget_unset_focus(AppSwitcherAppWidget *self) {
 
     gtk_widget_remove_css_class(GTK_WIDGET(self->button), "selected");
 
-    GtkWidget *w =
-        gtk_widget_get_first_child(GTK_WIDGET(self->instances_container));
-    while (w) {
-        AppSwitcherAppWidget *instance =
-            g_object_get_data(G_OBJECT(w), "app-widget");
+    for (guint i = 0; i < self->instances->len; i++) {
+        AppSwitcherAppWidget *instance = g_ptr_array_index(self->instances, i);
         gtk_widget_remove_css_class(GTK_WIDGET(instance->button), "selected");
-        w = gtk_widget_get_next_sibling(w);
     }
 }
 
@@ -15,8 +15,12 @@ G_END_DECLS
 
 GtkWidget *app_switcher_app_widget_get_widget(AppSwitcherAppWidget *self);
 
+// Adds `toplevel` as an instance of this app, or updates the existing instance
+// for it. `changes` is a WaylandWLRForeignTopLevelChange mask, only the parts
+// of the instance affected by it are updated.
 void app_switcher_app_widget_add_toplevel(AppSwitcherAppWidget *self,
-                                          WaylandWLRForeignTopLevel *toplevel);
+                                          WaylandWLRForeignTopLevel *toplevel,
+                                          guint changes);
 
 gboolean app_switcher_app_widget_remove_toplevel(
     AppSwitcherAppWidget *self, WaylandWLRForeignTopLevel *toplevel);
@@ -2,6 +2,7 @@
 
 #include <adwaita.h>
 #include <gtk4-layer-shell/gtk4-layer-shell.h>
+#include <string.h>
 
 #include "../panel/quick_settings/quick_settings.h"
 #include "../services/brightness_service/brightness_service.h"
@@ -12,6 +13,15 @@ static OSD *global = NULL;
 
 enum signals { signals_n };
 
+// The OSDs the presenter can show, values and icons are tracked per kind.
+enum OSDKind {
+    OSD_KIND_NONE,
+    OSD_KIND_VOLUME,
+    OSD_KIND_BRIGHTNESS,
+    OSD_KIND_KEYBOARD_BRIGHTNESS,
+    OSD_KIND_N,
+};
+
 typedef struct _OSD {
     GObject parent_instance;
     AdwWindow *win;
@@ -32,7 +42,20 @@ typedef struct _OSD {
     GtkImage *keyboard_bightness_icon;
 
     gboolean quick_settings_visible;
-    guint32 timeout_id;
+
+    // latest value and icon received per kind, and the kind to show next.
+    // events only record these, rendering happens at most once per frame.
+    enum OSDKind pending;
+    gdouble values[OSD_KIND_N];
+    const gchar *icons[OSD_KIND_N];
+    // what is currently rendered, used to skip redundant widget updates.
+    enum OSDKind shown;
+    gdouble shown_values[OSD_KIND_N];
+    const gchar *shown_icons[OSD_KIND_N];
+    guint tick_id;
+    // dismiss deadline, created once and re-armed with
+    // g_source_set_ready_time().
+    GSource *dismiss;
 } OSD;
 static guint osd_signals[signals_n] = {0};
 G_DEFINE_TYPE(OSD, osd, G_TYPE_OBJECT);
@@ -41,6 +64,11 @@ G_DEFINE_TYPE(OSD, osd, G_TYPE_OBJECT);
 static void osd_dispose(GObject *gobject) {
     OSD *self = OSD_OSD(gobject);
 
+    if (self->dismiss) {
+        g_source_destroy(self->dismiss);
+        g_clear_pointer(&self->dismiss, g_source_unref);
+    }
+
     // Chain-up
     G_OBJECT_CLASS(osd_parent_class)->dispose(gobject);
 };
@@ -56,166 +84,194 @@ static void osd_class_init(OSDClass *klass) {
     object_class->finalize = osd_finalize;
 };
 
+static void osd_arm_dismiss(OSD *self) {
+    g_source_set_ready_time(
+        self->dismiss,
+        g_get_monotonic_time() + OSD_DISMISS_TIMEOUT_S * G_USEC_PER_SEC);
+}
+
+static void osd_disarm_dismiss(OSD *self) {
+    g_source_set_ready_time(self->dismiss, -1);
+}
+
 static void do_cleanup(OSD *self) {
     g_debug("osd.c:do_cleanup(): called");
 
-    if (self->timeout_id) {
-        g_source_remove(self->timeout_id);
-        self->timeout_id = 0;
+    osd_disarm_dismiss(self);
+    if (self->tick_id) {
+        gtk_widget_remove_tick_callback(GTK_WIDGET(self->win), self->tick_id);
+        self->tick_id = 0;
     }
+    self->pending = OSD_KIND_NONE;
 }
 
 static gboolean timed_dismiss(OSD *self) {
     g_debug("osd.c:timed_dismiss(): called");
 
-    if (!self->win) return false;
+    osd_disarm_dismiss(self);
+
+    if (!self->win) return G_SOURCE_CONTINUE;
 
     // run animation backwards
     adw_timed_animation_set_reverse(ADW_TIMED_ANIMATION(self->animation), true);
     adw_animation_play(self->animation);
-    self->timeout_id = 0;
-    return false;
+    return G_SOURCE_CONTINUE;
 }
 
-static void show_osd(OSD *self, GtkBox *osd) {
-    if (osd != self->brightness_osd)
-        gtk_widget_set_visible(GTK_WIDGET(self->brightness_osd), false);
-    if (osd != self->keyboard_brightness_osd)
-        gtk_widget_set_visible(GTK_WIDGET(self->keyboard_brightness_osd),
-                               false);
-    if (osd != self->volume_osd)
-        gtk_widget_set_visible(GTK_WIDGET(self->volume_osd), false);
-
-    gtk_widget_set_visible(GTK_WIDGET(osd), true);
+static gboolean osd_dismiss_dispatch(GSource *source, GSourceFunc callback,
+                                     gpointer user_data) {
+    return callback(user_data);
 }
 
-static void on_brightness_changed(BrightnessService *bs, float percent,
-                                  OSD *self) {
-    g_debug("osd.c:on_brightness_changed(): called");
-
-    // if quick settings is currently displayed, don't show brightness OSD, its
-    // redunant
-    QuickSettings *qs = quick_settings_get_global();
-    if (quick_settings_is_visible(qs)) return;
+static GSourceFuncs osd_dismiss_funcs = {
+    .dispatch = osd_dismiss_dispatch,
+};
 
-    // if a timeout exists cancel it
-    if (self->timeout_id) {
-        g_source_remove(self->timeout_id);
-        self->timeout_id = 0;
+static GtkBox *osd_kind_box(OSD *self, enum OSDKind kind) {
+    switch (kind) {
+        case OSD_KIND_VOLUME:
+            return self->volume_osd;
+        case OSD_KIND_BRIGHTNESS:
+            return self->brightness_osd;
+        case OSD_KIND_KEYBOARD_BRIGHTNESS:
+            return self->keyboard_brightness_osd;
+        default:
+            return NULL;
     }
+}
 
-    char *icon_name = brightness_service_map_icon(bs);
-
-    // set icon
-    gtk_image_set_from_icon_name(self->bightness_icon, icon_name);
-
-    // set brightness scale
-    gtk_range_set_value(GTK_RANGE(self->brightness_scale), percent);
-
-    show_osd(self, self->brightness_osd);
-
-    // present window
-    if (!gtk_widget_get_visible(GTK_WIDGET(self->win))) {
-        gtk_widget_set_visible(GTK_WIDGET(self->win), true);
+static GtkScale *osd_kind_scale(OSD *self, enum OSDKind kind) {
+    switch (kind) {
+        case OSD_KIND_VOLUME:
+            return self->volume_scale;
+        case OSD_KIND_BRIGHTNESS:
+            return self->brightness_scale;
+        case OSD_KIND_KEYBOARD_BRIGHTNESS:
+            return self->keyboard_brightness_scale;
+        default:
+            return NULL;
+    }
+}
 
-        // play animation forward
-        adw_timed_animation_set_reverse(ADW_TIMED_ANIMATION(self->animation),
-                                        false);
-        adw_animation_play(self->animation);
-    } else {
-        // window is present, bump the timed dismiss to later
-        if (self->timeout_id) {
-            g_source_remove(self->timeout_id);
-            self->timeout_id = 0;
-        }
-        self->timeout_id =
-            g_timeout_add_seconds(8, (GSourceFunc)timed_dismiss, self);
+static GtkImage *osd_kind_icon(OSD *self, enum OSDKind kind) {
+    switch (kind) {
+        case OSD_KIND_VOLUME:
+            return self->volume_icon;
+        case OSD_KIND_BRIGHTNESS:
+            return self->bightness_icon;
+        case OSD_KIND_KEYBOARD_BRIGHTNESS:
+            return self->keyboard_bightness_icon;
+        default:
+            return NULL;
     }
 }
 
-static void on_keyboard_brightness_changed(BrightnessService *bs, guint percent,
-                                           OSD *self) {
-    g_debug("osd.c:on_brightness_changed(): called");
+static void show_osd(OSD *self, enum OSDKind kind) {
+    if (self->shown == kind) return;
 
-    // if quick settings is currently displayed, don't show brightness OSD, its
-    // redunant
-    QuickSettings *qs = quick_settings_get_global();
-    if (quick_settings_is_visible(qs)) return;
+    for (enum OSDKind k = OSD_KIND_VOLUME; k < OSD_KIND_N; k++) {
+        GtkBox *osd = osd_kind_box(self, k);
+        if (osd) gtk_widget_set_visible(GTK_WIDGET(osd), k == kind);
+    }
+    self->shown = kind;
+}
 
-    // if a timeout exists cancel it
-    if (self->timeout_id) {
-        g_source_remove(self->timeout_id);
-        self->timeout_id = 0;
+// Applies the latest pending value to the widgets, touching only what changed
+// since the last render, and presents the window or pushes back its dismiss.
+static void osd_render(OSD *self) {
+    enum OSDKind kind = self->pending;
+    self->pending = OSD_KIND_NONE;
+    if (kind == OSD_KIND_NONE) return;
+
+    GtkImage *icon = osd_kind_icon(self, kind);
+    GtkScale *scale = osd_kind_scale(self, kind);
+    if (!scale) return;
+
+    // icons are bucketed by value, only look one up when the bucket changes.
+    if (icon && self->icons[kind] &&
+        g_strcmp0(self->icons[kind], self->shown_icons[kind]) != 0) {
+        gtk_image_set_from_icon_name(icon, self->icons[kind]);
+        self->shown_icons[kind] = self->icons[kind];
     }
 
-    // set brightness scale
-    gtk_range_set_value(GTK_RANGE(self->keyboard_brightness_scale), percent);
+    if (self->values[kind] != self->shown_values[kind]) {
+        gtk_range_set_value(GTK_RANGE(scale), self->values[kind]);
+        self->shown_values[kind] = self->values[kind];
+    }
 
-    show_osd(self, self->keyboard_brightness_osd);
+    show_osd(self, kind);
 
     // present window
     if (!gtk_widget_get_visible(GTK_WIDGET(self->win))) {
         gtk_widget_set_visible(GTK_WIDGET(self->win), true);
 
-        // play animation forward
+        // play animation forward, the dismiss is armed once it's done.
         adw_timed_animation_set_reverse(ADW_TIMED_ANIMATION(self->animation),
                                         false);
         adw_animation_play(self->animation);
     } else {
         // window is present, bump the timed dismiss to later
-        if (self->timeout_id) {
-            g_source_remove(self->timeout_id);
-            self->timeout_id = 0;
-        }
-        self->timeout_id =
-            g_timeout_add_seconds(8, (GSourceFunc)timed_dismiss, self);
+        osd_arm_dismiss(self);
     }
 }
 
-static void on_default_sink_changed(WirePlumberService *wp,
-                                    WirePlumberServiceNode *sink, OSD *self) {
-    g_debug("osd.c:on_default_sink_changed()");
+static gboolean osd_on_tick(GtkWidget *widget, GdkFrameClock *clock,
+                            OSD *self) {
+    self->tick_id = 0;
+    osd_render(self);
+    return G_SOURCE_REMOVE;
+}
 
-    // if quick settings is currently displayed, don't show volume OSD, its
-    // redunant
+// Records the latest value for `kind` and schedules a render. While the OSD
+// is on screen renders are deferred to the next frame so a burst of events
+// renders once, a hidden OSD has no frame clock and renders immediately.
+static void osd_post(OSD *self, enum OSDKind kind, gdouble value,
+                     const gchar *icon) {
+    // if quick settings is currently displayed, don't show an OSD, its
+    // redundant
     QuickSettings *qs = quick_settings_get_global();
     if (quick_settings_is_visible(qs)) return;
 
-    // if a timeout exists cancel it
-    if (self->timeout_id) {
-        g_source_remove(self->timeout_id);
-        self->timeout_id = 0;
-    }
-
-    char *icon_name =
-        wire_plumber_service_map_sink_vol_icon(sink->volume, sink->mute);
+    self->values[kind] = value;
+    self->icons[kind] = icon;
+    self->pending = kind;
 
-    // set icon
-    gtk_image_set_from_icon_name(self->volume_icon, icon_name);
+    if (!gtk_widget_get_mapped(GTK_WIDGET(self->win))) {
+        osd_render(self);
+        return;
+    }
+    if (!self->tick_id)
+        self->tick_id = gtk_widget_add_tick_callback(
+            GTK_WIDGET(self->win), (GtkTickCallback)osd_on_tick, self, NULL);
+}
 
-    // set audio scale
-    gtk_range_set_value(GTK_RANGE(self->volume_scale), sink->volume);
-    if (sink->mute) gtk_range_set_value(GTK_RANGE(self->volume_scale), 0.0);
+static void on_brightness_changed(BrightnessService *bs, float percent,
+                                  OSD *self) {
+    g_debug("osd.c:on_brightness_changed(): called");
+    osd_post(self, OSD_KIND_BRIGHTNESS, percent,
+             brightness_service_map_icon(bs));
+}
 
-    show_osd(self, self->volume_osd);
+static void on_keyboard_brightness_changed(BrightnessService *bs, guint percent,
+                                           OSD *self) {
+    g_debug("osd.c:on_keyboard_brightness_changed(): called");
+
+    // a hotplugged keyboard backlight may have a different range.
+    GtkRange *range = GTK_RANGE(self->keyboard_brightness_scale);
+    guint max = MAX(brightness_service_get_keyboard_max(bs), 1);
+    if (gtk_adjustment_get_upper(gtk_range_get_adjustment(range)) != max) {
+        gtk_range_set_range(range, 0, max);
+        self->shown_values[OSD_KIND_KEYBOARD_BRIGHTNESS] = -1;
+    }
 
-    // present window
-    if (!gtk_widget_get_visible(GTK_WIDGET(self->win))) {
-        gtk_widget_set_visible(GTK_WIDGET(self->win), true);
+    osd_post(self, OSD_KIND_KEYBOARD_BRIGHTNESS, percent, NULL);
+}
 
-        // play animation forward
-        adw_timed_animation_set_reverse(ADW_TIMED_ANIMATION(self->animation),
-                                        false);
-        adw_animation_play(self->animation);
-    } else {
-        // window is present, bump the timed dismiss to later
-        if (self->timeout_id) {
-            g_source_remove(self->timeout_id);
-            self->timeout_id = 0;
-        }
-        self->timeout_id =
-            g_timeout_add_seconds(8, (GSourceFunc)timed_dismiss, self);
-    }
+static void on_default_sink_changed(WirePlumberService *wp,
+                                    WirePlumberServiceNode *sink, OSD *self) {
+    g_debug("osd.c:on_default_sink_changed()");
+    osd_post(self, OSD_KIND_VOLUME, sink->mute ? 0.0 : sink->volume,
+             wire_plumber_service_map_sink_vol_icon(sink->volume, sink->mute));
 }
 
 static void on_window_destroy(GtkWindow *win, OSD *self) {
@@ -237,12 +293,16 @@ static void animation_done(AdwAnimation *animation, OSD *self) {
         return;
     }
 
-    g_debug("osd.c:animation_done(): setting timeout");
-    self->timeout_id =
-        g_timeout_add_seconds(8, (GSourceFunc)timed_dismiss, self);
+    g_debug("osd.c:animation_done(): arming dismiss");
+    osd_arm_dismiss(self);
 }
 
 void osd_init_layout(OSD *self) {
+    // a new window starts out with nothing rendered.
+    self->shown = OSD_KIND_NONE;
+    memset(self->shown_icons, 0, sizeof(self->shown_icons));
+    for (enum OSDKind k = 0; k < OSD_KIND_N; k++) self->shown_values[k] = -1;
+
     self->container = GTK_BOX(gtk_box_new(GTK_ORIENTATION_VERTICAL, 0));
 
     self->overlay = GTK_OVERLAY(gtk_overlay_new());
@@ -295,68 +355,62 @@ void osd_init_layout(OSD *self) {
 
     gtk_overlay_add_overlay(self->overlay, GTK_WIDGET(self->volume_osd));
 
+    // the brightness OSDs are always built, backlights may be hotplugged after
+    // we start and are announced through the same signals.
     BrightnessService *bs = brightness_service_get_global();
 
-    if (brightness_service_has_backlight_brightness(bs)) {
-        // create brightness OSD
-        self->brightness_osd =
-            GTK_BOX(gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0));
-        gtk_widget_set_name(GTK_WIDGET(self->brightness_osd), "osd-container");
+    // create brightness OSD
+    self->brightness_osd = GTK_BOX(gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0));
+    gtk_widget_set_name(GTK_WIDGET(self->brightness_osd), "osd-container");
 
-        self->bightness_icon = GTK_IMAGE(
-            gtk_image_new_from_icon_name("display-brightness-symbolic"));
+    self->bightness_icon = GTK_IMAGE(
+        gtk_image_new_from_icon_name("display-brightness-symbolic"));
 
-        gtk_image_set_pixel_size(self->bightness_icon, 32);
+    gtk_image_set_pixel_size(self->bightness_icon, 32);
 
-        self->brightness_scale = GTK_SCALE(
-            gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, 0, 1.0, 0.05));
-        gtk_widget_set_hexpand(GTK_WIDGET(self->brightness_scale), true);
-        gtk_widget_set_sensitive(GTK_WIDGET(self->brightness_scale), false);
+    self->brightness_scale = GTK_SCALE(
+        gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, 0, 1.0, 0.05));
+    gtk_widget_set_hexpand(GTK_WIDGET(self->brightness_scale), true);
+    gtk_widget_set_sensitive(GTK_WIDGET(self->brightness_scale), false);
 
-        gtk_box_append(self->brightness_osd, GTK_WIDGET(self->bightness_icon));
-        gtk_box_append(self->brightness_osd,
-                       GTK_WIDGET(self->brightness_scale));
+    gtk_box_append(self->brightness_osd, GTK_WIDGET(self->bightness_icon));
+    gtk_box_append(self->brightness_osd, GTK_WIDGET(self->brightness_scale));
 
-        // wire into brightness changes
-        g_signal_connect(bs, "brightness-changed",
-                         G_CALLBACK(on_brightness_changed), self);
+    // wire into brightness changes
+    g_signal_connect(bs, "brightness-changed",
+                     G_CALLBACK(on_brightness_changed), self);
 
-        gtk_overlay_add_overlay(self->overlay,
-                                GTK_WIDGET(self->brightness_osd));
-    }
+    gtk_overlay_add_overlay(self->overlay, GTK_WIDGET(self->brightness_osd));
 
     // create keyboard brightness OSD
-    if (brightness_service_has_keyboard_brightness(bs)) {
-        self->keyboard_brightness_osd =
-            GTK_BOX(gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0));
-        gtk_widget_set_name(GTK_WIDGET(self->keyboard_brightness_osd),
-                            "osd-container");
+    self->keyboard_brightness_osd =
+        GTK_BOX(gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0));
+    gtk_widget_set_name(GTK_WIDGET(self->keyboard_brightness_osd),
+                        "osd-container");
 
-        self->keyboard_bightness_icon = GTK_IMAGE(
-            gtk_image_new_from_icon_name("keyboard-brightness-symbolic"));
+    self->keyboard_bightness_icon = GTK_IMAGE(
+        gtk_image_new_from_icon_name("keyboard-brightness-symbolic"));
 
-        gtk_image_set_pixel_size(self->keyboard_bightness_icon, 32);
+    gtk_image_set_pixel_size(self->keyboard_bightness_icon, 32);
 
-        guint keyboard_max_brightness = brightness_service_get_keyboard_max(bs);
+    // the range is updated once a keyboard backlight reports in.
+    self->keyboard_brightness_scale = GTK_SCALE(gtk_scale_new_with_range(
+        GTK_ORIENTATION_HORIZONTAL, 0,
+        MAX(brightness_service_get_keyboard_max(bs), 1), 1));
+    gtk_widget_set_hexpand(GTK_WIDGET(self->keyboard_brightness_scale), true);
+    gtk_widget_set_sensitive(GTK_WIDGET(self->keyboard_brightness_scale),
+                             false);
 
-        self->keyboard_brightness_scale = GTK_SCALE(gtk_scale_new_with_range(
-            GTK_ORIENTATION_HORIZONTAL, 0, keyboard_max_brightness, 1));
-        gtk_widget_set_hexpand(GTK_WIDGET(self->keyboard_brightness_scale),
-                               true);
-        gtk_widget_set_sensitive(GTK_WIDGET(self->keyboard_brightness_scale),
-                                 false);
+    gtk_box_append(self->keyboard_brightness_osd,
+                   GTK_WIDGET(self->keyboard_bightness_icon));
+    gtk_box_append(self->keyboard_brightness_osd,
+                   GTK_WIDGET(self->keyboard_brightness_scale));
 
-        gtk_box_append(self->keyboard_brightness_osd,
-                       GTK_WIDGET(self->keyboard_bightness_icon));
-        gtk_box_append(self->keyboard_brightness_osd,
-                       GTK_WIDGET(self->keyboard_brightness_scale));
+    g_signal_connect(bs, "keyboard-brightness-changed",
+                     G_CALLBACK(on_keyboard_brightness_changed), self);
 
-        g_signal_connect(bs, "keyboard-brightness-changed",
-                         G_CALLBACK(on_keyboard_brightness_changed), self);
-
-        gtk_overlay_add_overlay(self->overlay,
-                                GTK_WIDGET(self->keyboard_brightness_osd));
-    }
+    gtk_overlay_add_overlay(self->overlay,
+                            GTK_WIDGET(self->keyboard_brightness_osd));
 
     adw_window_set_content(self->win, GTK_WIDGET(self->overlay));
 }
@@ -367,13 +421,23 @@ void osd_reinitialize(OSD *self) {
     g_signal_handlers_disconnect_by_func(wp, on_default_sink_changed, self);
     BrightnessService *bs = brightness_service_get_global();
     g_signal_handlers_disconnect_by_func(bs, on_brightness_changed, self);
+    g_signal_handlers_disconnect_by_func(bs, on_keyboard_brightness_changed,
+                                         self);
 
     g_object_unref(self->animation);
 
     osd_init_layout(self);
 }
 
-void osd_init(OSD *self) { osd_init_layout(self); }
+void osd_init(OSD *self) {
+    self->dismiss = g_source_new(&osd_dismiss_funcs, sizeof(GSource));
+    g_source_set_callback(self->dismiss, (GSourceFunc)timed_dismiss, self,
+                          NULL);
+    g_source_set_ready_time(self->dismiss, -1);
+    g_source_attach(self->dismiss, NULL);
+
+    osd_init_layout(self);
+}
 
 void osd_activate(AdwApplication *app, gpointer user_data) {
     global = g_object_new(OSD_TYPE, NULL);
@@ -2,6 +2,9 @@
 
 #include <adwaita.h>
 
+// Seconds an OSD stays on screen after the last change it displayed.
+#define OSD_DISMISS_TIMEOUT_S 8
+
 G_BEGIN_DECLS
 
 struct _OSD;
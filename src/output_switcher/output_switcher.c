@@ -17,6 +17,9 @@ enum signals { signals_n };
 typedef struct _OutputSwitcher {
     GObject parent_instance;
     Switcher switcher;
+    // output name -> OutputSwitcherOutputWidget, rows are kept across output
+    // listings and only created or removed when an output comes or goes.
+    GHashTable *rows;
 } OutputSwitcher;
 
 static guint output_switcher_signals[signals_n] = {0};
@@ -24,6 +27,8 @@ G_DEFINE_TYPE(OutputSwitcher, output_switcher, G_TYPE_OBJECT);
 
 // stub out dispose, finalize, class_init and init methods.
 static void output_switcher_dispose(GObject *object) {
+    OutputSwitcher *self = (OutputSwitcher *)object;
+    g_clear_pointer(&self->rows, g_hash_table_unref);
     G_OBJECT_CLASS(output_switcher_parent_class)->dispose(object);
 }
 
@@ -169,22 +174,43 @@ static void on_outputs_changed(void *data, GPtrArray *outputs) {
     if (!outputs) return;
 
     OutputSwitcher *self = data;
-
-    gtk_list_box_remove_all(SWITCHER(self).list);
+    GHashTable *seen = g_hash_table_new(g_str_hash, g_str_equal);
+    GHashTableIter iter;
+    gchar *name;
+    OutputSwitcherOutputWidget *widget;
 
     for (guint i = 0; i < outputs->len; i++) {
         WMOutput *output = g_ptr_array_index(outputs, i);
+        if (!output->name) continue;
+        g_hash_table_add(seen, output->name);
+
+        widget = g_hash_table_lookup(self->rows, output->name);
+        if (!widget) {
+            widget = g_object_new(OUTPUT_SWITCHER_OUTPUT_WIDGET_TYPE, NULL);
+            output_switcher_output_widget_set_output_name(widget,
+                                                          output->name);
+            gtk_list_box_append(
+                SWITCHER(self).list,
+                output_switcher_output_widget_get_widget(widget));
+            g_hash_table_insert(self->rows, g_strdup(output->name), widget);
+        }
 
-        OutputSwitcherOutputWidget *widget =
-            g_object_new(OUTPUT_SWITCHER_OUTPUT_WIDGET_TYPE, NULL);
-        output_switcher_output_widget_set_output_name(widget, output->name);
-
-        g_object_set_data(
+        // rows own a copy, `outputs` is freed on the next listing.
+        g_object_set_data_full(
             G_OBJECT(output_switcher_output_widget_get_widget(widget)),
-            "output", output);
-        gtk_list_box_append(SWITCHER(self).list,
+            "output", wm_output_copy(output), (GDestroyNotify)wm_output_free);
+    }
+
+    g_hash_table_iter_init(&iter, self->rows);
+    while (g_hash_table_iter_next(&iter, (gpointer *)&name,
+                                  (gpointer *)&widget)) {
+        if (g_hash_table_contains(seen, name)) continue;
+        gtk_list_box_remove(SWITCHER(self).list,
                             output_switcher_output_widget_get_widget(widget));
+        g_hash_table_iter_remove(&iter);
     }
+
+    g_hash_table_unref(seen);
 }
 
 static void on_row_activated(GtkListBox *box, GtkListBoxRow *row,
@@ -289,6 +315,8 @@ static void output_switcher_init_layout(OutputSwitcher *self) {
 }
 
 static void output_switcher_init(OutputSwitcher *self) {
+    self->rows = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                       g_object_unref);
     output_switcher_init_layout(self);
 }
 
@@ -80,10 +80,15 @@ static void on_status_notifier_item_removed(StatusNotifierService *sn,
     IndicatorWidget *i = g_hash_table_lookup(self->indicators, sni->bus_name);
     if (!i) return;
 
+    indicator_widget_item_removed(i);
+
     GtkWidget *w = indicator_widget_get_widget(i);
     gtk_box_remove(self->list, w);
 
     g_hash_table_remove(self->indicators, sni->bus_name);
+
+    // calls in flight keep their own reference until they complete.
+    g_object_unref(i);
 }
 
 static void indicator_bar_init_layout(IndicatorBar *self) {
@@ -2,7 +2,6 @@
 
 #include <adwaita.h>
 
-#include "../../services/status_notifier_service/status_notifier_item_dbus.h"
 #include "../../services/status_notifier_service/status_notifier_service.h"
 
 struct _IndicatorWidget {
@@ -10,9 +9,21 @@ struct _IndicatorWidget {
     GtkBox *container;
     GtkBox *box;
     GtkImage *icon;
+    // owned, in-flight calls may outlive the widget tree.
     GtkButton *button;
     GtkPopoverMenu *menu;
+    GtkGesture *click;
+    GtkEventController *scroll;
     StatusNotifierItem *sni;
+    // method calls on the item which have not completed yet, the button is
+    // marked busy when one is outstanding for INDICATOR_WIDGET_BUSY_MS.
+    guint pending_calls;
+    guint busy_id;
+    // scroll deltas accumulated since the last frame, sent as a single Scroll
+    // call per axis from the tick callback.
+    gdouble scroll_dx;
+    gdouble scroll_dy;
+    guint scroll_tick_id;
 };
 G_DEFINE_TYPE(IndicatorWidget, indicator_widget, G_TYPE_OBJECT);
 
@@ -23,8 +34,22 @@ static void on_sni_property_update(StatusNotifierService *s,
                                    IndicatorWidget *self);
 // static void on_new_icon(DbusItemV0Gen *item, IndicatorWidget *self);
 // stub out dispose, finalize, class_init, and init methods
+static void indicator_widget_cancel_pending(IndicatorWidget *self) {
+    g_clear_handle_id(&self->busy_id, g_source_remove);
+    if (self->scroll_tick_id) {
+        gtk_widget_remove_tick_callback(GTK_WIDGET(self->button),
+                                        self->scroll_tick_id);
+        self->scroll_tick_id = 0;
+    }
+    self->scroll_dx = 0;
+    self->scroll_dy = 0;
+}
+
 static void indicator_widget_dispose(GObject *gobject) {
     IndicatorWidget *self = INDICATOR_WIDGET(gobject);
+
+    indicator_widget_cancel_pending(self);
+
     // Chain-up
     G_OBJECT_CLASS(indicator_widget_parent_class)->dispose(gobject);
 
@@ -34,6 +59,10 @@ static void indicator_widget_dispose(GObject *gobject) {
 };
 
 static void indicator_widget_finalize(GObject *gobject) {
+    IndicatorWidget *self = INDICATOR_WIDGET(gobject);
+
+    g_clear_object(&self->button);
+
     // Chain-up
     G_OBJECT_CLASS(indicator_widget_parent_class)->finalize(gobject);
 };
@@ -44,13 +73,117 @@ static void indicator_widget_class_init(IndicatorWidgetClass *klass) {
     object_class->finalize = indicator_widget_finalize;
 };
 
-static void on_button_clicked(GtkButton *button, IndicatorWidget *self) {
+static gboolean on_busy_timeout(IndicatorWidget *self) {
+    self->busy_id = 0;
+    gtk_widget_add_css_class(GTK_WIDGET(self->button), "busy");
+    return G_SOURCE_REMOVE;
+}
+
+// Marks the start of a method call on the item, returns a reference on the
+// widget which on_sni_call_done releases.
+static IndicatorWidget *indicator_widget_call_begin(IndicatorWidget *self) {
+    if (self->pending_calls++ == 0)
+        self->busy_id = g_timeout_add(INDICATOR_WIDGET_BUSY_MS,
+                                      (GSourceFunc)on_busy_timeout, self);
+    return g_object_ref(self);
+}
+
+static void on_sni_call_done(GObject *source, GAsyncResult *res,
+                             IndicatorWidget *self) {
     GError *error = NULL;
-    dbus_item_v0_gen_call_activate_sync(
-        status_notifier_item_get_proxy(self->sni), 0, 0, NULL, &error);
-    if (error) {
+
+    // items commonly implement only some of the methods, a failed call is
+    // not worth more than a debug message.
+    if (!status_notifier_item_call_finish(source, res, &error)) {
+        g_debug("indicator_widget.c:on_sni_call_done() call failed: %s",
+                error->message);
         g_error_free(error);
     }
+
+    // the button is owned by us, it's still valid if the item was removed
+    // while the call was in flight.
+    if (--self->pending_calls == 0) {
+        g_clear_handle_id(&self->busy_id, g_source_remove);
+        gtk_widget_remove_css_class(GTK_WIDGET(self->button), "busy");
+    }
+
+    g_object_unref(self);
+}
+
+static void on_button_clicked(GtkButton *button, IndicatorWidget *self) {
+    status_notifier_item_activate(self->sni, 0, 0,
+                                  (GAsyncReadyCallback)on_sni_call_done,
+                                  indicator_widget_call_begin(self));
+}
+
+static void on_button_clicked_with_menu(GtkButton *button,
+                                        IndicatorWidget *self);
+
+static void on_click_pressed(GtkGestureClick *gesture, gint n_press,
+                             gdouble x, gdouble y, IndicatorWidget *self) {
+    guint button =
+        gtk_gesture_single_get_current_button(GTK_GESTURE_SINGLE(gesture));
+
+    switch (button) {
+        case GDK_BUTTON_MIDDLE:
+            status_notifier_item_secondary_activate(
+                self->sni, 0, 0, (GAsyncReadyCallback)on_sni_call_done,
+                indicator_widget_call_begin(self));
+            break;
+        case GDK_BUTTON_SECONDARY:
+            // items exporting a dbusmenu get our popover, others draw their
+            // own context menu.
+            if (self->menu)
+                on_button_clicked_with_menu(self->button, self);
+            else
+                status_notifier_item_context_menu(
+                    self->sni, 0, 0, (GAsyncReadyCallback)on_sni_call_done,
+                    indicator_widget_call_begin(self));
+            break;
+        default:
+            // primary clicks are left to the GtkButton.
+            gtk_gesture_set_state(GTK_GESTURE(gesture),
+                                  GTK_EVENT_SEQUENCE_DENIED);
+            return;
+    }
+
+    gtk_gesture_set_state(GTK_GESTURE(gesture), GTK_EVENT_SEQUENCE_CLAIMED);
+}
+
+static gboolean on_scroll_tick(GtkWidget *widget, GdkFrameClock *clock,
+                               IndicatorWidget *self) {
+    self->scroll_tick_id = 0;
+
+    gint dx = (gint)self->scroll_dx;
+    gint dy = (gint)self->scroll_dy;
+
+    // keep the fractional part of smooth scrolling for the next frame.
+    self->scroll_dx -= dx;
+    self->scroll_dy -= dy;
+
+    if (dy != 0)
+        status_notifier_item_scroll(self->sni, dy, "vertical",
+                                    (GAsyncReadyCallback)on_sni_call_done,
+                                    indicator_widget_call_begin(self));
+    if (dx != 0)
+        status_notifier_item_scroll(self->sni, dx, "horizontal",
+                                    (GAsyncReadyCallback)on_sni_call_done,
+                                    indicator_widget_call_begin(self));
+
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean on_scroll(GtkEventControllerScroll *ctrl, gdouble dx,
+                          gdouble dy, IndicatorWidget *self) {
+    self->scroll_dx += dx;
+    self->scroll_dy += dy;
+
+    if (!self->scroll_tick_id)
+        self->scroll_tick_id = gtk_widget_add_tick_callback(
+            GTK_WIDGET(self->button), (GtkTickCallback)on_scroll_tick, self,
+            NULL);
+
+    return true;
 }
 
 static void indicator_widget_init_layout(IndicatorWidget *self) {
@@ -64,9 +197,21 @@ static void indicator_widget_init_layout(IndicatorWidget *self) {
 
     self->icon = GTK_IMAGE(gtk_image_new_from_icon_name("image-missing"));
 
-    self->button = GTK_BUTTON(gtk_button_new());
+    self->button = GTK_BUTTON(g_object_ref_sink(gtk_button_new()));
     gtk_button_set_child(self->button, GTK_WIDGET(self->icon));
 
+    self->click = gtk_gesture_click_new();
+    gtk_gesture_single_set_button(GTK_GESTURE_SINGLE(self->click), 0);
+    g_signal_connect(self->click, "pressed", G_CALLBACK(on_click_pressed),
+                     self);
+    gtk_widget_add_controller(GTK_WIDGET(self->button),
+                              GTK_EVENT_CONTROLLER(self->click));
+
+    self->scroll =
+        gtk_event_controller_scroll_new(GTK_EVENT_CONTROLLER_SCROLL_BOTH_AXES);
+    g_signal_connect(self->scroll, "scroll", G_CALLBACK(on_scroll), self);
+    gtk_widget_add_controller(GTK_WIDGET(self->button), self->scroll);
+
     // wire it up
     gtk_box_append(self->box, GTK_WIDGET(self->button));
     gtk_box_append(self->container, GTK_WIDGET(self->box));
@@ -86,22 +231,31 @@ static void on_button_clicked_with_menu(GtkButton *button,
     status_notifier_item_about_to_show(self->sni, 0);
 }
 
+static void on_menu_closed(GtkPopover *popover, IndicatorWidget *self) {
+    status_notifier_item_menu_hidden(self->sni);
+}
+
 static void indicator_widget_set_icon(IndicatorWidget *self) {
     const gchar *icon_name = status_notifier_item_get_icon_name(self->sni);
     if (self->sni->icon_pixmap_from_theme) {
         GdkTexture *t =
             gdk_texture_new_for_pixbuf(self->sni->icon_pixmap_from_theme);
         gtk_image_set_from_paintable(self->icon, GDK_PAINTABLE(t));
+        g_object_unref(t);
     } else if (icon_name && strlen(icon_name) > 0) {
         gtk_image_set_from_icon_name(self->icon, icon_name);
     } else {
-        GdkPixbuf *pix = status_notifier_item_get_icon_pixmap(self->sni);
-        if (pix) {
-            GdkTexture *t = gdk_texture_new_for_pixbuf(pix);
-            gtk_image_set_from_paintable(self->icon, GDK_PAINTABLE(t));
-        } else {
+        GdkTexture *t = status_notifier_item_get_icon_pixmap(self->sni);
+        if (!t) {
             gtk_image_set_from_icon_name(self->icon, "image-missing");
+            return;
         }
+        // textures are cached per frame by the service, an unchanged frame
+        // hands us the texture we are already displaying.
+        if (gtk_image_get_storage_type(self->icon) == GTK_IMAGE_PAINTABLE &&
+            gtk_image_get_paintable(self->icon) == GDK_PAINTABLE(t))
+            return;
+        gtk_image_set_from_paintable(self->icon, GDK_PAINTABLE(t));
     }
 }
 
@@ -139,6 +293,7 @@ void indicator_widget_set_sni(IndicatorWidget *self, StatusNotifierItem *sni) {
         G_MENU_MODEL(sni->menu_model), GTK_POPOVER_MENU_NESTED));
 
     gtk_widget_set_parent(GTK_WIDGET(self->menu), GTK_WIDGET(self->button));
+    g_signal_connect(self->menu, "closed", G_CALLBACK(on_menu_closed), self);
 
     // insert the action group the SNI provides at the prefix
     // SNI_GACTION_PREFIX. GMenuItems will send actions there.
@@ -152,6 +307,11 @@ void indicator_widget_set_sni(IndicatorWidget *self, StatusNotifierItem *sni) {
                      G_CALLBACK(on_sni_menu_updated), self);
 }
 
+void indicator_widget_item_removed(IndicatorWidget *self) {
+    indicator_widget_cancel_pending(self);
+    self->sni = NULL;
+}
+
 StatusNotifierItem *indicator_widget_get_sni(IndicatorWidget *self) {
     return self->sni;
 }
@@ -4,6 +4,10 @@
 
 #include "../../services/status_notifier_service/status_notifier_service.h"
 
+// Time, in milliseconds, a method call on the item may be outstanding before
+// the indicator is shown as busy.
+#define INDICATOR_WIDGET_BUSY_MS 250
+
 G_BEGIN_DECLS
 
 struct _IndicatorWidget;
@@ -15,6 +19,10 @@ G_END_DECLS
 
 void indicator_widget_set_sni(IndicatorWidget *self, StatusNotifierItem *sni);
 
+// Called when the widget's StatusNotifierItem is removed. Cancels the busy
+// timer and pending scroll, calls still in flight complete harmlessly.
+void indicator_widget_item_removed(IndicatorWidget *self);
+
 StatusNotifierItem *indicator_widget_get_sni(IndicatorWidget *self);
 
 GtkWidget *indicator_widget_get_widget(IndicatorWidget *self);
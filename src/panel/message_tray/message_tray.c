@@ -328,6 +328,10 @@ void message_tray_toggle(MessageTray *self) {
     }
 }
 
+gboolean message_tray_is_visible(MessageTray *self) {
+    return gtk_widget_get_visible(GTK_WIDGET(self->win));
+}
+
 void message_tray_shrink(MessageTray *self) {
     g_debug("message_tray.c:message_tray_shrink() called.");
     gtk_window_set_default_size(GTK_WINDOW(self->win), 700, 600);
@@ -32,3 +32,5 @@ void message_tray_shrink(MessageTray *self);
 void message_tray_runtime_signals(MessageTray *self);
 
 void message_tray_toggle(MessageTray *self);
+
+gboolean message_tray_is_visible(MessageTray *self);
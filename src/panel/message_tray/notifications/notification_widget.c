@@ -846,47 +846,13 @@ static void media_player_widget_on_raise(GtkButton *button,
     media_player_service_player_raise(srv, self->media_player_name);
 }
 
-static void on_media_player_img_loaded(GObject *obj, GAsyncResult *res,
-                                       gpointer user_data) {
-    g_debug("media_players.c:on_image_loaded() called.");
-
-    GFileInputStream *file_input_stream;
-    GError *error = NULL;
-    GdkPixbuf *pixbuf;
-
-    NotificationWidget *widget = (NotificationWidget *)user_data;
-
-    file_input_stream = g_file_read_finish(G_FILE(obj), res, &error);
-    if (error) {
-        g_warning("Error loading image: %s", error->message);
-        return;
-    }
-
-    pixbuf = gdk_pixbuf_new_from_stream(G_INPUT_STREAM(file_input_stream), NULL,
-                                        &error);
-    if (error) {
-        g_warning("Failed to create pixbuf from stream: %s", error->message);
-        g_object_unref(file_input_stream);
-        return;
-    }
-
-    GdkTexture *texture = gdk_texture_new_for_pixbuf(pixbuf);
-
-    adw_avatar_set_custom_image(widget->avatar, GDK_PAINTABLE(texture));
-
-    g_object_unref(file_input_stream);
-    g_object_unref(pixbuf);
-    g_object_unref(texture);
-}
-
 NotificationWidget *notification_widget_set_media_player(
     NotificationWidget *self, MediaPlayer *player) {
-    if (player->art_url) {
-        GFile *file;
-        file = g_file_new_for_uri(player->art_url);
-        g_file_read_async(file, G_PRIORITY_DEFAULT, NULL,
-                          on_media_player_img_loaded, self);
-    }
+    // art is decoded and cached by the MediaPlayerService, the texture is
+    // shared with every widget showing this player.
+    GdkPaintable *art = player->art ? GDK_PAINTABLE(player->art) : NULL;
+    if (adw_avatar_get_custom_image(self->avatar) != art)
+        adw_avatar_set_custom_image(self->avatar, art);
 
     // update play/pause icon depending on playback state
     if (g_strcmp0(player->playback_status, "Playing") == 0) {
@@ -7,7 +7,9 @@
 #include "../../src/services/status_notifier_service/status_notifier_service.h"
 #include "../activities/activities.h"
 #include "./indicator_bar/indicator_bar.h"
+#include "./message_tray/message_tray.h"
 #include "./panel_status_bar/panel_status_bar.h"
+#include "./quick_settings/quick_settings.h"
 #include "panel_clock.h"
 #include "panel_mediator.h"
 #include "panel_workspaces_bar/panel_workspaces_bar.h"
@@ -21,6 +23,10 @@ static GHashTable *panels = NULL;
 // An array of GdkMonitor pointers which mirrors the GListModel returned
 // from gdk_display_get_monitors(display);
 static GPtrArray *monitors = NULL;
+// Panels whose monitor was removed, keyed by panel_monitor_key(). A parked
+// Panel is hidden and destroyed after PANEL_PARK_TIMEOUT_S unless its monitor
+// returns first.
+static GHashTable *parked = NULL;
 
 // The global PanelMediator returned by this module when
 // panel_get_global_mediator() is called.
@@ -42,6 +48,10 @@ struct _Panel {
     // used to track monitor position in GListModel for deletion.
     guint32 monitor_pos;
     gchar *monitor_desc;
+    // identity of the monitor, stable across reconnects.
+    gchar *monitor_key;
+    // pending destroy while parked.
+    guint park_id;
 };
 G_DEFINE_TYPE(Panel, panel, G_TYPE_OBJECT)
 
@@ -71,6 +81,8 @@ static void panel_dispose(GObject *gobject) {
     g_object_unref(self->indicator_bar);
 
     g_free(self->monitor_desc);
+    g_free(self->monitor_key);
+    g_clear_handle_id(&self->park_id, g_source_remove);
 
     // Chain-up
     G_OBJECT_CLASS(panel_parent_class)->dispose(gobject);
@@ -130,6 +142,10 @@ static void panel_init_layout(Panel *self) {
     // workspaces bar, etc...) until 'panel_attach_to_monitor' since the
     // depedencies expect the panel to always have a valid monitor.
     self->win = ADW_WINDOW(adw_window_new());
+    // the compositor closes our layer surface when its output goes away,
+    // which gtk4-layer-shell turns into gtk_window_close(). parked Panels
+    // reuse the window, so closing must only hide it.
+    gtk_window_set_hide_on_close(GTK_WINDOW(self->win), TRUE);
     gtk_layer_init_for_window(GTK_WINDOW(self->win));
     gtk_layer_set_namespace(GTK_WINDOW(self->win), "way-shell-panel");
     gtk_layer_set_layer((GTK_WINDOW(self->win)), GTK_LAYER_SHELL_LAYER_TOP);
@@ -178,54 +194,165 @@ void panel_attach_to_monitor(Panel *self, GdkMonitor *monitor) {
                      self);
 }
 
-static void panel_on_monitor_added(GdkMonitor *mon, guint pos) {
-    const char *desc = NULL;
+// Describes a physical monitor by its EDID derived manufacturer and model,
+// NULL if the monitor doesn't report both.
+static gchar *panel_monitor_desc(GdkMonitor *mon) {
+    const gchar *manufacturer = gdk_monitor_get_manufacturer(mon);
+    const gchar *model = gdk_monitor_get_model(mon);
+    if (!manufacturer || !model) return NULL;
+    return g_strdup_printf("%s %s", manufacturer, model);
+}
+
+// Identifies a physical monitor across reconnects. GDK hands out a new
+// GdkMonitor each time an output appears, the connector plus description
+// stay the same.
+static gchar *panel_monitor_key(GdkMonitor *mon) {
+    gchar *desc = panel_monitor_desc(mon);
+    gchar *key = g_strdup_printf("%s|%s", gdk_monitor_get_connector(mon),
+                                 desc ? desc : "");
+    g_free(desc);
+    return key;
+}
+
+// Finds a parked Panel for `mon`. A Panel parked on the same connector is
+// preferred, otherwise any Panel parked for the same monitor model is used,
+// docks and KVM switches do not always hand a monitor the same connector.
+static Panel *panel_find_parked(const gchar *key, const gchar *desc) {
+    GHashTableIter iter;
+    Panel *panel = g_hash_table_lookup(parked, key);
+    if (panel) return panel;
+
+    // monitors without EDID data can't be told apart by model.
+    if (!desc) return NULL;
+
+    g_hash_table_iter_init(&iter, parked);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&panel))
+        if (g_strcmp0(panel->monitor_desc, desc) == 0)
+            return panel;
+    return NULL;
+}
+
+// Brings a reattached Panel's state up to date. Only state which could have
+// changed while parked is touched, the widget tree is left as is.
+static void panel_resync(Panel *panel) {
+    MessageTray *mt = message_tray_get_global();
+    QuickSettings *qs = quick_settings_get_global();
+
+    panel_workspaces_bar_sync_output(panel->ws_bar);
+    if (mt) panel_clock_set_toggled(panel->clock, message_tray_is_visible(mt));
+    if (qs)
+        panel_status_bar_set_toggled(panel->status_bar,
+                                     quick_settings_is_visible(qs));
+}
 
+static void panel_destroy(Panel *panel) {
+    if (GTK_IS_WINDOW(panel->win)) gtk_window_destroy(GTK_WINDOW(panel->win));
+    g_object_unref(panel);
+}
+
+static gboolean panel_park_expired(Panel *panel) {
+    g_debug("panel.c:panel_park_expired(): destroying bar for monitor: [%s]",
+            panel->monitor_key);
+
+    panel->park_id = 0;
+    g_hash_table_steal(parked, panel->monitor_key);
+    panel_destroy(panel);
+    return G_SOURCE_REMOVE;
+}
+
+// Moves a parked Panel, and its existing widget tree, onto `mon`.
+// Takes ownership of `key`.
+static void panel_unpark(Panel *panel, GdkMonitor *mon, gchar *key) {
+    g_clear_handle_id(&panel->park_id, g_source_remove);
+    g_hash_table_steal(parked, panel->monitor_key);
+    g_free(panel->monitor_key);
+    panel->monitor_key = key;
+
+    g_object_unref(panel->monitor);
+    panel->monitor = mon;
+
+    // layer surfaces pick their output when mapped, the window is unmapped
+    // while parked so setting the monitor here takes effect on present.
+    gtk_layer_set_monitor(GTK_WINDOW(panel->win), mon);
+    g_hash_table_insert(panels, mon, panel);
+    gtk_window_present(GTK_WINDOW(panel->win));
+
+    panel_resync(panel);
+}
+
+static void panel_on_monitor_added(GdkMonitor *mon, guint pos) {
     g_debug("panel.c:panel_on_monitor_added(): called.");
 
+    // invalid monitors are mirrored as a NULL placeholder so positions keep
+    // matching the GListModel without holding on to the unref'd monitor.
     if (!gdk_monitor_is_valid(mon)) {
         g_warning(
             "panel.c:panel_on_monitor_change() received invalid monitor "
             "from "
             "Gdk, moving to next.");
+        g_ptr_array_insert(monitors, pos, NULL);
+        g_object_unref(mon);
         return;
     }
 
-    // insert into our mirrored monitor list.
     g_ptr_array_insert(monitors, pos, mon);
 
-    Panel *panel = g_object_new(PANEL_TYPE, NULL);
-    panel->monitor_desc = g_strdup(desc);
+    gchar *key = panel_monitor_key(mon);
+    gchar *desc = panel_monitor_desc(mon);
+    Panel *panel = panel_find_parked(key, desc);
+    if (panel) {
+        g_free(desc);
+        panel_unpark(panel, mon, key);
+        g_debug(
+            "panel.c:panel_on_monitor_added(): reused bar for monitor: [%s]",
+            panel->monitor_key);
+        return;
+    }
+
+    panel = g_object_new(PANEL_TYPE, NULL);
+    panel->monitor_desc = desc;
+    panel->monitor_key = key;
     panel_attach_to_monitor(panel, mon);
 
     g_debug("panel.c:panel_on_monitor_added(): added bar for monitor: [%s]",
-            panel->monitor_desc);
+            panel->monitor_key);
 }
 
 static void panel_on_monitor_removed(guint pos) {
     g_debug("panel.c:panel_on_monitor_removed(): called.");
 
+    if (pos >= monitors->len) return;
     GdkMonitor *removed = g_ptr_array_index(monitors, pos);
-    if (!removed) return;
     g_ptr_array_remove_index(monitors, pos);
+    if (!removed) return;
 
     Panel *panel = g_hash_table_lookup(panels, removed);
     if (!panel) return;
+    g_hash_table_remove(panels, removed);
 
-    g_debug(
-        "panel.c:panel_on_monitor_removed(): removing bar for monitor: [%s]",
-        panel->monitor_desc);
-
-    g_object_unref(panel);
+    // another Panel may already be parked for this monitor if it was
+    // connected twice during a hotplug storm, keep the newest.
+    Panel *stale = g_hash_table_lookup(parked, panel->monitor_key);
+    if (stale) {
+        g_clear_handle_id(&stale->park_id, g_source_remove);
+        g_hash_table_steal(parked, stale->monitor_key);
+        panel_destroy(stale);
+    }
 
-    if (GTK_IS_WINDOW(panel->win)) gtk_window_destroy(GTK_WINDOW(panel->win));
+    g_debug("panel.c:panel_on_monitor_removed(): parking bar for monitor: [%s]",
+            panel->monitor_key);
 
-    g_hash_table_remove(panels, removed);
+    gtk_widget_set_visible(GTK_WIDGET(panel->win), FALSE);
+    g_hash_table_insert(parked, panel->monitor_key, panel);
+    panel->park_id = g_timeout_add_seconds(
+        PANEL_PARK_TIMEOUT_S, (GSourceFunc)panel_park_expired, panel);
 }
 
-// Iterates over the monitors GListModel, creating panels for any new monitors.
-// Designed to be a handler for the GListModel(GdkMonitor)::items-changed
-// signal.
+// Reconciles the monitors GListModel with our Panels. Designed to be a
+// handler for the GListModel(GdkMonitor)::items-changed signal.
+//
+// Removals are processed before additions so a monitor which is replaced
+// within a single emission finds its parked Panel.
 static void panel_on_monitor_change(GListModel *monitors, guint position,
                                     guint removed, guint added,
                                     gpointer gtk_app) {
@@ -237,14 +364,11 @@ static void panel_on_monitor_change(GListModel *monitors, guint position,
         "removed: [%d], added: [%d], n: [%d]",
         position, removed, added, n);
 
-    if (added > 0) {
-        panel_on_monitor_added(g_list_model_get_item(monitors, position),
-                               position);
-    }
+    for (guint i = 0; i < removed; i++) panel_on_monitor_removed(position);
 
-    if (removed > 0) {
-        panel_on_monitor_removed(position);
-    }
+    for (guint i = 0; i < added; i++)
+        panel_on_monitor_added(g_list_model_get_item(monitors, position + i),
+                               position + i);
 }
 
 PanelMediator *panel_get_global_mediator() { return mediator; }
@@ -279,6 +403,8 @@ void panel_activate(AdwApplication *app, gpointer user_data) {
     mediator = g_object_new(PANEL_MEDIATOR_TYPE, NULL);
     panels = g_hash_table_new(g_direct_hash, g_direct_equal);
     monitors = g_ptr_array_new();
+    // keys are owned by the parked Panel's monitor_key.
+    parked = g_hash_table_new(g_str_hash, g_str_equal);
 
     g_debug(
         "panel.c:panel_activate() initializing bars with synthetic monitor "
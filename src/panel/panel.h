@@ -4,6 +4,11 @@
 
 #include "panel_mediator.h"
 
+// Seconds a Panel whose monitor was removed is kept, hidden, waiting for the
+// same monitor to come back. Docking and undocking reuses the parked Panel and
+// its widget tree instead of building a new one.
+#define PANEL_PARK_TIMEOUT_S 30
+
 G_BEGIN_DECLS
 
 // The top-of-screen Panel which exists on each monitor of the current
@@ -13,7 +13,12 @@ typedef struct _PanelWorkspacesBar {
     GtkBox *container;
     GtkScrolledWindow *scroll_win;
     GtkBox *list;
+    // workspaces on this bar's output, buttons point into this array.
     GPtrArray *workspaces;
+    // connector name of the monitor this bar's panel is on.
+    gchar *output;
+    // GtkButton(s) in `list` keyed by their workspace's id.
+    GHashTable *buttons;
     guint32 signal_id;
 } PanelWorkspacesBar;
 G_DEFINE_TYPE(PanelWorkspacesBar, panel_workspaces_bar, G_TYPE_OBJECT);
@@ -27,8 +32,28 @@ static void on_button_clicked(GtkButton *button, PanelWorkspacesBar *self) {
     wm->focus_workspace(wm, ws);
 }
 
-GtkButton *create_workspace_button(WindowManager *wm, WMWorkspace *ws,
-                                   PanelWorkspacesBar *self) {
+static void update_workspace_button(GtkWidget *button, WMWorkspace *ws) {
+    if (g_strcmp0(gtk_button_get_label(GTK_BUTTON(button)), ws->name) != 0)
+        gtk_button_set_label(GTK_BUTTON(button), ws->name);
+
+    // set appropriate classes if focused and/or urgent
+    if (ws->focused)
+        gtk_widget_add_css_class(button, "panel-button-toggled");
+    else
+        gtk_widget_remove_css_class(button, "panel-button-toggled");
+
+    if (ws->urgent && !ws->focused)
+        gtk_widget_add_css_class(button, "panel-button-urgent");
+    else
+        gtk_widget_remove_css_class(button, "panel-button-urgent");
+
+    // overwrite workspace pointer on button's data
+    // so we can access it later
+    g_object_set_data(G_OBJECT(button), "workspace", ws);
+}
+
+static GtkWidget *create_workspace_button(PanelWorkspacesBar *self,
+                                          WMWorkspace *ws) {
     // create button
     GtkWidget *button;
     button = gtk_button_new_with_label(ws->name);
@@ -38,36 +63,27 @@ GtkButton *create_workspace_button(WindowManager *wm, WMWorkspace *ws,
 
     // add panel-button css class
     gtk_widget_add_css_class(button, "panel-button");
-    if (ws->focused) {
-        gtk_widget_add_css_class(button, "panel-button-toggled");
-    }
-    if (ws->urgent && !ws->focused) {
-        gtk_widget_add_css_class(button, "panel-button-urgent");
-    }
 
-    // append workspace pointer to button's data
-    // so we can access it later
-    g_object_set_data(G_OBJECT(button), "workspace", ws);
+    update_workspace_button(button, ws);
 
     // add button to list
     gtk_box_append(self->list, button);
 
-    if (ws->focused) {
-        return GTK_BUTTON(button);
-    }
-    return NULL;
+    return button;
 }
 
+// Called only when the workspaces on this bar's output change, `workspaces`
+// holds just that output's workspaces. Buttons are keyed by workspace id, so
+// a workspace keeps its button across renames, moves and focus changes.
 static void on_workspaces_update(void *data, GPtrArray *workspaces) {
     PanelWorkspacesBar *self = data;
 
-    GtkWidget *child;
-    GdkMonitor *mon = panel_get_monitor(self->panel);
-    GtkButton *focused = NULL;
-    GPtrArray *buttons = g_ptr_array_new();
-    GPtrArray *filtered = g_ptr_array_new();
-    uint buttons_len = 0;
-    uint ws_len = 0;
+    GtkWidget *focused = NULL;
+    GtkWidget *prev = NULL;
+    GHashTable *seen;
+    GHashTableIter iter;
+    gpointer key;
+    GtkWidget *button;
     g_debug("workspace_bar.c:on_workspaces_update() called");
 
     if (!workspaces) {
@@ -79,132 +95,54 @@ static void on_workspaces_update(void *data, GPtrArray *workspaces) {
         return;
     }
 
-    // check if we need to replace the workspaces array.
-    if (!self->workspaces) {
-        self->workspaces = g_ptr_array_ref(workspaces);
-    } else if (self->workspaces != workspaces) {
-        g_ptr_array_unref(self->workspaces);
-        self->workspaces = g_ptr_array_ref(workspaces);
-    }
-
-    if (self->workspaces != workspaces && self->workspaces) {
-        g_ptr_array_unref(self->workspaces);
-    }
-
-    // filter out workspaces for this monitor
-    for (int i = 0; i < workspaces->len; i++) {
-        WMWorkspace *ws = g_ptr_array_index(workspaces, i);
-        if (g_strcmp0(ws->output, gdk_monitor_get_connector(mon)) == 0) {
-            g_ptr_array_add(filtered, ws);
-        }
-    }
-    workspaces = filtered;
+    // buttons point into the array, hold it until the next update.
+    g_ptr_array_ref(workspaces);
+    if (self->workspaces) g_ptr_array_unref(self->workspaces);
+    self->workspaces = workspaces;
 
-    ws_len = workspaces->len;
     g_debug("workspace_bar.c:on_workspaces_update() output [%s] ws_len = %d",
-            gdk_monitor_get_connector(mon), ws_len);
-
-    // no workspaces, remove all buttons and return
-    if (ws_len == 0) {
-        // remove all buttons, removing it from container will unref it as well,
-        // and we should be the only refs.
-        while ((child = gtk_widget_get_first_child(GTK_WIDGET(self->list)))) {
-            gtk_box_remove(self->list, child);
-        }
-        return;
-    }
-
-    for (GtkWidget *child = gtk_widget_get_first_child(GTK_WIDGET(self->list));
-         child; child = gtk_widget_get_next_sibling(child)) {
-        g_ptr_array_add(buttons, child);
-        buttons_len++;
-    }
-
-    WindowManager *wm = window_manager_service_get_global();
+            self->output, workspaces->len);
 
-    // if no buttons to reuse, create one for each and return.
-    if (buttons_len == 0) {
-        for (int i = 0; i < workspaces->len; i++) {
-            GtkButton *button;
+    seen = g_hash_table_new(g_direct_hash, g_direct_equal);
 
-            WMWorkspace *ws = g_ptr_array_index(workspaces, i);
-
-            // check if this workspace is for our current GdkConnection
-            if (g_strcmp0(ws->output, gdk_monitor_get_connector(mon)) != 0) {
-                continue;
-            }
+    for (guint i = 0; i < workspaces->len; i++) {
+        WMWorkspace *ws = g_ptr_array_index(workspaces, i);
+        key = GUINT_TO_POINTER(ws->id);
+        g_hash_table_add(seen, key);
 
-            // create button
+        button = g_hash_table_lookup(self->buttons, key);
+        if (!button) {
             g_debug(
                 "workspace_bar.c:on_workspaces_update() creating button for "
                 "workspace [%s] on output [%s]",
                 ws->name, ws->output);
-            button = create_workspace_button(wm, ws, self);
-            if (button) focused = button;
-        }
-        return;
-    }
-
-    // we have a positive number of buttons and workspaces.
-    // reuse as many buttons as we can
-    for (int i = 0; i < buttons_len && i < ws_len; i++) {
-        GtkButton *button;
-        WMWorkspace *ws;
-
-        button = g_ptr_array_index(buttons, i);
-        ws = g_ptr_array_index(workspaces, i);
-
-        // reset name label
-        gtk_button_set_label(button, ws->name);
-
-        // reset css
-        gtk_widget_remove_css_class(GTK_WIDGET(button), "panel-button-urgent");
-        gtk_widget_remove_css_class(GTK_WIDGET(button), "panel-button-toggled");
-
-        // set appropriate classes if focused and/or urgent
-        if (ws->focused) {
-            gtk_widget_add_css_class(GTK_WIDGET(button),
-                                     "panel-button-toggled");
-            focused = button;
+            button = create_workspace_button(self, ws);
+            g_hash_table_insert(self->buttons, key, button);
+        } else {
+            update_workspace_button(button, ws);
         }
-        if (ws->urgent)
-            gtk_widget_add_css_class(GTK_WIDGET(button), "panel-button-urgent");
-
-        // overwrite workspace pointer on button's data
-        // so we can access it later
-        g_object_set_data(G_OBJECT(button), "workspace", ws);
-    }
 
-    // if we had more workspaces then buttons we need to add buttons
-    if (ws_len > buttons_len) {
-        for (int i = buttons_len; i < ws_len; i++) {
-            GtkButton *button;
+        // keep button order in sync with the workspace order.
+        if (gtk_widget_get_prev_sibling(button) != prev)
+            gtk_box_reorder_child_after(self->list, button, prev);
+        prev = button;
 
-            WMWorkspace *ws = g_ptr_array_index(workspaces, i);
-
-            // check if this workspace is for our current GdkConnection
-            if (g_strcmp0(ws->output, gdk_monitor_get_connector(mon)) != 0) {
-                continue;
-            }
-
-            // create button
-            button = create_workspace_button(wm, ws, self);
-            if (button) focused = button;
-        }
-        return;
+        if (ws->focused) focused = button;
     }
 
-    // if we had more buttons then workspaces we need to remove some buttons
-    if (buttons_len > ws_len) {
-        for (int i = ws_len; i < buttons_len; i++) {
-            GtkWidget *button = g_ptr_array_index(buttons, i);
-            gtk_box_remove(self->list, button);
-        }
+    // remove buttons of workspaces which left this output, removing it from
+    // container will unref it as well, and we should be the only refs.
+    g_hash_table_iter_init(&iter, self->buttons);
+    while (g_hash_table_iter_next(&iter, &key, (gpointer *)&button)) {
+        if (g_hash_table_contains(seen, key)) continue;
+        gtk_box_remove(self->list, button);
+        g_hash_table_iter_remove(&iter);
     }
+    g_hash_table_unref(seen);
 
     // grab focus of button
     if (focused) {
-        gtk_widget_grab_focus(GTK_WIDGET(focused));
+        gtk_widget_grab_focus(focused);
     }
 }
 
@@ -217,10 +155,14 @@ static void panel_workspaces_bar_dispose(GObject *gobject) {
     g_debug("workspaces_bar.c:workspaces_bar_dispose() called");
 
     WindowManager *wm = window_manager_service_get_global();
-    wm->unregister_on_workspaces_changed(wm, on_workspaces_update, self);
+    if (self->output)
+        wm->unregister_on_output_workspaces_changed(wm, self->output,
+                                                    on_workspaces_update, self);
 
     // release reference to current workspaces array
-    g_ptr_array_unref(self->workspaces);
+    g_clear_pointer(&self->workspaces, g_ptr_array_unref);
+    g_clear_pointer(&self->buttons, g_hash_table_unref);
+    g_clear_pointer(&self->output, g_free);
 
     // Chain-up
     G_OBJECT_CLASS(panel_workspaces_bar_parent_class)->dispose(gobject);
@@ -242,8 +184,7 @@ static void panel_workspaces_bar_class_init(PanelWorkspacesBarClass *klass) {
 };
 
 static void panel_workpaces_bar_init_layout(PanelWorkspacesBar *self) {
-    // get window manager service
-    WindowManager *wm = window_manager_service_get_global();
+    self->buttons = g_hash_table_new(g_direct_hash, g_direct_equal);
 
     // initialize the container
     self->container = GTK_BOX(gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0));
@@ -265,12 +206,6 @@ static void panel_workpaces_bar_init_layout(PanelWorkspacesBar *self) {
     gtk_box_append(self->container, GTK_WIDGET(self->scroll_win));
     // add list to scrolled window
     gtk_scrolled_window_set_child(self->scroll_win, GTK_WIDGET(self->list));
-
-    // get initial list of workspaces
-    self->workspaces = wm->get_workspaces(wm);
-
-    // wire up to 'workspaces-changed' service
-    wm->register_on_workspaces_changed(wm, on_workspaces_update, self);
 }
 
 static void panel_workspaces_bar_init(PanelWorkspacesBar *self) {
@@ -287,6 +222,45 @@ void panel_workspaces_bar_set_panel(PanelWorkspacesBar *self, Panel *panel) {
             "panel_workspaces_bar.c:panel_workspaces_bar_set_panel() panel is "
             "NULL");
     self->panel = panel;
-    // create initial buttons
-    on_workspaces_update(self, self->workspaces);
+    panel_workspaces_bar_sync_output(self);
+}
+
+void panel_workspaces_bar_sync_output(PanelWorkspacesBar *self) {
+    // get window manager service
+    WindowManager *wm = window_manager_service_get_global();
+
+    // workspaces are tracked per output by the window manager service, only
+    // listen for the output our panel is on.
+    GdkMonitor *mon = panel_get_monitor(self->panel);
+    const gchar *output = gdk_monitor_get_connector(mon);
+    if (!output) {
+        g_warning(
+            "panel_workspaces_bar.c:panel_workspaces_bar_sync_output() "
+            "monitor has no connector");
+        return;
+    }
+
+    if (g_strcmp0(self->output, output) != 0) {
+        g_debug(
+            "panel_workspaces_bar.c:panel_workspaces_bar_sync_output() "
+            "moving from output [%s] to [%s]",
+            self->output, output);
+        if (self->output)
+            wm->unregister_on_output_workspaces_changed(
+                wm, self->output, on_workspaces_update, self);
+        g_free(self->output);
+        self->output = g_strdup(output);
+
+        // wire up to 'output-workspaces-changed' for our output
+        wm->register_on_output_workspaces_changed(wm, self->output,
+                                                  on_workspaces_update, self);
+    }
+
+    // buttons are keyed by workspace id, only the difference between what we
+    // show and the output's current workspaces is applied.
+    // an output sway has not reported workspaces for yet shows none.
+    GPtrArray *workspaces = wm->get_output_workspaces(wm, self->output);
+    if (!workspaces) workspaces = g_ptr_array_new();
+    on_workspaces_update(self, workspaces);
+    g_ptr_array_unref(workspaces);
 }
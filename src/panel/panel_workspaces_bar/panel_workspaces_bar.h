@@ -15,4 +15,9 @@ typedef struct _Panel Panel;
 
 GtkWidget *panel_workspaces_bar_get_widget(PanelWorkspacesBar *self);
 
-void panel_workspaces_bar_set_panel(PanelWorkspacesBar *self, Panel *panel);
\ No newline at end of file
+void panel_workspaces_bar_set_panel(PanelWorkspacesBar *self, Panel *panel);
+
+// Re-reads the connector of the panel's monitor, moving to that output's
+// workspaces if it changed, and applies the output's current workspaces.
+// Called when a Panel is reattached to a monitor.
+void panel_workspaces_bar_sync_output(PanelWorkspacesBar *self);
\ No newline at end of file
@@ -13,10 +13,31 @@
 
 enum signals { password_entry_revealed, signals_n };
 
+// A network listed in the menu, every BSSID advertising the same SSID is
+// merged into a single row.
+typedef struct _WifiMenuNetwork {
+    QuickSettingsGridWifiMenu *menu;
+    gchar *ssid;
+    // NMAccessPoint(s) advertising this SSID.
+    GPtrArray *aps;
+    // the strongest BSSID, this is the one the row joins.
+    NMAccessPoint *best;
+    QuickSettingsGridWifiMenuOption *opt;
+    // the displayed state, the row is only touched when these change.
+    gint bucket;
+    gboolean active;
+} WifiMenuNetwork;
+
 typedef struct _QuickSettingsGridWifiMenu {
     GObject parent_instance;
     QuickSettingsMenuWidget menu;
-    GPtrArray *ap_options;
+    // ssid -> WifiMenuNetwork
+    GHashTable *networks;
+    // NMAccessPoint -> WifiMenuNetwork
+    GHashTable *ap_networks;
+    // whether the device is in a state where its APs should be listed.
+    gboolean available;
+    guint sort_id;
     NMDeviceWifi *dev;
     GCancellable *cancel_scan;
     gint64 last_scan;
@@ -29,28 +50,34 @@ typedef struct _QuickSettingsGridWifiMenu {
 G_DEFINE_TYPE(QuickSettingsGridWifiMenu, quick_settings_grid_wifi_menu,
               G_TYPE_OBJECT);
 
-static void wifi_device_get_aps(NMDeviceWifi *wifi, GParamSpec *pspec,
-                                QuickSettingsGridWifiMenu *self);
+static void on_device_state_changed(NMDeviceWifi *wifi, GParamSpec *pspec,
+                                    QuickSettingsGridWifiMenu *self);
+
+static void on_ap_added(NMDeviceWifi *wifi, NMAccessPoint *ap,
+                        QuickSettingsGridWifiMenu *self);
+
+static void on_ap_removed(NMDeviceWifi *wifi, NMAccessPoint *ap,
+                          QuickSettingsGridWifiMenu *self);
 
 // stub out dispose, finalize, init and class init functions for GObject
 static void quick_settings_grid_wifi_menu_dispose(GObject *object) {
     QuickSettingsGridWifiMenu *self = QUICK_SETTINGS_GRID_WIFI_MENU(object);
 
-    GtkWidget *child =
-        gtk_widget_get_first_child(GTK_WIDGET(self->menu.options));
-    while (child) {
-        QuickSettingsGridWifiMenuOption *opt =
-            g_object_get_data(G_OBJECT(child), "opt");
-
-        gtk_box_remove(self->menu.options, child);
-
-        child = gtk_widget_get_first_child(GTK_WIDGET(self->menu.options));
-
-        g_object_unref(opt);
+    if (self->sort_id) {
+        g_source_remove(self->sort_id);
+        self->sort_id = 0;
     }
 
+    // removes every row and the access point signals.
+    g_hash_table_remove_all(self->networks);
+
     // disconnect from signal
-    g_signal_handlers_disconnect_by_func(self->dev, wifi_device_get_aps, self);
+    if (self->dev) {
+        g_signal_handlers_disconnect_by_func(self->dev, on_device_state_changed,
+                                             self);
+        g_signal_handlers_disconnect_by_func(self->dev, on_ap_added, self);
+        g_signal_handlers_disconnect_by_func(self->dev, on_ap_removed, self);
+    }
 }
 
 static void quick_settings_grid_wifi_menu_finalize(GObject *object) {}
@@ -67,113 +94,282 @@ static void quick_settings_grid_wifi_menu_class_init(
                  QUICK_SETTINGS_GRID_WIFI_MENU_OPTION_TYPE);
 }
 
-static void wifi_device_get_aps(NMDeviceWifi *wifi, GParamSpec *pspec,
-                                QuickSettingsGridWifiMenu *self) {
-    const GPtrArray *aps = nm_device_wifi_get_access_points(wifi);
-    NMDeviceState state = nm_device_get_state(NM_DEVICE(wifi));
-    NMAccessPoint *active = nm_device_wifi_get_active_access_point(wifi);
+static void on_ap_strength_changed(NMAccessPoint *ap, GParamSpec *pspec,
+                                   QuickSettingsGridWifiMenu *self);
 
-    g_debug(
-        "quick_settings_grid_wifi_menu.c:wifi_device_get_aps() called, device "
-        "state "
-        "[%d]",
-        state);
+// Matches the buckets network_manager_service_ap_strength_to_icon_name()
+// picks icons by.
+static gint wifi_ap_strength_bucket(guint8 strength) {
+    return MIN(strength / 25, 3);
+}
 
-    if (state == NM_DEVICE_STATE_FAILED) {
-        g_debug("quick_settings_grid_wifi_menu.c:wifi_device_get_aps() failed");
-        gtk_revealer_set_reveal_child(self->menu.banner, true);
+// Returns a newly allocated SSID for `ap` or NULL if it has no name.
+static gchar *wifi_ap_ssid(NMAccessPoint *ap) {
+    GBytes *bytes = nm_access_point_get_ssid(ap);
+    if (!bytes) return NULL;
+
+    if (nm_utils_is_empty_ssid(g_bytes_get_data(bytes, NULL),
+                               g_bytes_get_size(bytes)))
+        return NULL;
+
+    return nm_utils_ssid_to_utf8(g_bytes_get_data(bytes, NULL),
+                                 g_bytes_get_size(bytes));
+}
+
+static void wifi_menu_network_free(WifiMenuNetwork *n) {
+    QuickSettingsGridWifiMenu *self = n->menu;
+
+    for (guint i = 0; i < n->aps->len; i++) {
+        NMAccessPoint *ap = g_ptr_array_index(n->aps, i);
+        g_signal_handlers_disconnect_by_func(ap, on_ap_strength_changed, self);
+        g_hash_table_remove(self->ap_networks, ap);
     }
-    if (state == NM_DEVICE_STATE_ACTIVATED) {
-        gtk_revealer_set_reveal_child(self->menu.banner, false);
+    g_ptr_array_unref(n->aps);
+
+    if (n->opt) {
+        gtk_box_remove(self->menu.options,
+                       quick_settings_grid_wifi_menu_option_get_widget(n->opt));
+        g_object_unref(n->opt);
     }
 
-    g_debug("quick_settings_grid_wifi_menu.c:wifi_device_get_aps() called");
+    g_free(n->ssid);
+    g_free(n);
+}
 
-    // remove all options from self->menu.container
-    GtkWidget *child =
-        gtk_widget_get_first_child(GTK_WIDGET(self->menu.options));
-    while (child) {
-        QuickSettingsGridWifiMenuOption *opt =
-            g_object_get_data(G_OBJECT(child), "opt");
+// Active network first, then by signal strength bucket and name. Sorting on
+// the bucket rather than the raw strength keeps rows from jumping around on
+// every small signal fluctuation.
+static gint wifi_menu_network_compare(gconstpointer a, gconstpointer b) {
+    const WifiMenuNetwork *na = *(WifiMenuNetwork **)a;
+    const WifiMenuNetwork *nb = *(WifiMenuNetwork **)b;
 
-        gtk_box_remove(self->menu.options, child);
+    if (na->active != nb->active) return na->active ? -1 : 1;
+    if (na->bucket != nb->bucket) return nb->bucket - na->bucket;
+    return g_strcmp0(na->ssid, nb->ssid);
+}
+
+static gboolean wifi_menu_sort(QuickSettingsGridWifiMenu *self) {
+    self->sort_id = 0;
+
+    GPtrArray *sorted = g_ptr_array_new();
+    GHashTableIter iter;
+    WifiMenuNetwork *n;
+    g_hash_table_iter_init(&iter, self->networks);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&n))
+        g_ptr_array_add(sorted, n);
+    g_ptr_array_sort(sorted, wifi_menu_network_compare);
+
+    // only move rows which are out of place.
+    GtkWidget *prev = NULL;
+    for (guint i = 0; i < sorted->len; i++) {
+        n = g_ptr_array_index(sorted, i);
+        GtkWidget *w = quick_settings_grid_wifi_menu_option_get_widget(n->opt);
+        if (gtk_widget_get_prev_sibling(w) != prev)
+            gtk_box_reorder_child_after(self->menu.options, w, prev);
+        prev = w;
+    }
+    g_ptr_array_unref(sorted);
 
-        child = gtk_widget_get_first_child(GTK_WIDGET(self->menu.options));
+    return G_SOURCE_REMOVE;
+}
+
+// Sorting is deferred so a burst of deltas from a single scan results in a
+// single sort.
+static void wifi_menu_queue_sort(QuickSettingsGridWifiMenu *self) {
+    if (self->sort_id) return;
+    self->sort_id = g_idle_add((GSourceFunc)wifi_menu_sort, self);
+}
 
-        g_object_unref(opt);
+// Recomputes the strongest BSSID of `n` and updates its row if the displayed
+// state changed. Returns TRUE if the row's sort position may have changed.
+static gboolean wifi_menu_network_refresh(QuickSettingsGridWifiMenu *self,
+                                          WifiMenuNetwork *n) {
+    NMAccessPoint *active_ap =
+        nm_device_wifi_get_active_access_point(self->dev);
+    NMAccessPoint *best = NULL;
+    gboolean active = false;
+
+    for (guint i = 0; i < n->aps->len; i++) {
+        NMAccessPoint *ap = g_ptr_array_index(n->aps, i);
+        if (ap == active_ap) active = true;
+        if (!best || nm_access_point_get_strength(ap) >
+                         nm_access_point_get_strength(best))
+            best = ap;
     }
 
-    // if we have a state which suggests the device should not be read for ap's
-    // don't.
-    // funny enough when you disable your wifi card with "nmcli radio wifi off "
-    // it will send all the last seen APs for one event additional event.
-    switch (state) {
-        case NM_DEVICE_STATE_UNKNOWN:
-        case NM_DEVICE_STATE_UNAVAILABLE:
-        case NM_DEVICE_STATE_UNMANAGED:
-            return;
-        default:;
+    // joining the active BSSID keeps the row consistent with the active icon.
+    if (active) best = active_ap;
+
+    gint bucket = wifi_ap_strength_bucket(nm_access_point_get_strength(best));
+
+    if (!n->opt) {
+        n->opt = g_object_new(QUICK_SETTINGS_GRID_WIFI_MENU_OPTION_TYPE, NULL);
+
+        // attach pointer to opt on main widget's data
+        g_object_set_data(
+            G_OBJECT(quick_settings_grid_wifi_menu_option_get_widget(n->opt)),
+            "opt", n->opt);
+
+        n->best = best;
+        n->bucket = bucket;
+        n->active = active;
+        quick_settings_grid_wifi_menu_option_set_ap(n->opt, self, self->dev,
+                                                    best);
+        gtk_box_append(self->menu.options,
+                       quick_settings_grid_wifi_menu_option_get_widget(n->opt));
+        return true;
     }
 
-    QuickSettingsGridWifiMenuOption *active_option = NULL;
+    if (n->bucket == bucket && n->active == active) {
+        if (n->best != best)
+            quick_settings_grid_wifi_menu_option_retarget_ap(n->opt, best);
+        n->best = best;
+        return false;
+    }
 
-    // we want to iterate over all APs and filter out
-    // 1. APs with no names
-    // 2. APs with duplicate SSIDs, picking the one with the strongest
-    // signal
-    GHashTable *best_aps = g_hash_table_new(g_str_hash, g_str_equal);
+    n->best = best;
+    n->bucket = bucket;
+    n->active = active;
+    quick_settings_grid_wifi_menu_option_set_ap(n->opt, self, self->dev, best);
+    return true;
+}
 
-    for (int i = 0; i < aps->len; i++) {
-        NMAccessPoint *ap = g_ptr_array_index(aps, i);
+static void wifi_menu_add_ap(QuickSettingsGridWifiMenu *self,
+                             NMAccessPoint *ap) {
+    if (g_hash_table_contains(self->ap_networks, ap)) return;
+
+    // if no ssid, just skip.
+    gchar *ssid = wifi_ap_ssid(ap);
+    if (!ssid) return;
+
+    WifiMenuNetwork *n = g_hash_table_lookup(self->networks, ssid);
+    if (!n) {
+        n = g_malloc0(sizeof(WifiMenuNetwork));
+        n->menu = self;
+        n->ssid = ssid;
+        n->aps = g_ptr_array_new_with_free_func(g_object_unref);
+        g_hash_table_insert(self->networks, n->ssid, n);
+    } else {
+        g_free(ssid);
+    }
+
+    g_ptr_array_add(n->aps, g_object_ref(ap));
+    g_hash_table_insert(self->ap_networks, ap, n);
+    g_signal_connect(ap, "notify::strength",
+                     G_CALLBACK(on_ap_strength_changed), self);
+
+    if (wifi_menu_network_refresh(self, n)) wifi_menu_queue_sort(self);
+}
 
-        // if no ssid, just skip.
-        if (!nm_access_point_get_ssid(ap)) continue;
+static void wifi_menu_remove_ap(QuickSettingsGridWifiMenu *self,
+                                NMAccessPoint *ap) {
+    WifiMenuNetwork *n = g_hash_table_lookup(self->ap_networks, ap);
+    if (!n) return;
 
-        const char *ssid = network_manager_service_ap_to_name(ap);
+    g_signal_handlers_disconnect_by_func(ap, on_ap_strength_changed, self);
+    g_hash_table_remove(self->ap_networks, ap);
+    g_ptr_array_remove(n->aps, ap);
 
-        NMAccessPoint *seen = g_hash_table_lookup(best_aps, ssid);
-        if (seen) {
-            double seen_signal = nm_access_point_get_strength(seen);
-            double ap_signal = nm_access_point_get_strength(ap);
-            if (ap_signal > seen_signal)
-                g_hash_table_replace(best_aps, (gpointer)ssid, ap);
-        } else {
-            g_hash_table_insert(best_aps, (gpointer)ssid, ap);
-        }
+    // last BSSID of this network is gone, drop its row.
+    if (n->aps->len == 0) {
+        g_hash_table_remove(self->networks, n->ssid);
+        return;
     }
 
-    GList *best_aps_values = g_hash_table_get_values(best_aps);
-    for (GList *iter = best_aps_values; iter; iter = g_list_next(iter)) {
-        NMAccessPoint *ap = iter->data;
+    if (wifi_menu_network_refresh(self, n)) wifi_menu_queue_sort(self);
+}
 
-        QuickSettingsGridWifiMenuOption *opt =
-            g_object_new(QUICK_SETTINGS_GRID_WIFI_MENU_OPTION_TYPE, NULL);
+// Diffs the device's full access point list against the model. Used to seed
+// the model and to resync after an explicit scan.
+static void wifi_menu_sync_aps(QuickSettingsGridWifiMenu *self) {
+    const GPtrArray *aps = nm_device_wifi_get_access_points(self->dev);
+    GHashTable *seen = g_hash_table_new(g_direct_hash, g_direct_equal);
 
-        // attach pointer to opt on main widget's data
-        g_object_set_data(
-            G_OBJECT(quick_settings_grid_wifi_menu_option_get_widget(opt)),
-            "opt", opt);
+    for (guint i = 0; i < aps->len; i++) {
+        NMAccessPoint *ap = g_ptr_array_index(aps, i);
+        g_hash_table_add(seen, ap);
+        wifi_menu_add_ap(self, ap);
+    }
 
-        quick_settings_grid_wifi_menu_option_set_ap(opt, self, wifi, ap);
+    GList *known = g_hash_table_get_keys(self->ap_networks);
+    for (GList *l = known; l; l = l->next)
+        if (!g_hash_table_contains(seen, l->data))
+            wifi_menu_remove_ap(self, l->data);
+    g_list_free(known);
 
-        // check if this is the active ap
-        if (active == ap) {
-            active_option = opt;
-            continue;
-        }
+    g_hash_table_unref(seen);
+}
 
-        gtk_box_append(self->menu.options,
-                       quick_settings_grid_wifi_menu_option_get_widget(opt));
+static void on_ap_added(NMDeviceWifi *wifi, NMAccessPoint *ap,
+                        QuickSettingsGridWifiMenu *self) {
+    if (!self->available) return;
+    wifi_menu_add_ap(self, ap);
+}
+
+static void on_ap_removed(NMDeviceWifi *wifi, NMAccessPoint *ap,
+                          QuickSettingsGridWifiMenu *self) {
+    wifi_menu_remove_ap(self, ap);
+}
+
+static void on_ap_strength_changed(NMAccessPoint *ap, GParamSpec *pspec,
+                                   QuickSettingsGridWifiMenu *self) {
+    WifiMenuNetwork *n = g_hash_table_lookup(self->ap_networks, ap);
+    if (!n) return;
+    if (wifi_menu_network_refresh(self, n)) wifi_menu_queue_sort(self);
+}
+
+static void on_device_state_changed(NMDeviceWifi *wifi, GParamSpec *pspec,
+                                    QuickSettingsGridWifiMenu *self) {
+    NMDeviceState state = nm_device_get_state(NM_DEVICE(wifi));
+
+    g_debug(
+        "quick_settings_grid_wifi_menu.c:on_device_state_changed() called, "
+        "device state [%d]",
+        state);
+
+    if (state == NM_DEVICE_STATE_FAILED) {
+        g_debug(
+            "quick_settings_grid_wifi_menu.c:on_device_state_changed() "
+            "failed");
+        gtk_revealer_set_reveal_child(self->menu.banner, true);
+    }
+    if (state == NM_DEVICE_STATE_ACTIVATED) {
+        gtk_revealer_set_reveal_child(self->menu.banner, false);
+    }
+
+    // if we have a state which suggests the device should not be read for ap's
+    // don't.
+    // funny enough when you disable your wifi card with "nmcli radio wifi off "
+    // it will send all the last seen APs for one event additional event.
+    switch (state) {
+        case NM_DEVICE_STATE_UNKNOWN:
+        case NM_DEVICE_STATE_UNAVAILABLE:
+        case NM_DEVICE_STATE_UNMANAGED:
+            self->available = false;
+            g_hash_table_remove_all(self->networks);
+            return;
+        default:;
     }
 
-    // we can free best_aps now
-    g_hash_table_unref(best_aps);
+    if (!self->available) {
+        self->available = true;
+        wifi_menu_sync_aps(self);
+        return;
+    }
 
-    // always keep active option on top
-    if (active_option) {
-        gtk_box_prepend(
-            self->menu.options,
-            quick_settings_grid_wifi_menu_option_get_widget(active_option));
+    // the active access point may have changed, refresh_network only touches
+    // rows whose active state actually flipped.
+    GHashTableIter iter;
+    WifiMenuNetwork *n;
+    g_hash_table_iter_init(&iter, self->networks);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&n)) {
+        gboolean was_active = n->active;
+        if (wifi_menu_network_refresh(self, n)) wifi_menu_queue_sort(self);
+        // the active row shows connection progress, which follows the device
+        // state.
+        if (was_active && n->active)
+            quick_settings_grid_wifi_menu_option_update_ap(n->opt, self->dev,
+                                                           n->best);
     }
 }
 
@@ -234,7 +430,9 @@ static void quick_settings_grid_wifi_menu_init_layout(
 static void quick_settings_grid_wifi_menu_init(
     QuickSettingsGridWifiMenu *self) {
     self->cancel_scan = g_cancellable_new();
-    self->ap_options = g_ptr_array_new();
+    self->networks = g_hash_table_new_full(
+        g_str_hash, g_str_equal, NULL, (GDestroyNotify)wifi_menu_network_free);
+    self->ap_networks = g_hash_table_new(g_direct_hash, g_direct_equal);
     quick_settings_grid_wifi_menu_init_layout(self);
 }
 
@@ -244,7 +442,15 @@ void quick_settings_grid_wifi_menu_set_device(QuickSettingsGridWifiMenu *self,
 
     // wire into active access point change
     g_signal_connect(self->dev, "notify::state",
-                     G_CALLBACK(wifi_device_get_aps), self);
+                     G_CALLBACK(on_device_state_changed), self);
+
+    // background scans are applied as deltas
+    g_signal_connect(self->dev, "access-point-added", G_CALLBACK(on_ap_added),
+                     self);
+    g_signal_connect(self->dev, "access-point-removed",
+                     G_CALLBACK(on_ap_removed), self);
+
+    on_device_state_changed(self->dev, NULL, self);
 }
 
 void quick_settings_grid_wifi_menu_on_scan_done(GObject *object,
@@ -263,7 +469,7 @@ void quick_settings_grid_wifi_menu_on_scan_done(GObject *object,
             error->message);
         g_clear_error(&error);
     }
-    wifi_device_get_aps(dev, NULL, self);
+    if (self->available) wifi_menu_sync_aps(self);
     gtk_spinner_stop(self->spinner);
     gtk_widget_set_visible(GTK_WIDGET(self->spinner), false);
 }
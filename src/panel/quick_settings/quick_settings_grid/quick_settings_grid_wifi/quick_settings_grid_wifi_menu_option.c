@@ -24,6 +24,8 @@ typedef struct _QuickSettingsGridWifiMenuOption {
     GtkPasswordEntry *password_entry;
     GtkSpinner *spinner;
     gboolean has_sec;
+    // handlers are wired for `has_sec`, rewired when a rebind changes it.
+    gboolean wired;
 } QuickSettingsGridWifiMenuOption;
 
 // stub out the GObject interface.
@@ -46,10 +48,9 @@ static void quick_settings_grid_wifi_menu_option_dispose(GObject *self_) {
     QuickSettingsGridWifiMenuOption *self =
         QUICK_SETTINGS_GRID_WIFI_MENU_OPTION(self_);
 
-    if (self->has_sec) {
+    if (self->menu)
         g_signal_handlers_disconnect_by_func(
             self->menu, on_menu_password_entry_revealed, self);
-    };
 
     G_OBJECT_CLASS(quick_settings_grid_wifi_menu_option_parent_class)
         ->dispose(self_);
@@ -192,31 +193,67 @@ static void on_password_entry_activate(GtkPasswordEntry *entry,
     network_manager_service_ap_join(nm, self->dev, self->ap, password);
 }
 
+// Connects the click, password entry and menu handlers matching `has_sec`,
+// dropping any wired for a previous binding.
+static void quick_settings_grid_wifi_menu_option_wire(
+    QuickSettingsGridWifiMenuOption *self) {
+    g_signal_handlers_disconnect_by_func(self->button, on_button_click_no_sec,
+                                         self);
+    g_signal_handlers_disconnect_by_func(self->button,
+                                         on_button_click_with_sec, self);
+    g_signal_handlers_disconnect_by_func(self->password_entry,
+                                         on_password_entry_activate, self);
+    g_signal_handlers_disconnect_by_func(
+        self->menu, on_menu_password_entry_revealed, self);
+
+    self->wired = true;
+
+    if (!self->has_sec) {
+        gtk_revealer_set_reveal_child(self->revealer, false);
+        g_signal_connect(self->button, "clicked",
+                         G_CALLBACK(on_button_click_no_sec), self);
+        return;
+    }
+
+    g_signal_connect(self->button, "clicked",
+                     G_CALLBACK(on_button_click_with_sec), self);
+    g_signal_connect(self->password_entry, "activate",
+                     G_CALLBACK(on_password_entry_activate), self);
+    // listen for menu to tell us other password entries have been revealed
+    // to close ours
+    g_signal_connect(self->menu, "password-entry-revealed",
+                     G_CALLBACK(on_menu_password_entry_revealed), self);
+}
+
 void quick_settings_grid_wifi_menu_option_update_ap(
     QuickSettingsGridWifiMenuOption *self, NMDeviceWifi *dev,
     NMAccessPoint *ap) {
     NMDeviceState state = nm_device_get_state(NM_DEVICE(dev));
     gboolean is_active_ap = nm_device_wifi_get_active_access_point(dev) == ap;
+    gboolean had_sec = self->has_sec;
 
     self->has_sec = false;
     if (nm_access_point_get_wpa_flags(ap) != NM_802_11_AP_SEC_NONE ||
         nm_access_point_get_rsn_flags(ap) != NM_802_11_AP_SEC_NONE)
         self->has_sec = true;
 
+    // rows are reused across refreshes, an ap may gain or lose security.
+    if (self->menu && (!self->wired || had_sec != self->has_sec))
+        quick_settings_grid_wifi_menu_option_wire(self);
+
     if (self->has_sec)
         gtk_image_set_from_icon_name(self->sec_icon,
                                      "network-wireless-encrypted-symbolic");
     else
         gtk_image_set_from_icon_name(self->sec_icon, NULL);
 
-    if (is_active_ap) {
-        // unhide spinner and start it
+    // spin while the active ap is still connecting, rows are reused so a
+    // row which is no longer the active ap must stop spinning too.
+    if (is_active_ap && state != NM_DEVICE_STATE_FAILED &&
+        state != NM_DEVICE_STATE_ACTIVATED) {
         gtk_widget_set_visible(GTK_WIDGET(self->spinner), true);
         gtk_spinner_start(self->spinner);
-    }
-
-    if (is_active_ap && state == NM_DEVICE_STATE_FAILED) {
-        // stop spinner and hide it
+    } else {
         gtk_spinner_stop(self->spinner);
         gtk_widget_set_visible(GTK_WIDGET(self->spinner), false);
     }
@@ -231,13 +268,8 @@ void quick_settings_grid_wifi_menu_option_update_ap(
                                  nm_access_point_get_strength(ap)));
 
     // if active ap set active icon visible
-    if (is_active_ap && state == NM_DEVICE_STATE_ACTIVATED) {
-        gtk_widget_set_visible(GTK_WIDGET(self->active_icon), true);
-        // hide spinner and stop it
-        gtk_spinner_stop(self->spinner);
-        gtk_widget_set_visible(GTK_WIDGET(self->spinner), false);
-    } else
-        gtk_widget_set_visible(GTK_WIDGET(self->active_icon), false);
+    gtk_widget_set_visible(GTK_WIDGET(self->active_icon),
+                           is_active_ap && state == NM_DEVICE_STATE_ACTIVATED);
 }
 
 static void on_menu_password_entry_revealed(
@@ -249,33 +281,17 @@ static void on_menu_password_entry_revealed(
 void quick_settings_grid_wifi_menu_option_set_ap(
     QuickSettingsGridWifiMenuOption *self, QuickSettingsGridWifiMenu *menu,
     NMDeviceWifi *dev, NMAccessPoint *ap) {
-    NMAccessPoint *old_ap = self->ap;
     self->ap = ap;
     self->dev = dev;
     self->menu = menu;
 
+    // wires signals on first bind, and rewires them if `has_sec` changed.
     quick_settings_grid_wifi_menu_option_update_ap(self, dev, ap);
+}
 
-    // this was just a update of the existing AP.
-    if (old_ap == self->ap) {
-        return;
-    }
-
-    // add signals
-    if (self->has_sec) {
-        g_signal_connect(self->button, "clicked",
-                         G_CALLBACK(on_button_click_with_sec), self);
-
-        g_signal_connect(self->password_entry, "activate",
-                         G_CALLBACK(on_password_entry_activate), self);
-        // listen for menu to tell us other password entries have been revealed
-        // to close ours
-        g_signal_connect(menu, "password-entry-revealed",
-                         G_CALLBACK(on_menu_password_entry_revealed), self);
-    } else {
-        g_signal_connect(self->button, "clicked",
-                         G_CALLBACK(on_button_click_no_sec), self);
-    }
+void quick_settings_grid_wifi_menu_option_retarget_ap(
+    QuickSettingsGridWifiMenuOption *self, NMAccessPoint *ap) {
+    self->ap = ap;
 }
 
 GtkWidget *quick_settings_grid_wifi_menu_option_get_widget(
@@ -21,6 +21,16 @@ void quick_settings_grid_wifi_menu_option_set_ap(
     QuickSettingsGridWifiMenuOption *self, QuickSettingsGridWifiMenu *menu,
     NMDeviceWifi *dev, NMAccessPoint *ap);
 
+// Updates the option's displayed state for `ap`.
+void quick_settings_grid_wifi_menu_option_update_ap(
+    QuickSettingsGridWifiMenuOption *self, NMDeviceWifi *dev,
+    NMAccessPoint *ap);
+
+// Points the option at another BSSID of the same network without touching
+// any widgets.
+void quick_settings_grid_wifi_menu_option_retarget_ap(
+    QuickSettingsGridWifiMenuOption *self, NMAccessPoint *ap);
+
 // ap getter
 NMAccessPoint *quick_settings_grid_wifi_menu_option_get_ap(
     QuickSettingsGridWifiMenuOption *self);
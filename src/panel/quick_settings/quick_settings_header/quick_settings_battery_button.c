@@ -11,7 +11,6 @@ typedef struct _QuickSettingsBatteryButton {
     GtkImage *icon;
     GtkLabel *percentage;
     GtkButton *button;
-    UpDevice *device;
     // 20% battery power left warning notification
     gboolean warning_notification_sent;
     // 15% battery power left warning notification
@@ -22,25 +21,24 @@ typedef struct _QuickSettingsBatteryButton {
 G_DEFINE_TYPE(QuickSettingsBatteryButton, quick_settings_battery_button,
               G_TYPE_OBJECT);
 
-static void on_power_dev_notify(UpDevice *power_dev, GParamSpec *pspec,
-                                QuickSettingsBatteryButton *self) {
-    char *icon = NULL;
-    double percent = 0;
+static void on_battery_changed(UPowerService *upower,
+                               const UPowerBattery *battery,
+                               QuickSettingsBatteryButton *self) {
+    guint percent = battery->percentage;
 
     NotificationsService *notifs = notifications_service_get_global();
 
-    g_debug("quick_settings_battery_button.c:on_power_dev_notify() called.");
+    g_debug("quick_settings_battery_button.c:on_battery_changed() icon: %s",
+            battery->icon_name);
 
-    g_object_get(power_dev, "percentage", &percent, NULL);
+    gtk_image_set_from_icon_name(self->icon, battery->icon_name);
 
-    icon = upower_device_map_icon_name(power_dev);
+    gchar *percentage_str = g_strdup_printf("%u%%", percent);
+    gtk_label_set_text(self->percentage, percentage_str);
+    g_free(percentage_str);
 
-    gtk_image_set_from_icon_name(self->icon, icon);
-
-    g_debug("quick_settings_battery_button.c:on_power_dev_notify() icon: %s",
-            icon);
-
-    gtk_label_set_text(self->percentage, g_strdup_printf("%.0f%%", percent));
+    // nothing to warn about without a battery.
+    if (!battery->present) return;
 
     // reset notification sent values
     if (percent > 5) {
@@ -54,14 +52,9 @@ static void on_power_dev_notify(UpDevice *power_dev, GParamSpec *pspec,
     }
 
     // if device is charging don't bother sending events below
-    guint state = 0;
-    g_object_get(power_dev, "state", &state, NULL);
-    gboolean charging = (state == UP_DEVICE_STATE_CHARGING ||
-                         state == UP_DEVICE_STATE_FULLY_CHARGED ||
-                         state == UP_DEVICE_STATE_PENDING_CHARGE);
-    if (charging) return;
+    if (battery->charging) return;
 
-    gchar *body = g_strdup_printf("Battery is at %.0f%% power.", percent);
+    gchar *body = g_strdup_printf("Battery is at %u%% power.", percent);
 
     // send a notification if percent is in specific range, and notification
     // was not sent
@@ -112,8 +105,8 @@ static void quick_settings_battery_button_dispose(GObject *gobject) {
         ") called.");
 
     // disconnect from signals
-    g_signal_handlers_disconnect_by_func(self->device,
-                                         G_CALLBACK(on_power_dev_notify), self);
+    UPowerService *upower = upower_service_get_global();
+    g_signal_handlers_disconnect_by_func(upower, on_battery_changed, self);
 
     // Chain-up
     G_OBJECT_CLASS(quick_settings_battery_button_parent_class)
@@ -136,15 +129,7 @@ static void quick_settings_battery_button_class_init(
 static void quick_settings_battery_button_init_layout(
     QuickSettingsBatteryButton *self) {
     UPowerService *upower = upower_service_get_global();
-    char *icon = NULL;
-    double percent = 0;
-
-    // get primary power device
-    UpDevice *power_dev = upower_service_get_primary_device(upower);
-
-    icon = upower_device_map_icon_name(power_dev);
-
-    g_object_get(power_dev, "percentage", &percent, NULL);
+    const UPowerBattery *battery = upower_service_get_battery(upower);
 
     self->container = GTK_BOX(gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0));
     gtk_widget_set_name(GTK_WIDGET(self->container),
@@ -154,10 +139,11 @@ static void quick_settings_battery_button_init_layout(
     // add css class
     gtk_widget_add_css_class(GTK_WIDGET(self->button), "battery-button");
 
-    self->icon = GTK_IMAGE(gtk_image_new_from_icon_name(icon));
+    self->icon = GTK_IMAGE(gtk_image_new_from_icon_name(battery->icon_name));
 
-    self->percentage =
-        GTK_LABEL(gtk_label_new(g_strdup_printf("%.0f%%", percent)));
+    gchar *percentage_str = g_strdup_printf("%u%%", battery->percentage);
+    self->percentage = GTK_LABEL(gtk_label_new(percentage_str));
+    g_free(percentage_str);
 
     // add button icon as first child of battery button container
     gtk_box_append(self->container, GTK_WIDGET(self->icon));
@@ -168,14 +154,9 @@ static void quick_settings_battery_button_init_layout(
     // add container as child of battery button
     gtk_button_set_child(self->button, GTK_WIDGET(self->container));
 
-    // setup notify signal
-    g_signal_connect(power_dev, "notify::icon-name",
-                     G_CALLBACK(on_power_dev_notify), self);
-    g_signal_connect(power_dev, "notify::percentage",
-                     G_CALLBACK(on_power_dev_notify), self);
-
-    self->device = power_dev;
-    g_object_ref(self->device);
+    // the service only emits when the displayed battery changes.
+    g_signal_connect(upower, "battery-changed", G_CALLBACK(on_battery_changed),
+                     self);
 }
 
 static void quick_settings_battery_button_init(
@@ -191,10 +172,8 @@ GtkWidget *quick_settings_battery_button_get_widget(
 void quick_settings_battery_button_reinitialize(
     QuickSettingsBatteryButton *self) {
     // kill signals
-    g_signal_handlers_disconnect_by_func(self->device,
-                                         G_CALLBACK(on_power_dev_notify), self);
-    // unref power device
-    g_object_unref(self->device);
+    UPowerService *upower = upower_service_get_global();
+    g_signal_handlers_disconnect_by_func(upower, on_battery_changed, self);
 
     // init our layout
     quick_settings_battery_button_init_layout(self);
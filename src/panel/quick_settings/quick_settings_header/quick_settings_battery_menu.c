@@ -19,41 +19,34 @@ typedef struct _QuickSettingsBatteryMenu {
 G_DEFINE_TYPE(QuickSettingsBatteryMenu, quick_settings_battery_menu,
               G_TYPE_OBJECT);
 
-static void on_power_dev_notify(UpDevice *power_dev, GParamSpec *pspec,
-                                QuickSettingsBatteryMenu *self) {
-    g_debug("quick_settings_battery_button.c:on_power_dev_notify() called.");
+static void on_battery_changed(UPowerService *upower,
+                               const UPowerBattery *battery,
+                               QuickSettingsBatteryMenu *self) {
+    g_debug("quick_settings_battery_menu.c:on_battery_changed() called.");
 
-    gchar *icon_name = upower_device_map_icon_name(power_dev);
-    gtk_image_set_from_icon_name(self->menu.icon, icon_name);
+    gtk_image_set_from_icon_name(self->menu.icon, battery->icon_name);
 
-    gboolean is_recharable = false;
-    g_object_get(power_dev, "is-rechargeable", &is_recharable, NULL);
-    if (!is_recharable) {
+    // nothing to estimate without a battery.
+    if (!battery->present) {
         gtk_range_set_value(GTK_RANGE(self->battery_scale), 100);
         gtk_label_set_text(self->battery_time, "");
+        gtk_label_set_text(self->battery_percentage, "");
+        return;
     }
 
-    double percent = 0;
-    guint state = 0;
-    g_object_get(power_dev, "percentage", &percent, NULL);
-    g_object_get(power_dev, "state", &state, NULL);
+    guint percent = battery->percentage;
 
     // update battery scale
     gtk_range_set_value(GTK_RANGE(self->battery_scale), percent);
 
     // update percentage
-    gchar *percentage_str = g_strdup_printf("%.0f%%", percent);
+    gchar *percentage_str = g_strdup_printf("%u%%", percent);
     gtk_label_set_text(self->battery_percentage, percentage_str);
     g_free(percentage_str);
 
-    gboolean charging = (state == UP_DEVICE_STATE_CHARGING ||
-                         state == UP_DEVICE_STATE_FULLY_CHARGED ||
-                         state == UP_DEVICE_STATE_PENDING_CHARGE);
-
     gchar *time_str = NULL;
-    if (charging) {
-        gint64 time_to_full = 0;
-        g_object_get(power_dev, "time-to-full", &time_to_full, NULL);
+    if (battery->charging) {
+        gint64 time_to_full = battery->time_to_full;
 
         gint64 hours = (time_to_full / (60 * 60));
         gint64 minutes = (time_to_full / 60) % 60;
@@ -65,8 +58,7 @@ static void on_power_dev_notify(UpDevice *power_dev, GParamSpec *pspec,
             time_str = g_strdup_printf("%ld Minutes Until Full", minutes);
         }
     } else {
-        gint64 time_to_empty = 0;
-        g_object_get(power_dev, "time-to-empty", &time_to_empty, NULL);
+        gint64 time_to_empty = battery->time_to_empty;
 
         gint64 hours = (time_to_empty / (60 * 60));
         gint64 minutes = (time_to_empty / 60) % 60;
@@ -108,9 +100,7 @@ static void quick_settings_battery_menu_dispose(GObject *gobject) {
     g_signal_handlers_disconnect_by_func(qs, on_quick_settings_hidden, gobject);
 
     UPowerService *upower = upower_service_get_global();
-    UpDevice *power_dev = upower_service_get_primary_device(upower);
-    g_signal_handlers_disconnect_by_func(power_dev, on_power_dev_notify,
-                                         gobject);
+    g_signal_handlers_disconnect_by_func(upower, on_battery_changed, gobject);
 
     // Chain-up
     G_OBJECT_CLASS(quick_settings_battery_menu_parent_class)->dispose(gobject);
@@ -164,12 +154,10 @@ static void quick_settings_battery_menu_init_layout(
 
     UPowerService *upower = upower_service_get_global();
 
-    // get primary power device
-    UpDevice *power_dev = upower_service_get_primary_device(upower);
-
-    on_power_dev_notify(power_dev, NULL, self);
+    on_battery_changed(upower, upower_service_get_battery(upower), self);
 
-    g_signal_connect(power_dev, "notify", G_CALLBACK(on_power_dev_notify),
+    // the service only emits when the displayed battery changes.
+    g_signal_connect(upower, "battery-changed", G_CALLBACK(on_battery_changed),
                      self);
 
     // wire into quick settings hidden event and close all revealers
@@ -183,10 +171,9 @@ void quick_settings_battery_menu_reinitialize(QuickSettingsBatteryMenu *self) {
     QuickSettings *qs = quick_settings_get_global();
     g_signal_handlers_disconnect_by_func(qs, on_quick_settings_hidden, self);
 
-    // kill signals to power device
+    // kill signals to power service
     UPowerService *upower = upower_service_get_global();
-    UpDevice *power_dev = upower_service_get_primary_device(upower);
-    g_signal_handlers_disconnect_by_func(power_dev, on_power_dev_notify, self);
+    g_signal_handlers_disconnect_by_func(upower, on_battery_changed, self);
 
     quick_settings_battery_menu_init_layout(self);
 }
@@ -13,16 +13,29 @@ typedef struct _QuickSettingsHeaderMixer {
     QuickSettingsMenuWidget menu;
     GtkButton *mixer_button;
     GtkBox *container;
-    GHashTable *nodes;
+    // QuickSettingsHeaderMixerMenuOption(s) in menu.options keyed by node id.
+    GHashTable *rows;
+    // nodes were added while the menu was hidden, rows are created on map.
+    gboolean rows_stale;
+    // ids of stream rows whose link dropdowns need refreshing.
+    GHashTable *stale_links;
+    guint links_flush_id;
 } QuickSettingsHeaderMixer;
 G_DEFINE_TYPE(QuickSettingsHeaderMixer, quick_settings_header_mixer,
               G_TYPE_OBJECT);
 
+static void quick_settings_header_mixer_disconnect(
+    QuickSettingsHeaderMixer *self);
+
 // stub out empty dispose, finalize, class_init, and init methods for this
 // GObject.
 static void quick_settings_header_mixer_dispose(GObject *gobject) {
     QuickSettingsHeaderMixer *self = QUICK_SETTINGS_HEADER_MIXER(gobject);
 
+    quick_settings_header_mixer_disconnect(self);
+    g_clear_pointer(&self->rows, g_hash_table_unref);
+    g_clear_pointer(&self->stale_links, g_hash_table_unref);
+
     // Chain-up
     G_OBJECT_CLASS(quick_settings_header_mixer_parent_class)->dispose(gobject);
 };
@@ -39,127 +52,169 @@ static void quick_settings_header_mixer_class_init(
     object_class->finalize = quick_settings_header_mixer_finalize;
 };
 
-static void on_wire_plumber_service_database_changed(
-    WirePlumberService *wps, GHashTable *db, QuickSettingsHeaderMixer *self) {
-    g_debug(
-        "quick_settings_header_mixer.c:on_wire_plumber_service_database_"
-        "changed() called.");
-
-    GPtrArray *to_remove = g_ptr_array_new();
-
-    // prune all streams from our inventory, we want to refresh these
-    // everytime this event is called.
-    GtkWidget *child =
-        gtk_widget_get_first_child(GTK_WIDGET(self->menu.options));
-    while (child) {
-        QuickSettingsHeaderMixerMenuOption *option =
-            g_object_get_data(G_OBJECT(child), "option");
-        WirePlumberServiceNodeHeader *node =
-            quick_settings_header_mixer_menu_option_get_node(option);
-        if (node->type == WIRE_PLUMBER_SERVICE_TYPE_INPUT_AUDIO_STREAM ||
-            node->type == WIRE_PLUMBER_SERVICE_TYPE_OUTPUT_AUDIO_STREAM) {
-            g_ptr_array_add(to_remove, option);
-        }
-        child = gtk_widget_get_next_sibling(child);
-    }
+static gboolean is_stream(WirePlumberServiceNodeHeader *header) {
+    return header->type == WIRE_PLUMBER_SERVICE_TYPE_INPUT_AUDIO_STREAM ||
+           header->type == WIRE_PLUMBER_SERVICE_TYPE_OUTPUT_AUDIO_STREAM;
+}
 
-    for (guint i = 0; i < to_remove->len; i++) {
-        QuickSettingsHeaderMixerMenuOption *option =
-            g_ptr_array_index(to_remove, i);
-        gtk_box_remove(
-            self->menu.options,
-            quick_settings_header_mixer_menu_option_get_widget(option));
-    }
+static gboolean is_device(WirePlumberServiceNodeHeader *header) {
+    return header->type == WIRE_PLUMBER_SERVICE_TYPE_SINK ||
+           header->type == WIRE_PLUMBER_SERVICE_TYPE_SOURCE;
+}
 
-    // set to_remove size to zero
-    g_ptr_array_set_size(to_remove, 0);
+static gboolean menu_visible(QuickSettingsHeaderMixer *self) {
+    return gtk_widget_get_mapped(GTK_WIDGET(self->menu.container));
+}
 
-    // create streams, we always want to recreate these since link info is
-    // refreshed in this event.
-    GPtrArray *streams = wire_plumber_service_get_streams(wps);
-    for (guint i = 0; i < streams->len; i++) {
-        WirePlumberServiceNodeHeader *header = g_ptr_array_index(streams, i);
+static void add_row(QuickSettingsHeaderMixer *self,
+                    WirePlumberServiceNodeHeader *header) {
+    if (g_hash_table_contains(self->rows, GUINT_TO_POINTER(header->id)))
+        return;
 
-        QuickSettingsHeaderMixerMenuOption *option =
-            g_object_new(QUICK_SETTINGS_HEADER_MIXER_MENU_OPTION_TYPE, NULL);
+    QuickSettingsHeaderMixerMenuOption *option =
+        g_object_new(QUICK_SETTINGS_HEADER_MIXER_MENU_OPTION_TYPE, NULL);
 
-        quick_settings_header_mixer_menu_option_set_node(option, header);
+    quick_settings_header_mixer_menu_option_set_node(option, header);
 
-        // add to menu.options container
+    // streams are listed above devices.
+    if (is_stream(header))
         gtk_box_prepend(
             self->menu.options,
             quick_settings_header_mixer_menu_option_get_widget(option));
-    }
+    else
+        gtk_box_append(
+            self->menu.options,
+            quick_settings_header_mixer_menu_option_get_widget(option));
 
-    // create sinks
-    GPtrArray *sinks = wire_plumber_service_get_sinks(wps);
-    for (guint i = 0; i < sinks->len; i++) {
-        WirePlumberServiceNodeHeader *header = g_ptr_array_index(sinks, i);
+    g_hash_table_insert(self->rows, GUINT_TO_POINTER(header->id), option);
+}
 
-        if (g_hash_table_contains(self->nodes, GUINT_TO_POINTER(header->id))) {
-            continue;
-        }
+// Creates rows for nodes which were added while the menu was hidden.
+static void sync_rows(QuickSettingsHeaderMixer *self) {
+    WirePlumberService *wps = wire_plumber_service_get_global();
+    GPtrArray *lists[] = {
+        wire_plumber_service_get_streams(wps),
+        wire_plumber_service_get_sinks(wps),
+        wire_plumber_service_get_sources(wps),
+    };
 
-        QuickSettingsHeaderMixerMenuOption *option =
-            g_object_new(QUICK_SETTINGS_HEADER_MIXER_MENU_OPTION_TYPE, NULL);
+    for (guint l = 0; l < G_N_ELEMENTS(lists); l++)
+        for (guint i = 0; i < lists[l]->len; i++)
+            add_row(self, g_ptr_array_index(lists[l], i));
 
-        quick_settings_header_mixer_menu_option_set_node(option, header);
+    self->rows_stale = false;
+}
 
-        // add to menu.options container
-        gtk_box_append(
-            self->menu.options,
-            quick_settings_header_mixer_menu_option_get_widget(option));
+static gboolean flush_stale_links(QuickSettingsHeaderMixer *self) {
+    GHashTableIter iter;
+    gpointer id;
 
-        g_hash_table_add(self->nodes, GUINT_TO_POINTER(header->id));
-    }
+    self->links_flush_id = 0;
 
-    // create sources
-    GPtrArray *sources = wire_plumber_service_get_sources(wps);
-    for (guint i = 0; i < sources->len; i++) {
-        WirePlumberServiceNodeHeader *header = g_ptr_array_index(sources, i);
+    g_hash_table_iter_init(&iter, self->stale_links);
+    while (g_hash_table_iter_next(&iter, &id, NULL)) {
+        QuickSettingsHeaderMixerMenuOption *option =
+            g_hash_table_lookup(self->rows, id);
+        if (option)
+            quick_settings_header_mixer_menu_option_update_links(option);
+    }
+    g_hash_table_remove_all(self->stale_links);
 
-        if (g_hash_table_contains(self->nodes, GUINT_TO_POINTER(header->id))) {
-            continue;
-        }
+    return G_SOURCE_REMOVE;
+}
 
-        QuickSettingsHeaderMixerMenuOption *option =
-            g_object_new(QUICK_SETTINGS_HEADER_MIXER_MENU_OPTION_TYPE, NULL);
+// Marks a stream row's link dropdown stale. Link and device removals are
+// signaled before the service drops them from its arrays, so refreshing is
+// deferred to idle and coalesced with any other changes in the same batch.
+static void mark_links_stale(QuickSettingsHeaderMixer *self, guint32 id) {
+    g_hash_table_add(self->stale_links, GUINT_TO_POINTER(id));
+    if (!self->links_flush_id && menu_visible(self))
+        self->links_flush_id =
+            g_idle_add((GSourceFunc)flush_stale_links, self);
+}
 
-        quick_settings_header_mixer_menu_option_set_node(option, header);
+static void mark_all_links_stale(QuickSettingsHeaderMixer *self) {
+    GHashTableIter iter;
+    gpointer id;
+    QuickSettingsHeaderMixerMenuOption *option;
 
-        // add to menu.options container
-        gtk_box_append(
-            self->menu.options,
-            quick_settings_header_mixer_menu_option_get_widget(option));
+    g_hash_table_iter_init(&iter, self->rows);
+    while (g_hash_table_iter_next(&iter, &id, (gpointer *)&option))
+        if (is_stream(quick_settings_header_mixer_menu_option_get_node(option)))
+            mark_links_stale(self, GPOINTER_TO_UINT(id));
+}
 
-        g_hash_table_add(self->nodes, GUINT_TO_POINTER(header->id));
+static void on_wire_plumber_service_node_added(
+    WirePlumberService *wps, WirePlumberServiceNodeHeader *header,
+    QuickSettingsHeaderMixer *self) {
+    g_debug(
+        "quick_settings_header_mixer.c:on_wire_plumber_service_node_added() "
+        "called.");
+
+    if (header->type == WIRE_PLUMBER_SERVICE_TYPE_LINK) {
+        WirePlumberServiceLink *link = (WirePlumberServiceLink *)header;
+        mark_links_stale(self, link->input_node);
+        mark_links_stale(self, link->output_node);
+        return;
     }
 
-    // prune menu's options if they are not present in db
-    child = gtk_widget_get_first_child(GTK_WIDGET(self->menu.options));
-    while (child) {
-        // get options structure pointer from widget
-        QuickSettingsHeaderMixerMenuOption *option =
-            g_object_get_data(G_OBJECT(child), "option");
+    if (!is_stream(header) && !is_device(header)) return;
 
-        WirePlumberServiceNodeHeader *node =
-            quick_settings_header_mixer_menu_option_get_node(option);
+    // a new device is a new choice in every stream's link dropdown.
+    if (is_device(header)) mark_all_links_stale(self);
 
-        if (!g_hash_table_contains(db, GUINT_TO_POINTER(node->id))) {
-            g_ptr_array_add(to_remove, option);
-            g_hash_table_remove(self->nodes, GUINT_TO_POINTER(node->id));
-        }
-        child = gtk_widget_get_next_sibling(child);
+    if (!menu_visible(self)) {
+        self->rows_stale = true;
+        return;
     }
+    add_row(self, header);
+}
 
-    // remove all options in to_remove array
-    for (guint i = 0; i < to_remove->len; i++) {
-        QuickSettingsHeaderMixerMenuOption *option =
-            g_ptr_array_index(to_remove, i);
+static void on_wire_plumber_service_node_removed(
+    WirePlumberService *wps, WirePlumberServiceNodeHeader *header,
+    QuickSettingsHeaderMixer *self) {
+    g_debug(
+        "quick_settings_header_mixer.c:on_wire_plumber_service_node_removed() "
+        "called.");
+
+    if (header->type == WIRE_PLUMBER_SERVICE_TYPE_LINK) {
+        WirePlumberServiceLink *link = (WirePlumberServiceLink *)header;
+        mark_links_stale(self, link->input_node);
+        mark_links_stale(self, link->output_node);
+        return;
+    }
+
+    // rows point at the node, they must go before it's freed, even while
+    // hidden.
+    QuickSettingsHeaderMixerMenuOption *option =
+        g_hash_table_lookup(self->rows, GUINT_TO_POINTER(header->id));
+    if (option) {
         gtk_box_remove(
             self->menu.options,
             quick_settings_header_mixer_menu_option_get_widget(option));
+        g_hash_table_remove(self->rows, GUINT_TO_POINTER(header->id));
+        g_hash_table_remove(self->stale_links, GUINT_TO_POINTER(header->id));
     }
+
+    if (is_device(header)) mark_all_links_stale(self);
+}
+
+static void on_menu_map(GtkWidget *widget, QuickSettingsHeaderMixer *self) {
+    g_debug("quick_settings_header_mixer.c:on_menu_map() called.");
+
+    if (self->rows_stale) sync_rows(self);
+    if (g_hash_table_size(self->stale_links) > 0 && !self->links_flush_id)
+        flush_stale_links(self);
+}
+
+static void quick_settings_header_mixer_disconnect(
+    QuickSettingsHeaderMixer *self) {
+    WirePlumberService *wps = wire_plumber_service_get_global();
+    g_signal_handlers_disconnect_by_func(
+        wps, G_CALLBACK(on_wire_plumber_service_node_added), self);
+    g_signal_handlers_disconnect_by_func(
+        wps, G_CALLBACK(on_wire_plumber_service_node_removed), self);
+    g_clear_handle_id(&self->links_flush_id, g_source_remove);
 }
 
 static void quick_settings_header_mixer_init_layout(
@@ -184,28 +239,31 @@ static void quick_settings_header_mixer_init_layout(
 
     WirePlumberService *wps = wire_plumber_service_get_global();
 
-    on_wire_plumber_service_database_changed(
-        wps, wire_plumber_service_get_db(wps), self);
+    // rows are created lazily the first time the menu is shown.
+    self->rows_stale = true;
 
-    // connect to "database-changed"
-    g_signal_connect(wps, "database-changed",
-                     G_CALLBACK(on_wire_plumber_service_database_changed),
+    g_signal_connect(wps, "node-added",
+                     G_CALLBACK(on_wire_plumber_service_node_added), self);
+    g_signal_connect(wps, "node-removed",
+                     G_CALLBACK(on_wire_plumber_service_node_removed), self);
+
+    g_signal_connect(self->menu.container, "map", G_CALLBACK(on_menu_map),
                      self);
 };
 
 static void quick_settings_header_mixer_init(QuickSettingsHeaderMixer *self) {
+    self->rows = g_hash_table_new(g_direct_hash, g_direct_equal);
+    self->stale_links = g_hash_table_new(g_direct_hash, g_direct_equal);
     quick_settings_header_mixer_init_layout(self);
-    self->nodes = g_hash_table_new(g_direct_hash, g_direct_equal);
 };
 
 void quick_settings_header_mixer_reinitialize(QuickSettingsHeaderMixer *self) {
     // kill signals
-    WirePlumberService *wps = wire_plumber_service_get_global();
-    g_signal_handlers_disconnect_by_func(
-        wps, G_CALLBACK(on_wire_plumber_service_database_changed), self);
+    quick_settings_header_mixer_disconnect(self);
 
-    // empty node's hash table
-    g_hash_table_remove_all(self->nodes);
+    // the old rows go with the old layout.
+    g_hash_table_remove_all(self->rows);
+    g_hash_table_remove_all(self->stale_links);
 
     // reinit layout
     quick_settings_header_mixer_init_layout(self);
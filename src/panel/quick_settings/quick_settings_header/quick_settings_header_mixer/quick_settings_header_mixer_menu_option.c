@@ -9,22 +9,32 @@
 #include "gtk/gtkdropdown.h"
 #include "gtk/gtkrevealer.h"
 
+// returns a new reference to the first app whose id contains app_id, or NULL.
 static GAppInfo *search_apps_by_app_id(const gchar *app_id) {
     GAppInfo *app_info = NULL;
-    GList *apps = g_app_info_get_all();
+    GList *apps;
     GList *l;
+
+    if (!app_id) return NULL;
+
     g_debug("app_switcher_app_widget: search_apps_by_app_id: %s", app_id);
+
+    apps = g_app_info_get_all();
+    gchar *lower_app_id = g_utf8_strdown(app_id, -1);
     for (l = apps; l != NULL; l = l->next) {
         GAppInfo *info = l->data;
         const gchar *id = g_app_info_get_id(info);
-        const gchar *lower_id = g_utf8_strdown(id, -1);
-        const gchar *lower_app_id = g_utf8_strdown(app_id, -1);
-        if (g_strrstr(lower_id, lower_app_id)) {
-            app_info = info;
+        if (!id) continue;
+        gchar *lower_id = g_utf8_strdown(id, -1);
+        gboolean match = g_strrstr(lower_id, lower_app_id) != NULL;
+        g_free(lower_id);
+        if (match) {
+            app_info = g_object_ref(info);
             break;
         }
     }
-    g_list_free(apps);
+    g_free(lower_app_id);
+    g_list_free_full(apps, g_object_unref);
     return app_info;
 }
 
@@ -44,6 +54,12 @@ typedef struct _QuickSettingsHeaderMixerMenuOption {
     GtkRevealer *revealer;
     GtkBox *revealer_content;
     GtkDropDown *streams_dropdown;
+    // app_name the stream icon was last looked up for, the lookup walks
+    // every installed app so it's only redone when the name changes.
+    gchar *icon_app_name;
+    gboolean icon_looked_up;
+    // node changed while the row was hidden, re-rendered on map.
+    gboolean stale;
 } QuickSettingsHeaderMixerMenuOption;
 G_DEFINE_TYPE(QuickSettingsHeaderMixerMenuOption,
               quick_settings_header_mixer_menu_option, G_TYPE_OBJECT);
@@ -73,6 +89,11 @@ static void quick_settings_header_mixer_menu_option_dispose(GObject *gobject) {
 };
 
 static void quick_settings_header_mixer_menu_option_finalize(GObject *gobject) {
+    QuickSettingsHeaderMixerMenuOption *self =
+        QUICK_SETTINGS_HEADER_MIXER_MENU_OPTION(gobject);
+
+    g_free(self->icon_app_name);
+
     // Chain-up
     G_OBJECT_CLASS(quick_settings_header_mixer_menu_option_parent_class)
         ->finalize(gobject);
@@ -206,6 +227,13 @@ static void on_widget_destroy(GtkWidget *widget,
     g_object_unref(self);
 }
 
+static void render(QuickSettingsHeaderMixerMenuOption *self);
+
+static void on_container_map(GtkWidget *widget,
+                             QuickSettingsHeaderMixerMenuOption *self) {
+    if (self->stale) render(self);
+}
+
 static void quick_settings_header_mixer_menu_option_init(
     QuickSettingsHeaderMixerMenuOption *self) {
     quick_settings_header_mixer_menu_option_init_layout(self);
@@ -216,6 +244,9 @@ static void quick_settings_header_mixer_menu_option_init(
     // tie our lifespan to the lifespan of our container
     g_signal_connect(self->container, "destroy", G_CALLBACK(on_widget_destroy),
                      self);
+
+    g_signal_connect(self->container, "map", G_CALLBACK(on_container_map),
+                     self);
 };
 
 static void set_sink(QuickSettingsHeaderMixerMenuOption *self,
@@ -241,9 +272,10 @@ static void set_sink(QuickSettingsHeaderMixerMenuOption *self,
     }
 
     if (is_default) {
-        const gchar *name_label_text = gtk_label_get_text(self->node_name);
-        gtk_label_set_text(self->node_name,
-                           g_strdup_printf("*%s", name_label_text));
+        gchar *name =
+            g_strdup_printf("*%s", gtk_label_get_text(self->node_name));
+        gtk_label_set_text(self->node_name, name);
+        g_free(name);
     }
 
     // set tooltip to node_name
@@ -287,9 +319,10 @@ static void set_source(QuickSettingsHeaderMixerMenuOption *self,
     }
 
     if (is_default) {
-        const gchar *name_label_text = gtk_label_get_text(self->node_name);
-        gtk_label_set_text(self->node_name,
-                           g_strdup_printf("*%s", name_label_text));
+        gchar *name =
+            g_strdup_printf("*%s", gtk_label_get_text(self->node_name));
+        gtk_label_set_text(self->node_name, name);
+        g_free(name);
     }
 
     // set tooltip to node_name
@@ -355,8 +388,16 @@ GtkButton *link_button_new(WirePlumberServiceNodeHeader *header) {
     return link_button;
 }
 
-static void set_stream_common(QuickSettingsHeaderMixerMenuOption *self,
-                              WirePlumberServiceAudioStream *node) {
+static void set_stream_icon(QuickSettingsHeaderMixerMenuOption *self,
+                            WirePlumberServiceAudioStream *node) {
+    if (self->icon_looked_up &&
+        g_strcmp0(self->icon_app_name, node->app_name) == 0)
+        return;
+
+    g_free(self->icon_app_name);
+    self->icon_app_name = g_strdup(node->app_name);
+    self->icon_looked_up = true;
+
     // prefer icons from app info
     GAppInfo *app_info = search_apps_by_app_id(node->app_name);
     if (app_info) {
@@ -372,33 +413,35 @@ static void set_stream_common(QuickSettingsHeaderMixerMenuOption *self,
             GtkIconPaintable *paintable = gtk_icon_theme_lookup_by_gicon(
                 theme, icon, 64, 1, GTK_TEXT_DIR_RTL, 0);
             gtk_image_set_from_paintable(self->icon, GDK_PAINTABLE(paintable));
+            g_object_unref(paintable);
         }
         // check and handle if GLoadableIcon
         else if (G_IS_LOADABLE_ICON(icon)) {
             g_debug("G_LOADABLE_ICON");
         }
+        g_object_unref(app_info);
     } else
         gtk_image_set_from_icon_name(self->icon,
                                      "applications-multimedia-symbolic");
+}
+
+static void set_stream(QuickSettingsHeaderMixerMenuOption *self,
+                       WirePlumberServiceAudioStream *node) {
+    g_debug("quick_settings_header_mixer_menu_option.c:set_stream() called.");
+
+    set_stream_icon(self, node);
 
     // set name and tooltip based on stream direction
-    if (node->type == WIRE_PLUMBER_SERVICE_TYPE_INPUT_AUDIO_STREAM) {
-        gtk_label_set_text(
-            self->node_name,
-            g_strdup_printf("%s (%s)", node->media_name, "Input"));
-        gtk_widget_set_tooltip_text(
-            GTK_WIDGET(self->button),
-            g_strdup_printf("%s: %s (%s)", node->app_name, node->media_name,
-                            "Input"));
-    } else {
-        gtk_label_set_text(
-            self->node_name,
-            g_strdup_printf("%s (%s)", node->media_name, "Output"));
-        gtk_widget_set_tooltip_text(
-            GTK_WIDGET(self->button),
-            g_strdup_printf("%s: %s (%s)", node->app_name, node->media_name,
-                            "Output"));
-    }
+    const gchar *direction =
+        node->type == WIRE_PLUMBER_SERVICE_TYPE_INPUT_AUDIO_STREAM ? "Input"
+                                                                   : "Output";
+    gchar *name = g_strdup_printf("%s (%s)", node->media_name, direction);
+    gchar *tooltip = g_strdup_printf("%s: %s (%s)", node->app_name,
+                                     node->media_name, direction);
+    gtk_label_set_text(self->node_name, name);
+    gtk_widget_set_tooltip_text(GTK_WIDGET(self->button), tooltip);
+    g_free(name);
+    g_free(tooltip);
 
     if (node->state == WP_NODE_STATE_RUNNING) {
         gtk_widget_add_css_class(GTK_WIDGET(self->active_icon),
@@ -416,11 +459,12 @@ static void on_input_stream_dropdown_activate(
         "quick_settings_header_mixer_menu_option.c:on_input_stream_dropdown_"
         "activate() called.");
 
-    gint32 index = gtk_drop_down_get_selected(dropdown);
+    guint index = gtk_drop_down_get_selected(dropdown);
 
     // get list of all sources
     GPtrArray *sources =
         wire_plumber_service_get_sources(wire_plumber_service_get_global());
+    if (index >= sources->len) return;
 
     // get the source at the index of the dropdown
     WirePlumberServiceNode *source = g_ptr_array_index(sources, index);
@@ -435,74 +479,6 @@ static void on_input_stream_dropdown_activate(
                                   (WirePlumberServiceNodeHeader *)stream);
 }
 
-static void set_input_stream(QuickSettingsHeaderMixerMenuOption *self,
-                             WirePlumberServiceAudioStream *node) {
-    g_debug(
-        "quick_settings_header_mixer_menu_option.c:set_output_stream() "
-        "called.");
-
-    guint32 linked_output = 0;
-    gint32 linked_output_index = -1;
-
-    // unparent revealer's content making this function idempotent.
-    if (gtk_widget_get_first_child(GTK_WIDGET(self->revealer_content)))
-        gtk_widget_unparent(
-            gtk_widget_get_first_child(GTK_WIDGET(self->revealer_content)));
-
-    // find links which reference this node
-    GPtrArray *links =
-        wire_plumber_service_get_links(wire_plumber_service_get_global());
-    for (int i = 0; i < links->len; i++) {
-        WirePlumberServiceLink *link = g_ptr_array_index(links, i);
-        if (link->input_node == node->id) {
-            linked_output = link->output_node;
-        }
-    }
-
-    // get list of all sources
-    GPtrArray *sources =
-        wire_plumber_service_get_sources(wire_plumber_service_get_global());
-    const char *source_names[sources->len + 1];  // +1 for null terminator.
-    source_names[sources->len] = NULL;
-
-    // iterate sources and add their names to list fed into drop down.
-    for (int i = 0; i < sources->len; i++) {
-        WirePlumberServiceNode *sink = g_ptr_array_index(sources, i);
-        if (sink->nick_name)
-            source_names[i] = sink->nick_name;
-        else
-            source_names[i] = sink->name;
-        if (sink->id == linked_output) linked_output_index = i;
-    }
-
-    GtkBox *dropdown_contents =
-        GTK_BOX(gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0));
-    gtk_widget_add_css_class(GTK_WIDGET(dropdown_contents), "mixer-link");
-
-    // append icon
-    GtkImage *link_icon = GTK_IMAGE(
-        gtk_image_new_from_icon_name("network-wireless-hotspot-symbolic"));
-    gtk_box_append(dropdown_contents, GTK_WIDGET(link_icon));
-
-    // create dropdown button
-    self->streams_dropdown =
-        GTK_DROP_DOWN(gtk_drop_down_new_from_strings(source_names));
-    if (linked_output_index != -1)
-        gtk_drop_down_set_selected(self->streams_dropdown, linked_output_index);
-
-    // wire up drop down's activate
-    g_signal_connect(self->streams_dropdown, "notify::selected",
-                     G_CALLBACK(on_input_stream_dropdown_activate), self);
-
-    // append dropdown to revealer content
-    gtk_box_append(dropdown_contents, GTK_WIDGET(self->streams_dropdown));
-
-    // add dropdow to revealer's content
-    gtk_box_append(self->revealer_content, GTK_WIDGET(dropdown_contents));
-
-    set_stream_common(self, node);
-}
-
 static void on_output_stream_dropdown_activate(
     GtkDropDown *dropdown, GParamSpec *pspec,
     QuickSettingsHeaderMixerMenuOption *self) {
@@ -511,11 +487,12 @@ static void on_output_stream_dropdown_activate(
         "dropdown_"
         "activate() called.");
 
-    gint32 index = gtk_drop_down_get_selected(dropdown);
+    guint index = gtk_drop_down_get_selected(dropdown);
 
     // get list of all sinks
     GPtrArray *sinks =
         wire_plumber_service_get_sinks(wire_plumber_service_get_global());
+    if (index >= sinks->len) return;
 
     // get the sink at the index of the dropdown
     WirePlumberServiceNode *sink = g_ptr_array_index(sinks, index);
@@ -530,43 +507,10 @@ static void on_output_stream_dropdown_activate(
                                   (WirePlumberServiceNodeHeader *)sink);
 }
 
-static void set_output_stream(QuickSettingsHeaderMixerMenuOption *self,
-                              WirePlumberServiceAudioStream *node) {
-    g_debug(
-        "quick_settings_header_mixer_menu_option.c:set_output_stream() "
-        "called.");
-
-    guint32 linked_input = 0;
-    gint32 linked_input_index = -1;
-
-    if (gtk_widget_get_first_child(GTK_WIDGET(self->revealer_content)))
-        gtk_widget_unparent(
-            gtk_widget_get_first_child(GTK_WIDGET(self->revealer_content)));
-
-    // find links which reference this node
-    GPtrArray *links =
-        wire_plumber_service_get_links(wire_plumber_service_get_global());
-    for (int i = 0; i < links->len; i++) {
-        WirePlumberServiceLink *link = g_ptr_array_index(links, i);
-        if (link->output_node == node->id) {
-            linked_input = link->input_node;
-        }
-    }
-
-    // get list of all sinks that we may link to this output.
-    GPtrArray *sinks =
-        wire_plumber_service_get_sinks(wire_plumber_service_get_global());
-    const char *sink_names[sinks->len + 1];  // +1 for null terminator.
-    sink_names[sinks->len] = NULL;
-
-    for (int i = 0; i < sinks->len; i++) {
-        WirePlumberServiceNode *sink = g_ptr_array_index(sinks, i);
-        if (sink->nick_name)
-            sink_names[i] = sink->nick_name;
-        else
-            sink_names[i] = sink->name;
-        if (sink->id == linked_input) linked_input_index = i;
-    }
+// creates the link dropdown once, later updates only swap its model.
+static void ensure_link_dropdown(QuickSettingsHeaderMixerMenuOption *self,
+                                 GCallback on_selected) {
+    if (self->streams_dropdown) return;
 
     GtkBox *dropdown_contents =
         GTK_BOX(gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0));
@@ -578,22 +522,81 @@ static void set_output_stream(QuickSettingsHeaderMixerMenuOption *self,
     gtk_box_append(dropdown_contents, GTK_WIDGET(link_icon));
 
     // create dropdown button
-    self->streams_dropdown =
-        GTK_DROP_DOWN(gtk_drop_down_new_from_strings(sink_names));
-    if (linked_input_index != -1)
-        gtk_drop_down_set_selected(self->streams_dropdown, linked_input_index);
+    self->streams_dropdown = GTK_DROP_DOWN(gtk_drop_down_new(NULL, NULL));
 
     // wire into dropdown activate
-    g_signal_connect(self->streams_dropdown, "notify::selected",
-                     G_CALLBACK(on_output_stream_dropdown_activate), self);
+    g_signal_connect(self->streams_dropdown, "notify::selected", on_selected,
+                     self);
 
     // append dropdown to revealer content
     gtk_box_append(dropdown_contents, GTK_WIDGET(self->streams_dropdown));
 
     // add dropdow to revealer's content
     gtk_box_append(self->revealer_content, GTK_WIDGET(dropdown_contents));
+}
+
+void quick_settings_header_mixer_menu_option_update_links(
+    QuickSettingsHeaderMixerMenuOption *self) {
+    g_debug(
+        "quick_settings_header_mixer_menu_option.c:"
+        "quick_settings_header_mixer_menu_option_update_links() called.");
 
-    set_stream_common(self, node);
+    WirePlumberService *wps = wire_plumber_service_get_global();
+    gboolean input = false;
+    GPtrArray *targets = NULL;
+    GCallback on_selected = NULL;
+    guint32 linked = 0;
+    guint linked_index = GTK_INVALID_LIST_POSITION;
+
+    switch (self->node->type) {
+        case WIRE_PLUMBER_SERVICE_TYPE_INPUT_AUDIO_STREAM:
+            // input streams are fed by sources.
+            input = true;
+            targets = wire_plumber_service_get_sources(wps);
+            on_selected = G_CALLBACK(on_input_stream_dropdown_activate);
+            break;
+        case WIRE_PLUMBER_SERVICE_TYPE_OUTPUT_AUDIO_STREAM:
+            // output streams feed sinks.
+            targets = wire_plumber_service_get_sinks(wps);
+            on_selected = G_CALLBACK(on_output_stream_dropdown_activate);
+            break;
+        default:
+            return;
+    }
+
+    // find links which reference this node
+    GPtrArray *links = wire_plumber_service_get_links(wps);
+    for (guint i = 0; i < links->len; i++) {
+        WirePlumberServiceLink *link = g_ptr_array_index(links, i);
+        if (input && link->input_node == self->node->id)
+            linked = link->output_node;
+        if (!input && link->output_node == self->node->id)
+            linked = link->input_node;
+    }
+
+    // names of every node we may link to, in array order so the selected
+    // index maps straight back to a node.
+    const char *names[targets->len + 1];  // +1 for null terminator.
+    names[targets->len] = NULL;
+    for (guint i = 0; i < targets->len; i++) {
+        WirePlumberServiceNode *target = g_ptr_array_index(targets, i);
+        if (target->nick_name)
+            names[i] = target->nick_name;
+        else
+            names[i] = target->name;
+        if (target->id == linked) linked_index = i;
+    }
+
+    ensure_link_dropdown(self, on_selected);
+
+    // swapping the model resets the selection, which isn't a user choice.
+    GtkStringList *model = gtk_string_list_new(names);
+    g_signal_handlers_block_by_func(self->streams_dropdown, on_selected, self);
+    gtk_drop_down_set_model(self->streams_dropdown, G_LIST_MODEL(model));
+    gtk_drop_down_set_selected(self->streams_dropdown, linked_index);
+    g_signal_handlers_unblock_by_func(self->streams_dropdown, on_selected,
+                                      self);
+    g_object_unref(model);
 }
 
 static void block_volume_scale_changed_signals(
@@ -619,6 +622,20 @@ static void on_wire_plumber_service_node_changed(
 
     self->node = header;
 
+    // hidden rows are patched once, when they're next shown.
+    if (!gtk_widget_get_mapped(GTK_WIDGET(self->container))) {
+        self->stale = true;
+        return;
+    }
+
+    render(self);
+}
+
+static void render(QuickSettingsHeaderMixerMenuOption *self) {
+    WirePlumberServiceNodeHeader *header = self->node;
+
+    self->stale = false;
+
     // we will potentially update our scale positions do block the
     // on_scale_value_changed function to not loop
     block_volume_scale_changed_signals(self, true);
@@ -631,10 +648,8 @@ static void on_wire_plumber_service_node_changed(
             set_source(self, (WirePlumberServiceNode *)header);
             break;
         case WIRE_PLUMBER_SERVICE_TYPE_INPUT_AUDIO_STREAM:
-            set_input_stream(self, (WirePlumberServiceAudioStream *)header);
-            break;
         case WIRE_PLUMBER_SERVICE_TYPE_OUTPUT_AUDIO_STREAM:
-            set_output_stream(self, (WirePlumberServiceAudioStream *)header);
+            set_stream(self, (WirePlumberServiceAudioStream *)header);
             break;
         default:
             break;
@@ -655,7 +670,8 @@ void quick_settings_header_mixer_menu_option_set_node(
 
     WirePlumberService *wps = wire_plumber_service_get_global();
 
-    on_wire_plumber_service_node_changed(wps, header, self);
+    render(self);
+    quick_settings_header_mixer_menu_option_update_links(self);
 
     g_signal_connect(wps, "node-changed",
                      G_CALLBACK(on_wire_plumber_service_node_changed), self);
@@ -22,3 +22,8 @@ void quick_settings_header_mixer_menu_option_set_node(
 
 WirePlumberServiceNodeHeader *quick_settings_header_mixer_menu_option_get_node(
     QuickSettingsHeaderMixerMenuOption *self);
+
+// Refreshes the link dropdown of a stream row from the current sinks,
+// sources and links. The dropdown is kept, only its model is replaced.
+void quick_settings_header_mixer_menu_option_update_links(
+    QuickSettingsHeaderMixerMenuOption *self);
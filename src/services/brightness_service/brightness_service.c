@@ -1,9 +1,9 @@
-
 #include "brightness_service.h"
 
 #include <adwaita.h>
 #include <fcntl.h>
-#include <sys/inotify.h>
+#include <gudev/gudev.h>
+#include <unistd.h>
 
 #include "../logind_service/logind_service.h"
 #include "gio/gio.h"
@@ -12,24 +12,49 @@
 
 static BrightnessService *global = NULL;
 
-enum signals { brightness_changed, keyboard_brightness_changed, signals_n };
+enum signals {
+    brightness_changed,
+    keyboard_brightness_changed,
+    device_brightness_changed,
+    signals_n
+};
+
+// A backlight or led class device, its brightness attribute is kept open and
+// re-read with pread(2) when udev reports a change.
+typedef struct _BrightnessDevice {
+    // "backlight" or "leds", with name this is what logind's SetBrightness
+    // expects.
+    gchar *subsystem;
+    gchar *name;
+    // open fd of actual_brightness when the device has one, brightness
+    // otherwise.
+    int fd;
+    guint32 brightness;
+    guint32 max_brightness;
+    // lower is preferred when picking the display backlight, follows the
+    // firmware > platform > raw order the kernel documents.
+    gint rank;
+    // a change event arrived and the fd has not been re-read yet.
+    gboolean dirty;
+    // a SetBrightness call for `sent` is in flight. `target` is the latest
+    // requested value, it's sent once the in flight call completes if it
+    // differs.
+    gboolean writing;
+    guint32 sent;
+    guint32 target;
+} BrightnessDevice;
 
 struct _BrightnessService {
-    // display brightness
     GObject parent_instance;
-    guint32 backlight_brightness;
-    guint32 max_backlight_brightness;
-    GFile *backlight_device_path;
     GSettings *systems_settings;
-    gboolean has_backlight_brightness;
-    GFileMonitor *backlight_file_monitor;
-
-    // keyboard brightness
-    guint32 keyboard_brightness;
-    guint32 keyboard_max_brightness;
-    GFile *keyboard_device_path;
-    gboolean has_keyboard_brightness;
-    GFileMonitor *keyboard_file_monitor;
+    GUdevClient *udev;
+    // "subsystem/name" -> BrightnessDevice for every backlight and led.
+    GHashTable *devices;
+    // the display backlight and keyboard backlight the rest of the shell
+    // controls, NULL when the machine has none.
+    BrightnessDevice *backlight;
+    BrightnessDevice *keyboard;
+    guint flush_id;
 };
 static guint signals[signals_n] = {0};
 G_DEFINE_TYPE(BrightnessService, brightness_service, G_TYPE_OBJECT);
@@ -39,319 +64,308 @@ static float compute_brightness_percent(guint32 brightness,
     return (float)brightness / (float)max_brightness;
 }
 
-static void brightness_service_dispose(GObject *object) {
-    G_OBJECT_CLASS(brightness_service_parent_class)->dispose(object);
-}
-static void brightness_service_finalize(GObject *object) {
-    BrightnessService *self = BRIGHTNESS_SERVICE(object);
-    g_clear_object(&self->backlight_device_path);
-    G_OBJECT_CLASS(brightness_service_parent_class)->finalize(object);
+static void brightness_device_free(BrightnessDevice *dev) {
+    if (dev->fd >= 0) close(dev->fd);
+    g_free(dev->subsystem);
+    g_free(dev->name);
+    g_free(dev);
 }
-static void brightness_service_class_init(BrightnessServiceClass *klass) {
-    GObjectClass *object_class = G_OBJECT_CLASS(klass);
-    object_class->dispose = brightness_service_dispose;
-    object_class->finalize = brightness_service_finalize;
 
-    signals[brightness_changed] = g_signal_new(
-        "brightness-changed", G_TYPE_FROM_CLASS(klass), G_SIGNAL_RUN_LAST, 0,
-        NULL, NULL, NULL, G_TYPE_NONE, 1, G_TYPE_FLOAT);
-
-    signals[keyboard_brightness_changed] = g_signal_new(
-        "keyboard-brightness-changed", G_TYPE_FROM_CLASS(klass),
-        G_SIGNAL_RUN_LAST, 0, NULL, NULL, NULL, G_TYPE_NONE, 1, G_TYPE_UINT);
+static gchar *brightness_device_key(const gchar *subsystem, const gchar *name) {
+    return g_strdup_printf("%s/%s", subsystem, name);
 }
 
-static void get_current_backlight_brightness(BrightnessService *self) {
-    gchar *brightness_str = NULL;
-
-    GFile *brightness_file =
-        g_file_get_child(self->backlight_device_path, "brightness");
+// Reads the device's current brightness into `brightness` through a fixed
+// buffer, returns FALSE if it can't be read.
+static gboolean brightness_device_read_value(BrightnessDevice *dev,
+                                             guint32 *brightness) {
+    char buf[16];
 
-    if (!g_file_load_contents(brightness_file, NULL, &brightness_str, NULL,
-                              NULL, NULL)) {
+    ssize_t n = pread(dev->fd, buf, sizeof(buf) - 1, 0);
+    if (n <= 0) {
         g_debug(
-            "brightness_service.c:on_fd_write(): failed to read brightness "
-            "file");
+            "brightness_service.c:brightness_device_read_value(): failed to "
+            "read %s/%s",
+            dev->subsystem, dev->name);
+        return false;
     }
+    buf[n] = '\0';
 
-    self->backlight_brightness = g_ascii_strtoull(brightness_str, NULL, 10);
-
-    g_debug("brightness_service.c:on_fd_write(): brightness: %u",
-            self->backlight_brightness);
+    *brightness = g_ascii_strtoull(buf, NULL, 10);
+    return true;
 }
 
-static void get_current_keyboard_brightness(BrightnessService *self) {
-    gchar *brightness_str = NULL;
+// Re-reads the device's brightness, returns TRUE if it changed.
+static gboolean brightness_device_read(BrightnessDevice *dev) {
+    guint32 brightness;
 
-    GFile *brightness_file =
-        g_file_get_child(self->keyboard_device_path, "brightness");
+    if (!brightness_device_read_value(dev, &brightness)) return false;
+    if (brightness == dev->brightness) return false;
 
-    if (!g_file_load_contents(brightness_file, NULL, &brightness_str, NULL,
-                              NULL, NULL)) {
-        g_debug(
-            "brightness_service.c:on_fd_write(): failed to read brightness "
-            "file");
-    }
-
-    self->keyboard_brightness = g_ascii_strtoull(brightness_str, NULL, 10);
-
-    g_debug("brightness_service.c:on_fd_write(): brightness: %u",
-            self->keyboard_brightness);
+    dev->brightness = brightness;
+    g_debug("brightness_service.c:brightness_device_read(): %s/%s: %u",
+            dev->subsystem, dev->name, dev->brightness);
+    return true;
 }
 
-void backlight_file_changed(GFileMonitor *file_mon, GFile *file,
-                            GFile *other_file, GFileMonitorEvent event_type,
-                            BrightnessService *self) {
-    get_current_backlight_brightness(self);
-    g_signal_emit(self, signals[brightness_changed], 0,
-                  compute_brightness_percent(self->backlight_brightness,
-                                             self->max_backlight_brightness));
-}
-
-static void on_backlight_directory_changed(GSettings *settings, gchar *key,
-                                           gpointer user_data) {
-    g_debug("brightness_service.c:on_backlight_directory_changed(): called");
-
-    BrightnessService *self = user_data;
-    g_clear_object(&self->backlight_device_path);
-
-    if (self->backlight_file_monitor) {
-        g_file_monitor_cancel(self->backlight_file_monitor);
-        g_clear_object(&self->backlight_file_monitor);
-    }
-
-    // check for empty string.
-    if (strlen(g_settings_get_string(settings, key)) == 0) {
-        self->has_backlight_brightness = false;
-        return;
+static BrightnessDevice *brightness_device_new(GUdevDevice *udev_dev) {
+    const gchar *sysfs = g_udev_device_get_sysfs_path(udev_dev);
+    guint32 max = g_udev_device_get_sysfs_attr_as_uint64(udev_dev,
+                                                          "max_brightness");
+    if (!sysfs || max == 0) return NULL;
+
+    // actual_brightness is what the hardware reports, some panels only
+    // update it and not brightness.
+    gchar *path = g_build_filename(sysfs, "actual_brightness", NULL);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    g_free(path);
+    if (fd < 0) {
+        path = g_build_filename(sysfs, "brightness", NULL);
+        fd = open(path, O_RDONLY | O_CLOEXEC);
+        g_free(path);
     }
-
-    // join the path /sys/class/backlight/ with the settings value and make
-    // it a GFile*
-    self->backlight_device_path = g_file_new_for_path(g_build_filename(
-        "/sys/class/backlight", g_settings_get_string(settings, key), NULL));
-
-    // debug device path
-    g_debug(
-        "brightness_service.c:on_backlight_directory_changed(): device path: "
-        "%s",
-        g_file_get_path(self->backlight_device_path));
-
-    // ensure device path exists
-    if (!g_file_query_exists(self->backlight_device_path, NULL)) {
+    if (fd < 0) {
         g_warning(
-            "brightness_service.c:on_backlight_directory_changed(): backlight "
-            "directory does not exist");
-        g_clear_object(&self->backlight_device_path);
-        self->has_backlight_brightness = false;
-        return;
+            "brightness_service.c:brightness_device_new(): failed to open "
+            "brightness of %s",
+            sysfs);
+        return NULL;
     }
-    self->has_backlight_brightness = true;
 
-    GFile *brightness_file =
-        g_file_get_child(self->backlight_device_path, "brightness");
-    g_debug(
-        "brightness_service.c:on_backlight_directory_changed(): brightness "
-        "file: "
-        "%s",
-        g_file_get_path(brightness_file));
+    BrightnessDevice *dev = g_new0(BrightnessDevice, 1);
+    dev->subsystem = g_strdup(g_udev_device_get_subsystem(udev_dev));
+    dev->name = g_strdup(g_udev_device_get_name(udev_dev));
+    dev->fd = fd;
+    dev->max_brightness = max;
+
+    const gchar *type = g_udev_device_get_sysfs_attr(udev_dev, "type");
+    if (g_strcmp0(type, "firmware") == 0)
+        dev->rank = 0;
+    else if (g_strcmp0(type, "platform") == 0)
+        dev->rank = 1;
+    else
+        dev->rank = 2;
+
+    brightness_device_read(dev);
+    return dev;
+}
 
-    GFile *max_brightness_file =
-        g_file_get_child(self->backlight_device_path, "max_brightness");
-    g_debug(
-        "brightness_service.c:on_backlight_directory_changed(): max_brightness "
-        "file: %s",
-        g_file_get_path(max_brightness_file));
+static void brightness_service_emit(BrightnessService *self,
+                                    BrightnessDevice *dev) {
+    if (g_strcmp0(dev->subsystem, "backlight") == 0)
+        g_signal_emit(
+            self, signals[device_brightness_changed], 0, dev->name,
+            compute_brightness_percent(dev->brightness, dev->max_brightness));
+
+    if (dev == self->backlight)
+        g_signal_emit(
+            self, signals[brightness_changed], 0,
+            compute_brightness_percent(dev->brightness, dev->max_brightness));
+
+    if (dev == self->keyboard)
+        g_signal_emit(self, signals[keyboard_brightness_changed], 0,
+                      dev->brightness);
+}
 
-    // ensure brightness_file exists
-    if (!g_file_query_exists(brightness_file, NULL)) {
-        g_warning(
-            "brightness_service.c:on_backlight_directory_changed(): brightness "
-            "file does not exist");
-        goto error;
+// Picks the display and keyboard backlights. A device named in settings wins,
+// otherwise the best ranked backlight and the first keyboard led are used.
+static void brightness_service_pick_devices(BrightnessService *self) {
+    GHashTableIter iter;
+    BrightnessDevice *dev;
+    BrightnessDevice *backlight = NULL;
+    BrightnessDevice *keyboard = NULL;
+    gboolean backlight_configured = false;
+    gboolean keyboard_configured = false;
+
+    gchar *backlight_name =
+        g_settings_get_string(self->systems_settings, "backlight-directory");
+    gchar *keyboard_name = g_settings_get_string(
+        self->systems_settings, "keyboard-backlight-directory");
+
+    g_hash_table_iter_init(&iter, self->devices);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&dev)) {
+        if (g_strcmp0(dev->subsystem, "backlight") == 0) {
+            if (g_strcmp0(dev->name, backlight_name) == 0) {
+                backlight = dev;
+                backlight_configured = true;
+            } else if (!backlight_configured &&
+                       (!backlight || dev->rank < backlight->rank)) {
+                backlight = dev;
+            }
+        } else {
+            if (g_strcmp0(dev->name, keyboard_name) == 0) {
+                keyboard = dev;
+                keyboard_configured = true;
+            } else if (!keyboard_configured && !keyboard &&
+                       g_strstr_len(dev->name, -1, "kbd_backlight")) {
+                keyboard = dev;
+            }
+        }
     }
+    g_free(backlight_name);
+    g_free(keyboard_name);
 
-    // read max_brightness_file into variable
-    GError *error = NULL;
-    gchar *max_brightness_str = NULL;
-    if (!g_file_load_contents(max_brightness_file, NULL, &max_brightness_str,
-                              NULL, NULL, &error)) {
-        g_warning(
-            "brightness_service.c:on_backlight_directory_changed(): failed to "
-            "read max_brightness file: %s",
-            error->message);
-        g_error_free(error);
-        goto error;
+    if (backlight != self->backlight) {
+        self->backlight = backlight;
+        g_debug(
+            "brightness_service.c:brightness_service_pick_devices(): "
+            "backlight: %s",
+            backlight ? backlight->name : "none");
+        if (backlight) brightness_service_emit(self, backlight);
     }
-    self->max_backlight_brightness =
-        g_ascii_strtoull(max_brightness_str, NULL, 10);
-
-    get_current_backlight_brightness(self);
-
-    // emit initial brightness event
-    g_signal_emit(self, signals[brightness_changed], 0,
-                  compute_brightness_percent(self->backlight_brightness,
-                                             self->max_backlight_brightness));
-
-    // setup file monitor
-    error = NULL;
-    self->backlight_file_monitor =
-        g_file_monitor_file(self->backlight_device_path,
-                            G_FILE_MONITOR_WATCH_HARD_LINKS, NULL, &error);
-    if (error) {
-        g_warning(
-            "brightness_service.c:on_backlight_directory_changed(): failed to "
-            "setup file monitor: %s",
-            error->message);
-        g_error_free(error);
-        goto error;
+    if (keyboard != self->keyboard) {
+        self->keyboard = keyboard;
+        g_debug(
+            "brightness_service.c:brightness_service_pick_devices(): "
+            "keyboard: %s",
+            keyboard ? keyboard->name : "none");
+        if (keyboard) brightness_service_emit(self, keyboard);
     }
+}
 
-    g_signal_connect(self->backlight_file_monitor, "changed",
-                     G_CALLBACK(backlight_file_changed), self);
+// Re-reads every device a change was reported for. Hardware keys and ramping
+// drivers send bursts of change events, they are coalesced into at most one
+// read and emission per device every BRIGHTNESS_SERVICE_FLUSH_MS.
+static gboolean brightness_service_flush(BrightnessService *self) {
+    GHashTableIter iter;
+    BrightnessDevice *dev;
 
-    return;
+    self->flush_id = 0;
 
-error:
-    g_clear_object(&self->backlight_device_path);
-    g_clear_object(&brightness_file);
-    g_clear_object(&max_brightness_file);
-    return;
-}
+    g_hash_table_iter_init(&iter, self->devices);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&dev)) {
+        if (!dev->dirty) continue;
+        dev->dirty = false;
+        if (brightness_device_read(dev)) brightness_service_emit(self, dev);
+    }
 
-void keyboard_file_changed(GFileMonitor *file_mon, GFile *file,
-                           GFile *other_file, GFileMonitorEvent event_type,
-                           BrightnessService *self) {
-    get_current_keyboard_brightness(self);
-    g_signal_emit(self, signals[keyboard_brightness_changed], 0,
-                  self->keyboard_brightness);
+    return G_SOURCE_REMOVE;
 }
 
-static void on_backlight_keyboard_changed(GSettings *settings, gchar *key,
-                                          gpointer user_data) {
-    g_debug("brightness_service.c:on_backlight_keyboard_changed(): called");
-
-    BrightnessService *self = user_data;
-    g_clear_object(&self->keyboard_device_path);
+static void brightness_service_mark_dirty(BrightnessService *self,
+                                          BrightnessDevice *dev) {
+    dev->dirty = true;
+    if (!self->flush_id)
+        self->flush_id =
+            g_timeout_add(BRIGHTNESS_SERVICE_FLUSH_MS,
+                          (GSourceFunc)brightness_service_flush, self);
+}
 
-    if (self->keyboard_file_monitor) {
-        g_file_monitor_cancel(self->keyboard_file_monitor);
-        g_clear_object(&self->keyboard_file_monitor);
+static void brightness_service_add_device(BrightnessService *self,
+                                          GUdevDevice *udev_dev) {
+    gchar *key = brightness_device_key(g_udev_device_get_subsystem(udev_dev),
+                                       g_udev_device_get_name(udev_dev));
+    if (g_hash_table_contains(self->devices, key)) {
+        g_free(key);
+        return;
     }
 
-    // check for empty string.
-    if (strlen(g_settings_get_string(settings, key)) == 0) {
-        self->has_keyboard_brightness = false;
+    BrightnessDevice *dev = brightness_device_new(udev_dev);
+    if (!dev) {
+        g_free(key);
         return;
     }
 
-    // join the path /sys/class/leds/ with the settings value and make
-    // it a GFile*
-    self->keyboard_device_path = g_file_new_for_path(g_build_filename(
-        "/sys/class/leds", g_settings_get_string(settings, key), NULL));
+    g_debug("brightness_service.c:brightness_service_add_device(): %s", key);
+    g_hash_table_insert(self->devices, key, dev);
+}
 
-    // debug device path
-    g_debug(
-        "brightness_service.c:on_backlight_keyboard_changed(): device path: "
-        "%s",
-        g_file_get_path(self->keyboard_device_path));
+static void on_uevent(GUdevClient *client, const gchar *action,
+                      GUdevDevice *udev_dev, BrightnessService *self) {
+    g_debug("brightness_service.c:on_uevent(): %s %s", action,
+            g_udev_device_get_sysfs_path(udev_dev));
 
-    // ensure device path exists
-    if (!g_file_query_exists(self->keyboard_device_path, NULL)) {
-        g_warning(
-            "brightness_service.c:on_backlight_keyboard_changed(): keyboard "
-            "directory does not exist");
-        g_clear_object(&self->keyboard_device_path);
-        self->has_keyboard_brightness = false;
+    if (g_strcmp0(action, "add") == 0) {
+        brightness_service_add_device(self, udev_dev);
+        brightness_service_pick_devices(self);
         return;
     }
-    self->has_keyboard_brightness = true;
 
-    GFile *brightness_file =
-        g_file_get_child(self->keyboard_device_path, "brightness");
-    g_debug(
-        "brightness_service.c:on_backlight_keyboard_changed(): brightness"
-        "file: "
-        "%s",
-        g_file_get_path(brightness_file));
-
-    GFile *max_brightness_file =
-        g_file_get_child(self->keyboard_device_path, "max_brightness");
-    g_debug(
-        "brightness_service.c:on_backlight_keyboard_changed(): max_brightness "
-        "file: %s",
-        g_file_get_path(max_brightness_file));
-
-    // ensure brightness_file exists
-    if (!g_file_query_exists(brightness_file, NULL)) {
-        g_warning(
-            "brightness_service.c:on_backlight_keyboard_changed(): "
-            "brightness "
-            "file does not exist");
-        goto error;
+    gchar *key = brightness_device_key(g_udev_device_get_subsystem(udev_dev),
+                                       g_udev_device_get_name(udev_dev));
+    BrightnessDevice *dev = g_hash_table_lookup(self->devices, key);
+
+    if (dev && g_strcmp0(action, "remove") == 0) {
+        if (dev == self->backlight) self->backlight = NULL;
+        if (dev == self->keyboard) self->keyboard = NULL;
+        g_hash_table_remove(self->devices, key);
+        brightness_service_pick_devices(self);
+    } else if (dev && g_strcmp0(action, "change") == 0) {
+        brightness_service_mark_dirty(self, dev);
     }
 
-    // read max_brightness_file into variable
-    GError *error = NULL;
-    gchar *max_brightness_str = NULL;
-    if (!g_file_load_contents(max_brightness_file, NULL, &max_brightness_str,
-                              NULL, NULL, &error)) {
-        g_warning(
-            "brightness_service.c:on_backlight_keyboard_changed(): failed to "
-            "read max_brightness file: %s",
-            error->message);
-        g_error_free(error);
-        goto error;
-    }
-    self->keyboard_max_brightness =
-        g_ascii_strtoull(max_brightness_str, NULL, 10);
-
-    get_current_keyboard_brightness(self);
+    g_free(key);
+}
 
-    // emit initial brightness event
-    g_signal_emit(self, signals[keyboard_brightness_changed], 0,
-                  self->keyboard_brightness);
+static void on_device_settings_changed(GSettings *settings, gchar *key,
+                                       BrightnessService *self) {
+    g_debug("brightness_service.c:on_device_settings_changed(): %s", key);
+    brightness_service_pick_devices(self);
+}
 
-    // setup file monitor
-    error = NULL;
-    self->keyboard_file_monitor =
-        g_file_monitor_file(self->keyboard_device_path,
-                            G_FILE_MONITOR_WATCH_HARD_LINKS, NULL, &error);
-    if (error) {
-        g_warning(
-            "brightness_service.c:on_backlight_keyboard_changed(): failed to "
-            "setup file monitor: %s",
-            error->message);
-        g_error_free(error);
-        goto error;
-    }
+static void brightness_service_dispose(GObject *object) {
+    BrightnessService *self = BRIGHTNESS_SERVICE(object);
+    g_clear_handle_id(&self->flush_id, g_source_remove);
+    if (self->udev) g_signal_handlers_disconnect_by_data(self->udev, self);
+    G_OBJECT_CLASS(brightness_service_parent_class)->dispose(object);
+}
+static void brightness_service_finalize(GObject *object) {
+    BrightnessService *self = BRIGHTNESS_SERVICE(object);
+    self->backlight = NULL;
+    self->keyboard = NULL;
+    g_clear_pointer(&self->devices, g_hash_table_unref);
+    g_clear_object(&self->udev);
+    g_clear_object(&self->systems_settings);
+    G_OBJECT_CLASS(brightness_service_parent_class)->finalize(object);
+}
+static void brightness_service_class_init(BrightnessServiceClass *klass) {
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+    object_class->dispose = brightness_service_dispose;
+    object_class->finalize = brightness_service_finalize;
 
-    g_signal_connect(self->keyboard_file_monitor, "changed",
-                     G_CALLBACK(keyboard_file_changed), self);
+    signals[brightness_changed] = g_signal_new(
+        "brightness-changed", G_TYPE_FROM_CLASS(klass), G_SIGNAL_RUN_LAST, 0,
+        NULL, NULL, NULL, G_TYPE_NONE, 1, G_TYPE_FLOAT);
 
-    return;
+    signals[keyboard_brightness_changed] = g_signal_new(
+        "keyboard-brightness-changed", G_TYPE_FROM_CLASS(klass),
+        G_SIGNAL_RUN_LAST, 0, NULL, NULL, NULL, G_TYPE_NONE, 1, G_TYPE_UINT);
 
-error:
-    g_clear_object(&self->keyboard_device_path);
-    g_clear_object(&brightness_file);
-    g_clear_object(&max_brightness_file);
-    return;
+    // emitted for every backlight device, with its name and brightness
+    // percent.
+    signals[device_brightness_changed] = g_signal_new(
+        "device-brightness-changed", G_TYPE_FROM_CLASS(klass),
+        G_SIGNAL_RUN_LAST, 0, NULL, NULL, NULL, G_TYPE_NONE, 2, G_TYPE_STRING,
+        G_TYPE_FLOAT);
 }
 
 static void brightness_service_init(BrightnessService *self) {
+    const gchar *subsystems[] = {"backlight", "leds", NULL};
+
     self->systems_settings = g_settings_new("org.ldelossa.way-shell.system");
-    self->has_backlight_brightness = false;
-    self->has_keyboard_brightness = false;
+    self->devices =
+        g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                              (GDestroyNotify)brightness_device_free);
+    self->udev = g_udev_client_new(subsystems);
+
+    for (guint i = 0; subsystems[i]; i++) {
+        GList *list =
+            g_udev_client_query_by_subsystem(self->udev, subsystems[i]);
+        for (GList *l = list; l; l = l->next)
+            brightness_service_add_device(self, l->data);
+        g_list_free_full(list, g_object_unref);
+    }
 
-    on_backlight_directory_changed(self->systems_settings,
-                                   "backlight-directory", self);
+    brightness_service_pick_devices(self);
 
-    on_backlight_keyboard_changed(self->systems_settings,
-                                  "keyboard-backlight-directory", self);
+    g_signal_connect(self->udev, "uevent", G_CALLBACK(on_uevent), self);
 
     // connect to setting's change.
     g_signal_connect(self->systems_settings, "changed::backlight-directory",
-                     G_CALLBACK(on_backlight_directory_changed), self);
+                     G_CALLBACK(on_device_settings_changed), self);
+    g_signal_connect(self->systems_settings,
+                     "changed::keyboard-backlight-directory",
+                     G_CALLBACK(on_device_settings_changed), self);
 }
 
 int brightness_service_global_init(void) {
@@ -364,80 +378,149 @@ int brightness_service_global_init(void) {
     return 0;
 }
 
-void brightness_service_backlight_up(BrightnessService *self) {
-    LogindService *logind = logind_service_get_global();
+static void brightness_service_send(BrightnessService *self,
+                                    BrightnessDevice *dev);
 
-    get_current_backlight_brightness(self);
+static void on_set_brightness_done(GObject *source, GAsyncResult *res,
+                                   gchar *key) {
+    BrightnessService *self = global;
+    GError *error = NULL;
 
-    int addend = self->max_backlight_brightness / 12;
+    if (!logind_service_session_set_brightness_finish(
+            logind_service_get_global(), res, &error)) {
+        g_critical(
+            "brightness_service.c:on_set_brightness_done(): %s: %s", key,
+            error->message);
+        g_error_free(error);
+    }
 
-    // add 1000 to current brightness
-    self->backlight_brightness += addend;
+    // the device may have been unplugged while the call was in flight.
+    BrightnessDevice *dev = g_hash_table_lookup(self->devices, key);
+    g_free(key);
+    if (!dev) return;
 
-    // if brightness is over max brightness clamp it to max brightness
-    if (self->backlight_brightness > self->max_backlight_brightness)
-        self->backlight_brightness = self->max_backlight_brightness;
-
-    // use logind service to set backlight
-    if (logind_service_session_set_brightness(
-            logind, "backlight",
-            g_settings_get_string(self->systems_settings,
-                                  "backlight-directory"),
-            self->backlight_brightness) != 0)
-        return;
+    dev->writing = false;
 
-    // file monitor will catch the change, update our internal state and
-    // send a signal
+    // led class devices don't send change events for sysfs writes, re-read
+    // either way.
+    brightness_service_mark_dirty(self, dev);
+
+    if (dev->target != dev->sent) brightness_service_send(self, dev);
 }
 
-void brightness_service_backlight_down(BrightnessService *self) {
-    LogindService *logind = logind_service_get_global();
+static void brightness_service_send(BrightnessService *self,
+                                    BrightnessDevice *dev) {
+    dev->writing = true;
+    dev->sent = dev->target;
 
-    get_current_backlight_brightness(self);
+    logind_service_session_set_brightness_async(
+        logind_service_get_global(), dev->subsystem, dev->name, dev->sent,
+        (GAsyncReadyCallback)on_set_brightness_done,
+        brightness_device_key(dev->subsystem, dev->name));
+}
 
-    int subtrahend = self->max_backlight_brightness / 12;
+// Writes a device's brightness through logind without blocking. At most one
+// call per device is in flight, values requested meanwhile replace each other
+// and only the latest is sent when the call completes.
+static void brightness_service_write(BrightnessService *self,
+                                     BrightnessDevice *dev,
+                                     guint32 brightness) {
+    dev->target = brightness;
+    if (dev->writing) return;
+    brightness_service_send(self, dev);
+}
 
-    gint32 brightness = self->backlight_brightness - subtrahend;
+// The brightness a device is headed to, steps build on this so key repeats
+// aren't lost while a write is in flight.
+static guint32 brightness_device_target(BrightnessService *self,
+                                        BrightnessDevice *dev) {
+    guint32 brightness;
+
+    if (dev->writing) return dev->target;
+    if (!brightness_device_read_value(dev, &brightness))
+        return dev->brightness;
+
+    // an external change we haven't announced yet, the flush updates
+    // dev->brightness and emits it.
+    if (brightness != dev->brightness)
+        brightness_service_mark_dirty(self, dev);
+    return brightness;
+}
 
-    // if brightness is under 0 clamp it to 0
-    self->backlight_brightness = (brightness < 0) ? 0 : brightness;
-
-    // use logind service to set backlight
-    if (logind_service_session_set_brightness(
-            logind, "backlight",
-            g_settings_get_string(self->systems_settings,
-                                  "backlight-directory"),
-            self->backlight_brightness) != 0)
-        return;
+void brightness_service_backlight_up(BrightnessService *self) {
+    BrightnessDevice *dev = self->backlight;
+    if (!dev) return;
+
+    guint32 brightness =
+        brightness_device_target(self, dev) + dev->max_brightness / 12;
 
-    // file monitor will catch the change, update our internal state and
-    // send a signal
+    // if brightness is over max brightness clamp it to max brightness
+    if (brightness > dev->max_brightness) brightness = dev->max_brightness;
+
+    brightness_service_write(self, dev, brightness);
+}
+
+void brightness_service_backlight_down(BrightnessService *self) {
+    BrightnessDevice *dev = self->backlight;
+    if (!dev) return;
+
+    gint64 brightness =
+        (gint64)brightness_device_target(self, dev) - dev->max_brightness / 12;
+
+    // if brightness is under 0 clamp it to 0
+    brightness_service_write(self, dev, (brightness < 0) ? 0 : brightness);
 }
 
 void brightness_service_set_backlight(BrightnessService *self, float percent) {
-    LogindService *logind = logind_service_get_global();
+    BrightnessDevice *dev = self->backlight;
+    if (!dev) return;
 
     // clamp percent to 0.0 - 1.0
     percent = CLAMP(percent, 0.0, 1.0);
 
-    // calculate new brightness
-    guint32 brightness = (guint32)(self->max_backlight_brightness * percent);
+    brightness_service_write(self, dev,
+                             (guint32)(dev->max_brightness * percent));
+}
 
-    // use logind service to set backlight
-    if (logind_service_session_set_brightness(
-            logind, "backlight",
-            g_settings_get_string(self->systems_settings,
-                                  "backlight-directory"),
-            brightness) != 0)
-        return;
+float brightness_service_get_backlight(BrightnessService *self) {
+    if (!self->backlight) return 0.0;
+    return compute_brightness_percent(self->backlight->brightness,
+                                      self->backlight->max_brightness);
+}
+
+GPtrArray *brightness_service_get_backlight_devices(BrightnessService *self) {
+    GHashTableIter iter;
+    BrightnessDevice *dev;
+    GPtrArray *names = g_ptr_array_new_with_free_func(g_free);
 
-    // file monitor will catch the change, update our internal state and
-    // send a signal
+    g_hash_table_iter_init(&iter, self->devices);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&dev))
+        if (g_strcmp0(dev->subsystem, "backlight") == 0)
+            g_ptr_array_add(names, g_strdup(dev->name));
+    return names;
 }
 
-float brightness_service_get_backlight(BrightnessService *self) {
-    return (float)self->backlight_brightness /
-           (float)self->max_backlight_brightness;
+void brightness_service_set_device_backlight(BrightnessService *self,
+                                             const gchar *name,
+                                             float percent) {
+    gchar *key = brightness_device_key("backlight", name);
+    BrightnessDevice *dev = g_hash_table_lookup(self->devices, key);
+    g_free(key);
+    if (!dev) return;
+
+    percent = CLAMP(percent, 0.0, 1.0);
+    brightness_service_write(self, dev,
+                             (guint32)(dev->max_brightness * percent));
+}
+
+float brightness_service_get_device_backlight(BrightnessService *self,
+                                              const gchar *name) {
+    gchar *key = brightness_device_key("backlight", name);
+    BrightnessDevice *dev = g_hash_table_lookup(self->devices, key);
+    g_free(key);
+    if (!dev) return 0.0;
+
+    return compute_brightness_percent(dev->brightness, dev->max_brightness);
 }
 
 gchar *brightness_service_map_icon(BrightnessService *self) {
@@ -445,91 +528,58 @@ gchar *brightness_service_map_icon(BrightnessService *self) {
 }
 
 void brightness_service_keyboard_up(BrightnessService *self) {
-    LogindService *logind = logind_service_get_global();
+    BrightnessDevice *dev = self->keyboard;
+    if (!dev) return;
 
-    get_current_keyboard_brightness(self);
-
-    self->keyboard_brightness += 1;
+    guint32 brightness = brightness_device_target(self, dev) + 1;
 
     // if brightness exceeds max brightness, we actually want to turn off the
     // backlight. This works well for most modern laptops which only have a
     // single backlight button
-    if (self->keyboard_brightness > self->keyboard_max_brightness)
-        self->keyboard_brightness = 0;
-
-    // use logind service to set backlight
-    if (logind_service_session_set_brightness(
-            logind, "leds",
-            g_settings_get_string(self->systems_settings,
-                                  "keyboard-backlight-directory"),
-            self->keyboard_brightness) != 0)
-        return;
+    if (brightness > dev->max_brightness) brightness = 0;
 
-    // file monitor will catch the change, update our internal state and
-    // send a signal
+    brightness_service_write(self, dev, brightness);
 }
 
 void brightness_service_keyboard_down(BrightnessService *self) {
-    LogindService *logind = logind_service_get_global();
+    BrightnessDevice *dev = self->keyboard;
+    if (!dev) return;
 
-    get_current_keyboard_brightness(self);
-
-    gint32 brightness = self->keyboard_brightness - 1;
-
-    // subtract 1000 from current brightness
-    self->keyboard_brightness -= 1;
+    guint32 current = brightness_device_target(self, dev);
 
     // if brightness is under 0 then we actually want to turn the brightness to
     // max.
     // This works well for most modern laptops which only have a single
     // backlight button
-    self->keyboard_brightness =
-        (brightness < 0) ? self->keyboard_max_brightness : brightness;
-
-    // use logind service to set backlight
-    if (logind_service_session_set_brightness(
-            logind, "leds",
-            g_settings_get_string(self->systems_settings,
-                                  "keyboard-backlight-directory"),
-            self->keyboard_brightness) != 0)
-        return;
+    guint32 brightness = (current == 0) ? dev->max_brightness : current - 1;
 
-    // file monitor will catch the change, update our internal state and
-    // send a signal
+    brightness_service_write(self, dev, brightness);
 }
 
 void brightness_service_set_keyboard(BrightnessService *self, uint32_t value) {
-    LogindService *logind = logind_service_get_global();
+    BrightnessDevice *dev = self->keyboard;
+    if (!dev) return;
 
     // ensure value is not larger then max
-    if (value > self->keyboard_max_brightness) return;
-
-    // use logind service to set backlight
-    if (logind_service_session_set_brightness(
-            logind, "leds",
-            g_settings_get_string(self->systems_settings,
-                                  "keyboard-backlight-directory"),
-            value) != 0)
-        return;
+    if (value > dev->max_brightness) return;
 
-    // file monitor will catch the change, update our internal state and
-    // send a signal
+    brightness_service_write(self, dev, value);
 }
 
 uint32_t brightness_service_get_keyboard(BrightnessService *self) {
-    return self->keyboard_brightness;
+    return self->keyboard ? self->keyboard->brightness : 0;
 }
 
 uint32_t brightness_service_get_keyboard_max(BrightnessService *self) {
-    return self->keyboard_max_brightness;
+    return self->keyboard ? self->keyboard->max_brightness : 0;
 }
 
 BrightnessService *brightness_service_get_global() { return global; }
 
 gboolean brightness_service_has_backlight_brightness(BrightnessService *self) {
-    return self->has_backlight_brightness;
+    return self->backlight != NULL;
 }
 
 gboolean brightness_service_has_keyboard_brightness(BrightnessService *self) {
-    return self->has_keyboard_brightness;
+    return self->keyboard != NULL;
 }
@@ -2,6 +2,10 @@
 
 #include <adwaita.h>
 
+// Interval, in milliseconds, bursts of backlight change events are coalesced
+// over before the devices are re-read, about once per frame.
+#define BRIGHTNESS_SERVICE_FLUSH_MS 16
+
 G_BEGIN_DECLS
 
 struct _BrightnessService;
@@ -25,6 +29,16 @@ void brightness_service_set_backlight(BrightnessService *self, float percent);
 
 float brightness_service_get_backlight(BrightnessService *self);
 
+// Returns the names of every backlight device, such as laptop panels and
+// DDC/CI monitors exposed by ddcci-backlight. Free with g_ptr_array_unref.
+GPtrArray *brightness_service_get_backlight_devices(BrightnessService *self);
+
+void brightness_service_set_device_backlight(BrightnessService *self,
+                                             const gchar *name, float percent);
+
+float brightness_service_get_device_backlight(BrightnessService *self,
+                                              const gchar *name);
+
 void brightness_service_keyboard_up(BrightnessService *self);
 
 void brightness_service_keyboard_down(BrightnessService *self);
@@ -38,6 +38,7 @@ enum IPCCommands : uint32_t {
     IPC_CMD_RENAME_SWITCHER_SHOW,
     IPC_CMD_RENAME_SWITCHER_HIDE,
     IPC_CMD_RENAME_SWITCHER_TOGGLE,
+    IPC_CMD_MICROPHONE_ACTIVE,
 };
 
 typedef struct _IPCHeader {
@@ -176,3 +177,8 @@ typedef struct _IPCRenameSwitcherHide {
 typedef struct _IPCRenameSwitcherToggle {
 	IPCHeader header;
 } IPCRenameSwitcherToggle;
+
+// The one byte response is TRUE while any microphone is capturing.
+typedef struct _IPCMicrophoneActive {
+    IPCHeader header;
+} IPCMicrophoneActive;
@@ -118,6 +118,18 @@ static gboolean ipc_cmd_volume_mute(IPCVolumeMute *msg) {
     return true;
 }
 
+static gboolean ipc_cmd_microphone_active() {
+    g_debug("ipc_service.c:ipc_cmd_microphone_active()");
+    WirePlumberService *wp = wire_plumber_service_get_global();
+    if (!wp) {
+        g_critical(
+            "ipc_service.c:ipc_cmd_microphone_active() failed to get "
+            "wireplumber service");
+        return false;
+    }
+    return wire_plumber_service_microphone_active(wp);
+}
+
 static gboolean ipc_cmd_brightness_up() {
     g_debug("ipc_service.c:ipc_cmd_brightness_up()");
     BrightnessService *b = brightness_service_get_global();
@@ -740,6 +752,12 @@ static gboolean on_ipc_readable(gint fd, GIOCondition condition,
                 "IPC_CMD_RENAME_SWITCHER_TOGGLE");
             ret = ip_cmd_rename_switcher_toggle();
             break;
+        case IPC_CMD_MICROPHONE_ACTIVE:
+            g_debug(
+                "ipc_service.c:on_ipc_readable() received "
+                "IPC_CMD_MICROPHONE_ACTIVE");
+            ret = ipc_cmd_microphone_active();
+            break;
         default:
             goto skip_resp;
             break;
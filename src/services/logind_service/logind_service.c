@@ -369,23 +369,26 @@ void logind_service_kill_session(LogindService *self) {
     }
 }
 
-int logind_service_session_set_brightness(LogindService *self,
-                                          const gchar *arg_subsystem,
-                                          const gchar *arg_name,
-                                          guint arg_brightness) {
-    g_debug("logind_service.c:logind_service_session_set_brightness(): called");
+void logind_service_session_set_brightness_async(LogindService *self,
+                                                 const gchar *arg_subsystem,
+                                                 const gchar *arg_name,
+                                                 guint arg_brightness,
+                                                 GAsyncReadyCallback callback,
+                                                 gpointer user_data) {
+    g_debug(
+        "logind_service.c:logind_service_session_set_brightness_async(): "
+        "called");
 
-    GError *error = NULL;
-    dbus_login1_session_call_set_brightness_sync(
-        self->session, arg_subsystem, arg_name, arg_brightness, NULL, &error);
-    if (error) {
-        g_critical(
-            "logind_service.c:logind_service_session_set_brightness(): error: "
-            "%s",
-            error->message);
-        return -1;
-    }
-    return 0;
+    dbus_login1_session_call_set_brightness(self->session, arg_subsystem,
+                                            arg_name, arg_brightness, NULL,
+                                            callback, user_data);
+}
+
+gboolean logind_service_session_set_brightness_finish(LogindService *self,
+                                                      GAsyncResult *res,
+                                                      GError **error) {
+    return dbus_login1_session_call_set_brightness_finish(self->session, res,
+                                                          error);
 }
 
 gboolean logind_service_set_idle_inhibit(LogindService *self, gboolean enable) {
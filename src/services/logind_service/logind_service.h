@@ -38,10 +38,19 @@ void logind_service_suspendthenhibernate(LogindService *self);
 
 void logind_service_kill_session(LogindService *self);
 
-int logind_service_session_set_brightness(LogindService *self,
-                                          const gchar *arg_subsystem,
-                                          const gchar *arg_name,
-                                          guint arg_brightness);
+// Sets a backlight or led's brightness through logind's SetBrightness without
+// blocking, `callback` runs on the main loop once logind replies and should
+// call logind_service_session_set_brightness_finish.
+void logind_service_session_set_brightness_async(LogindService *self,
+                                                 const gchar *arg_subsystem,
+                                                 const gchar *arg_name,
+                                                 guint arg_brightness,
+                                                 GAsyncReadyCallback callback,
+                                                 gpointer user_data);
+
+gboolean logind_service_session_set_brightness_finish(LogindService *self,
+                                                      GAsyncResult *res,
+                                                      GError **error);
 
 gboolean logind_service_set_idle_inhibit(LogindService *self, gboolean enable);
 
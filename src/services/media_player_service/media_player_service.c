@@ -11,11 +11,43 @@ static gchar *player_object_path = "/org/mpris/MediaPlayer2";
 
 enum signals { player_changed, player_removed, signals_n };
 
+// A decoded album art texture and the mtime of the file it was decoded from.
+typedef struct _MediaPlayerArtCacheEntry {
+    GdkTexture *texture;
+    guint64 mtime;
+} MediaPlayerArtCacheEntry;
+
+// An album art load running in a worker thread.
+typedef struct _MediaPlayerArtRequest {
+    gchar *url;
+    gchar *player_name;
+    gboolean cached;
+    guint64 cached_mtime;
+    guint64 mtime;
+} MediaPlayerArtRequest;
+
+// A media player whose proxies are still being created asynchronously.
+typedef struct _PendingMediaPlayer {
+    MediaPlayerService *self;
+    GCancellable *cancel;
+    MediaPlayer *player;
+} PendingMediaPlayer;
+
 struct _MediaPlayerService {
     GObject parent_instance;
     GDBusConnection *conn;
     GHashTable *players_by_proxy;
     GHashTable *players_by_name;
+    // name -> PendingMediaPlayer, for players still being discovered.
+    GHashTable *pending_by_name;
+    // players with changes not yet emitted, flushed once per main loop
+    // iteration.
+    GPtrArray *dirty_players;
+    guint flush_id;
+    // art url -> MediaPlayerArtCacheEntry
+    GHashTable *art_cache;
+    // art urls in insertion order, used to evict the oldest cache entry.
+    GQueue *art_cache_order;
     gboolean enabled;
 };
 static guint signals[signals_n] = {0};
@@ -48,38 +80,278 @@ static void media_player_service_class_init(MediaPlayerServiceClass *klass) {
         NULL, NULL, NULL, G_TYPE_NONE, 1, G_TYPE_POINTER);
 };
 
-static void media_player_fill_metadata(GVariant *metadata,
-                                       MediaPlayer *player) {
-    GVariantIter *iter = g_variant_iter_new(metadata);
+static gchar *media_player_join_artists(GVariant *value) {
+    if (!g_variant_is_of_type(value, G_VARIANT_TYPE_STRING_ARRAY))
+        return NULL;
+
+    GVariantIter iter;
+    const gchar *artist;
+    GString *artists = g_string_new(NULL);
+
+    g_variant_iter_init(&iter, value);
+    while (g_variant_iter_next(&iter, "&s", &artist)) {
+        if (artists->len > 0) g_string_append(artists, ", ");
+        g_string_append(artists, artist);
+    }
+    return g_string_free(artists, FALSE);
+}
+
+static gchar *media_player_dup_string(GVariant *value) {
+    if (!g_variant_is_of_type(value, G_VARIANT_TYPE_STRING)) return NULL;
+    return g_variant_dup_string(value, NULL);
+}
+
+// Returns TRUE if `key` has a different value in `metadata` then in `prev`.
+// The returned `value` is owned by the caller and may be NULL if the key was
+// removed.
+static gboolean media_player_metadata_key_changed(GVariant *prev,
+                                                  GVariant *metadata,
+                                                  const gchar *key,
+                                                  GVariant **value) {
+    *value = g_variant_lookup_value(metadata, key, NULL);
+    if (!prev) return TRUE;
+
+    GVariant *prev_value = g_variant_lookup_value(prev, key, NULL);
+    gboolean changed = TRUE;
+    if (!prev_value && !*value)
+        changed = FALSE;
+    else if (prev_value && *value)
+        changed = !g_variant_equal(prev_value, *value);
+
+    if (prev_value) g_variant_unref(prev_value);
+    if (!changed && *value) g_clear_pointer(value, g_variant_unref);
+    return changed;
+}
+
+// Parses only the keys of `metadata` which changed since the last call.
+// Returns TRUE if any displayed field changed.
+// `art_changed` is set to TRUE if the art url changed.
+static gboolean media_player_fill_metadata(GVariant *metadata,
+                                           MediaPlayer *player,
+                                           gboolean *art_changed) {
     GVariant *value;
-    const gchar *key;
-    while (g_variant_iter_next(iter, "{sv}", &key, &value)) {
-        if (g_strcmp0(key, "xesam:album") == 0) {
-            player->album = g_strdup(g_variant_get_string(value, NULL));
-        }
-        if (g_strcmp0(key, "xesam:title") == 0) {
-            player->title = g_strdup(g_variant_get_string(value, NULL));
-        }
-        if (g_strcmp0(key, "xesam:artist") == 0) {
-            GVariantIter *artist_iter = g_variant_iter_new(value);
-            gchar *value;
-            gchar *artist;
+    gboolean changed = FALSE;
 
-            g_variant_iter_next(artist_iter, "s", &artist);
+    *art_changed = FALSE;
 
-            while (g_variant_iter_next(artist_iter, "s", &value)) {
-                artist = g_strconcat(artist, ", ", value, NULL);
-            }
+    if (!metadata) return FALSE;
+    if (player->metadata && g_variant_equal(player->metadata, metadata))
+        return FALSE;
 
-            g_variant_iter_free(artist_iter);
+    if (media_player_metadata_key_changed(player->metadata, metadata,
+                                          "xesam:album", &value)) {
+        g_free(player->album);
+        player->album = value ? media_player_dup_string(value) : NULL;
+        changed = TRUE;
+    }
+    if (value) g_variant_unref(value);
 
-            player->artist = artist;
-        }
-        if (g_strcmp0(key, "mpris:artUrl") == 0) {
-            player->art_url = g_strdup(g_variant_get_string(value, NULL));
+    if (media_player_metadata_key_changed(player->metadata, metadata,
+                                          "xesam:title", &value)) {
+        g_free(player->title);
+        player->title = value ? media_player_dup_string(value) : NULL;
+        changed = TRUE;
+    }
+    if (value) g_variant_unref(value);
+
+    if (media_player_metadata_key_changed(player->metadata, metadata,
+                                          "xesam:artist", &value)) {
+        g_free(player->artist);
+        player->artist = value ? media_player_join_artists(value) : NULL;
+        changed = TRUE;
+    }
+    if (value) g_variant_unref(value);
+
+    if (media_player_metadata_key_changed(player->metadata, metadata,
+                                          "mpris:artUrl", &value)) {
+        g_free(player->art_url);
+        player->art_url = value ? media_player_dup_string(value) : NULL;
+        *art_changed = TRUE;
+        changed = TRUE;
+    }
+    if (value) g_variant_unref(value);
+
+    if (player->metadata) g_variant_unref(player->metadata);
+    player->metadata = g_variant_ref(metadata);
+
+    return changed;
+}
+
+static gboolean media_player_service_flush(MediaPlayerService *self) {
+    self->flush_id = 0;
+
+    // steal the array, handlers may mark players dirty again.
+    GPtrArray *dirty = self->dirty_players;
+    self->dirty_players = g_ptr_array_new();
+
+    for (guint i = 0; i < dirty->len; i++) {
+        MediaPlayer *player = g_ptr_array_index(dirty, i);
+        player->dirty = false;
+        g_signal_emit(self, signals[player_changed], 0, player);
+    }
+    g_ptr_array_unref(dirty);
+
+    return G_SOURCE_REMOVE;
+}
+
+// Queues a media-player-changed emission for `player`. Any number of property
+// changes arriving within the same main loop iteration result in a single
+// emission.
+static void media_player_service_mark_dirty(MediaPlayerService *self,
+                                            MediaPlayer *player) {
+    if (!player->dirty) {
+        player->dirty = true;
+        g_ptr_array_add(self->dirty_players, player);
+    }
+    if (!self->flush_id)
+        self->flush_id =
+            g_idle_add((GSourceFunc)media_player_service_flush, self);
+}
+
+static void media_player_art_cache_entry_free(MediaPlayerArtCacheEntry *entry) {
+    g_clear_object(&entry->texture);
+    g_free(entry);
+}
+
+static void media_player_art_request_free(MediaPlayerArtRequest *req) {
+    g_free(req->url);
+    g_free(req->player_name);
+    g_free(req);
+}
+
+// Runs in a worker thread. Decodes the art at MEDIA_PLAYER_ART_SIZE unless the
+// cached copy is still current, in which case NULL is returned.
+static void media_player_art_load_thread(GTask *task, gpointer source,
+                                         gpointer data,
+                                         GCancellable *cancel) {
+    MediaPlayerArtRequest *req = data;
+    GError *err = NULL;
+    GFile *file = g_file_new_for_uri(req->url);
+
+    // not every backend supports mtime (http art urls for example), these
+    // are keyed by url alone.
+    GFileInfo *info = g_file_query_info(file, G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                                        G_FILE_QUERY_INFO_NONE, cancel, NULL);
+    if (info) {
+        req->mtime = g_file_info_get_attribute_uint64(
+            info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+        g_object_unref(info);
+    }
+
+    if (req->cached && req->mtime == req->cached_mtime) {
+        g_task_return_pointer(task, NULL, NULL);
+        goto out;
+    }
+
+    GFileInputStream *stream = g_file_read(file, cancel, &err);
+    if (!stream) {
+        g_task_return_error(task, err);
+        goto out;
+    }
+
+    GdkPixbuf *pixbuf = gdk_pixbuf_new_from_stream_at_scale(
+        G_INPUT_STREAM(stream), MEDIA_PLAYER_ART_SIZE, MEDIA_PLAYER_ART_SIZE,
+        TRUE, cancel, &err);
+    g_object_unref(stream);
+    if (!pixbuf) {
+        g_task_return_error(task, err);
+        goto out;
+    }
+
+    g_task_return_pointer(task, pixbuf, g_object_unref);
+
+out:
+    g_object_unref(file);
+}
+
+static void media_player_set_art(MediaPlayerService *self, MediaPlayer *player,
+                                 GdkTexture *art) {
+    if (player->art == art) return;
+    g_clear_object(&player->art);
+    if (art) player->art = g_object_ref(art);
+    media_player_service_mark_dirty(self, player);
+}
+
+static void on_media_player_art_loaded(GObject *source, GAsyncResult *res,
+                                       gpointer data) {
+    MediaPlayerService *self = MEDIA_PLAYER_SERVICE(source);
+    MediaPlayerArtRequest *req = g_task_get_task_data(G_TASK(res));
+    GError *err = NULL;
+
+    GdkPixbuf *pixbuf = g_task_propagate_pointer(G_TASK(res), &err);
+    if (err) {
+        g_warning(
+            "media_player_service.c:on_media_player_art_loaded(): failed to "
+            "load art %s: %s",
+            req->url, err->message);
+        g_error_free(err);
+        return;
+    }
+
+    MediaPlayerArtCacheEntry *entry =
+        g_hash_table_lookup(self->art_cache, req->url);
+
+    // a new or modified image was decoded, (re)fill the cache entry.
+    if (pixbuf) {
+        if (!entry) {
+            if (g_queue_get_length(self->art_cache_order) >=
+                MEDIA_PLAYER_ART_CACHE_SIZE) {
+                gchar *oldest = g_queue_pop_head(self->art_cache_order);
+                g_hash_table_remove(self->art_cache, oldest);
+                g_free(oldest);
+            }
+            entry = g_malloc0(sizeof(MediaPlayerArtCacheEntry));
+            g_hash_table_insert(self->art_cache, g_strdup(req->url), entry);
+            g_queue_push_tail(self->art_cache_order, g_strdup(req->url));
         }
-        g_variant_unref(value);
+        g_clear_object(&entry->texture);
+        entry->texture = gdk_texture_new_for_pixbuf(pixbuf);
+        entry->mtime = req->mtime;
+        g_object_unref(pixbuf);
     }
+    if (!entry) return;
+
+    // the player may have gone away or moved on to other art while we were
+    // loading.
+    MediaPlayer *player =
+        g_hash_table_lookup(self->players_by_name, req->player_name);
+    if (!player || g_strcmp0(player->art_url, req->url) != 0) return;
+
+    media_player_set_art(self, player, entry->texture);
+}
+
+// Resolves player->art for the player's current art url. Cached art is used
+// right away, a worker thread then checks the file's mtime and only decodes
+// the image again if it changed. Uncached art leaves player->art NULL until
+// it is decoded.
+static void media_player_service_load_art(MediaPlayerService *self,
+                                          MediaPlayer *player) {
+    if (!player->art_url || strlen(player->art_url) == 0) {
+        media_player_set_art(self, player, NULL);
+        return;
+    }
+
+    MediaPlayerArtRequest *req = g_malloc0(sizeof(MediaPlayerArtRequest));
+    req->url = g_strdup(player->art_url);
+    req->player_name = g_strdup(player->name);
+
+    MediaPlayerArtCacheEntry *entry =
+        g_hash_table_lookup(self->art_cache, player->art_url);
+    if (entry) {
+        req->cached = TRUE;
+        req->cached_mtime = entry->mtime;
+        media_player_set_art(self, player, entry->texture);
+    } else {
+        // don't keep showing the previous track's art while this loads, or
+        // at all if it fails to.
+        media_player_set_art(self, player, NULL);
+    }
+
+    GTask *task = g_task_new(self, NULL, on_media_player_art_loaded, NULL);
+    g_task_set_task_data(task, req,
+                         (GDestroyNotify)media_player_art_request_free);
+    g_task_run_in_thread(task, media_player_art_load_thread);
+    g_object_unref(task);
 }
 
 static void on_media_player_property_changed(
@@ -94,12 +366,17 @@ static void on_media_player_property_changed(
         g_hash_table_lookup(self->players_by_proxy, player_proxy);
     if (!player) return;
 
+    gboolean changed = false;
+
     // if update field is PlaybackStatus update it
     if (g_strcmp0(pspec->name, "playback-status") == 0) {
-        g_free(player->playback_status);
-
-        player->playback_status = g_strdup(
-            dbus_media_player2_player_get_playback_status(player_proxy));
+        const gchar *status =
+            dbus_media_player2_player_get_playback_status(player_proxy);
+        if (g_strcmp0(status, player->playback_status) != 0) {
+            g_free(player->playback_status);
+            player->playback_status = g_strdup(status);
+            changed = true;
+        }
 
         g_debug(
             "media_player_service.c:on_media_player_property_changed(): "
@@ -107,14 +384,13 @@ static void on_media_player_property_changed(
             player->name, player->playback_status);
     }
 
-    // if update field is metadata, update it
+    // if update field is metadata, update only the keys which changed
     if (g_strcmp0(pspec->name, "metadata") == 0) {
-        GVariant *metadata =
-            dbus_media_player2_player_get_metadata(player_proxy);
-
-        media_player_fill_metadata(metadata, player);
-
-        g_variant_unref(metadata);
+        gboolean art_changed = false;
+        changed |= media_player_fill_metadata(
+            dbus_media_player2_player_get_metadata(player_proxy), player,
+            &art_changed);
+        if (art_changed) media_player_service_load_art(self, player);
 
         g_debug(
             "media_player_service.c:on_media_player_property_changed(): "
@@ -123,61 +399,72 @@ static void on_media_player_property_changed(
             player->name, player->album, player->title, player->art_url);
     }
 
-    // emit event
-    g_signal_emit(self, signals[player_changed], 0, player);
+    if (changed) media_player_service_mark_dirty(self, player);
 }
 
-static void media_player_added(gchar *name, const gchar *object_path,
-                               MediaPlayerService *self) {
-    g_debug(
-        "media_player_service.c:media_player_added(): media player added: %s",
-        name);
+static void media_player_free(MediaPlayer *player) {
+    g_clear_object(&player->player);
+    g_clear_object(&player->proxy);
+    g_free(player->identity);
+    g_free(player->name);
+    g_free(player->playback_status);
+    g_free(player->art_url);
+    g_free(player->album);
+    g_free(player->artist);
+    g_free(player->title);
+    g_clear_object(&player->art);
+    if (player->metadata) g_variant_unref(player->metadata);
+    g_free(player);
+}
 
-    GError *err = NULL;
-    DbusMediaPlayer2 *mediaplayer2 = NULL;
-    DbusMediaPlayer2Player *mediaplayer2_player = NULL;
-    MediaPlayer *media_player = g_malloc0(sizeof(MediaPlayer));
+static void pending_media_player_free(PendingMediaPlayer *pending) {
+    g_object_unref(pending->cancel);
+    if (pending->player) media_player_free(pending->player);
+    g_free(pending);
+}
 
-    // instantiate interface org.mpris.MediaPlayer2 proxy
-    mediaplayer2 =
-        dbus_media_player2_proxy_new_sync(self->conn, G_DBUS_PROXY_FLAGS_NONE,
-                                          name, player_object_path, NULL, &err);
-    if (err) {
-        g_warning("media_player_service.c:media_player_added(): error: %s",
-                  err->message);
-        g_error_free(err);
-        return;
-    }
+static void on_media_player2_player_proxy_new(GObject *source,
+                                              GAsyncResult *res,
+                                              gpointer data) {
+    PendingMediaPlayer *pending = data;
+    GError *err = NULL;
 
-    // instantiate interface org.mpris.MediaPlayer2.Player proxy
-    mediaplayer2_player = dbus_media_player2_player_proxy_new_sync(
-        self->conn, G_DBUS_PROXY_FLAGS_NONE, name, player_object_path, NULL,
-        &err);
+    DbusMediaPlayer2Player *mediaplayer2_player =
+        dbus_media_player2_player_proxy_new_finish(res, &err);
     if (err) {
-        g_warning("media_player_service.c:media_player_added(): error: %s",
-                  err->message);
+        // cancelled means the pending player was removed and freed already.
+        if (!g_error_matches(err, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+            g_warning(
+                "media_player_service.c:on_media_player2_player_proxy_new(): "
+                "error: %s",
+                err->message);
+            g_hash_table_remove(pending->self->pending_by_name,
+                                pending->player->name);
+        }
         g_error_free(err);
         return;
     }
 
-    // fill in our domain MediaPlayer object
-    media_player->proxy = mediaplayer2;
-    media_player->player = mediaplayer2_player;
-    media_player->name = g_strdup(name);
+    MediaPlayerService *self = pending->self;
+    MediaPlayer *media_player = pending->player;
 
-    media_player->identity =
-        g_strdup(dbus_media_player2_get_identity(mediaplayer2));
+    // take ownership of the player, the pending entry is done.
+    pending->player = NULL;
+    g_hash_table_remove(self->pending_by_name, media_player->name);
 
+    media_player->player = mediaplayer2_player;
     media_player->playback_status = g_strdup(
         dbus_media_player2_player_get_playback_status(mediaplayer2_player));
 
+    gboolean art_changed = false;
     media_player_fill_metadata(
         dbus_media_player2_player_get_metadata(mediaplayer2_player),
-        media_player);
+        media_player, &art_changed);
 
     g_debug(
-        "media_player_service.c:media_player_added(): media player added: "
-        "name: %s, playback_status: %s, album: %s, title: %s, art_url: %s",
+        "media_player_service.c:on_media_player2_player_proxy_new(): media "
+        "player added: name: %s, playback_status: %s, album: %s, title: %s, "
+        "art_url: %s",
         media_player->name, media_player->playback_status, media_player->album,
         media_player->title, media_player->art_url);
 
@@ -189,7 +476,8 @@ static void media_player_added(gchar *name, const gchar *object_path,
                         media_player);
 
     // notify subscribers that new media player is available.
-    g_signal_emit(self, signals[player_changed], 0, media_player);
+    media_player_service_mark_dirty(self, media_player);
+    if (art_changed) media_player_service_load_art(self, media_player);
 
     // watch for MediaPlayer2.Player property changes.
     g_signal_connect(mediaplayer2_player, "notify::playback-status",
@@ -198,12 +486,79 @@ static void media_player_added(gchar *name, const gchar *object_path,
                      G_CALLBACK(on_media_player_property_changed), self);
 }
 
-static void media_player_removed(gchar *name, MediaPlayerService *self) {
+static void on_media_player2_proxy_new(GObject *source, GAsyncResult *res,
+                                       gpointer data) {
+    PendingMediaPlayer *pending = data;
+    GError *err = NULL;
+
+    DbusMediaPlayer2 *mediaplayer2 =
+        dbus_media_player2_proxy_new_finish(res, &err);
+    if (err) {
+        if (!g_error_matches(err, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+            g_warning(
+                "media_player_service.c:on_media_player2_proxy_new(): error: "
+                "%s",
+                err->message);
+            g_hash_table_remove(pending->self->pending_by_name,
+                                pending->player->name);
+        }
+        g_error_free(err);
+        return;
+    }
+
+    pending->player->proxy = mediaplayer2;
+    pending->player->identity =
+        g_strdup(dbus_media_player2_get_identity(mediaplayer2));
+
+    // instantiate interface org.mpris.MediaPlayer2.Player proxy
+    dbus_media_player2_player_proxy_new(
+        pending->self->conn, G_DBUS_PROXY_FLAGS_NONE, pending->player->name,
+        player_object_path, pending->cancel, on_media_player2_player_proxy_new,
+        pending);
+}
+
+static void media_player_added(const gchar *name, const gchar *object_path,
+                               MediaPlayerService *self) {
+    g_debug(
+        "media_player_service.c:media_player_added(): media player added: %s",
+        name);
+
+    if (g_hash_table_contains(self->players_by_name, name) ||
+        g_hash_table_contains(self->pending_by_name, name))
+        return;
+
+    // proxies are created asynchronously, browsers register a player per tab
+    // and creating these synchronously stalls the main loop.
+    PendingMediaPlayer *pending = g_malloc0(sizeof(PendingMediaPlayer));
+    pending->self = self;
+    pending->cancel = g_cancellable_new();
+    pending->player = g_malloc0(sizeof(MediaPlayer));
+    pending->player->name = g_strdup(name);
+
+    g_hash_table_insert(self->pending_by_name, pending->player->name, pending);
+
+    // instantiate interface org.mpris.MediaPlayer2 proxy
+    dbus_media_player2_proxy_new(self->conn, G_DBUS_PROXY_FLAGS_NONE, name,
+                                 player_object_path, pending->cancel,
+                                 on_media_player2_proxy_new, pending);
+}
+
+static void media_player_removed(const gchar *name, MediaPlayerService *self) {
     g_debug(
         "media_player_service.c:media_player_removed(): media player removed: "
         "%s",
         name);
 
+    // still being discovered, cancel proxy creation and forget it, no one has
+    // seen this player yet.
+    PendingMediaPlayer *pending =
+        g_hash_table_lookup(self->pending_by_name, name);
+    if (pending) {
+        g_cancellable_cancel(pending->cancel);
+        g_hash_table_remove(self->pending_by_name, name);
+        return;
+    }
+
     MediaPlayer *player = g_hash_table_lookup(self->players_by_name, name);
     if (!player) return;
 
@@ -216,9 +571,12 @@ static void media_player_removed(gchar *name, MediaPlayerService *self) {
 
     g_hash_table_remove(self->players_by_proxy, player->player);
     g_hash_table_remove(self->players_by_name, player->name);
+    if (player->dirty) g_ptr_array_remove(self->dirty_players, player);
 
     // emit event
     g_signal_emit(self, signals[player_removed], 0, player);
+
+    media_player_free(player);
 }
 
 static void media_player_service_on_name_owner_changed(
@@ -290,6 +648,14 @@ static void media_player_service_init(MediaPlayerService *self) {
 
     self->players_by_proxy = g_hash_table_new(g_direct_hash, g_direct_equal);
     self->players_by_name = g_hash_table_new(g_str_hash, g_str_equal);
+    self->pending_by_name = g_hash_table_new_full(
+        g_str_hash, g_str_equal, NULL,
+        (GDestroyNotify)pending_media_player_free);
+    self->dirty_players = g_ptr_array_new();
+    self->art_cache = g_hash_table_new_full(
+        g_str_hash, g_str_equal, g_free,
+        (GDestroyNotify)media_player_art_cache_entry_free);
+    self->art_cache_order = g_queue_new();
 
     media_player_service_dbus_connect(self);
 }
@@ -4,6 +4,13 @@
 
 #include "media_player_dbus.h"
 
+// Size, in pixels, album art is decoded at. Media player widgets display art
+// in a 48px avatar, decoding at twice that keeps art sharp on HiDPI outputs.
+#define MEDIA_PLAYER_ART_SIZE 96
+
+// Maximum number of decoded album art textures kept in the art cache.
+#define MEDIA_PLAYER_ART_CACHE_SIZE 32
+
 typedef struct _MediaPlayer {
     DbusMediaPlayer2Player *player;
     DbusMediaPlayer2 *proxy;
@@ -14,6 +21,14 @@ typedef struct _MediaPlayer {
     gchar *album;
     gchar *artist;
     gchar *title;
+    // decoded album art for art_url, shared by every widget showing this
+    // player, NULL until loaded.
+    GdkTexture *art;
+    // last Metadata dict seen, used to parse only the keys which changed.
+    GVariant *metadata;
+    // set when a property changed and a media-player-changed emission is
+    // pending.
+    gboolean dirty;
 } MediaPlayer;
 
 G_BEGIN_DECLS
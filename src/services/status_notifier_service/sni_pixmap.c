@@ -0,0 +1,177 @@
+#include "sni_pixmap.h"
+
+#include <adwaita.h>
+#include <string.h>
+
+// Four ARGB32 pixels, converting a pixel is a rotate of its 32 bit word which
+// the compiler lowers to shift/or pairs on SSE2, AVX2 or NEON registers.
+typedef guint32 sni_v4u32 __attribute__((vector_size(16)));
+
+gint sni_pixmap_target_size() {
+    gint scale = 1;
+    GdkDisplay *display = gdk_display_get_default();
+    if (!display) return SNI_ICON_SIZE;
+
+    GListModel *monitors = gdk_display_get_monitors(display);
+    for (guint i = 0; i < g_list_model_get_n_items(monitors); i++) {
+        GdkMonitor *mon = g_list_model_get_item(monitors, i);
+        scale = MAX(scale, gdk_monitor_get_scale_factor(mon));
+        g_object_unref(mon);
+    }
+    return SNI_ICON_SIZE * scale;
+}
+
+// The SNI spec sends ARGB32 in network byte order, so in memory a pixel is
+// the bytes A,R,G,B and we want R,G,B,A. Loaded as a native word this is a
+// rotate by one byte, right on little endian and left on big endian.
+static inline guint32 sni_pixel_rotate(guint32 p) {
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+    return (p >> 8) | (p << 24);
+#else
+    return (p << 8) | (p >> 24);
+#endif
+}
+
+static inline sni_v4u32 sni_pixel_rotate_v4(sni_v4u32 v) {
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+    return (v >> 8) | (v << 24);
+#else
+    return (v << 8) | (v >> 24);
+#endif
+}
+
+void sni_pixmap_argb_to_rgba(const guint8 *src, guint8 *dst, gsize n_pixels) {
+    gsize i = 0;
+
+    // GVariant data is not guaranteed to be 16 byte aligned, memcpy in and out
+    // of the vector registers, the compiler turns these into unaligned loads.
+    for (; i + 16 <= n_pixels; i += 16) {
+        sni_v4u32 a, b, c, d;
+        memcpy(&a, src + (i * 4), 16);
+        memcpy(&b, src + (i * 4) + 16, 16);
+        memcpy(&c, src + (i * 4) + 32, 16);
+        memcpy(&d, src + (i * 4) + 48, 16);
+        a = sni_pixel_rotate_v4(a);
+        b = sni_pixel_rotate_v4(b);
+        c = sni_pixel_rotate_v4(c);
+        d = sni_pixel_rotate_v4(d);
+        memcpy(dst + (i * 4), &a, 16);
+        memcpy(dst + (i * 4) + 16, &b, 16);
+        memcpy(dst + (i * 4) + 32, &c, 16);
+        memcpy(dst + (i * 4) + 48, &d, 16);
+    }
+    for (; i + 4 <= n_pixels; i += 4) {
+        sni_v4u32 a;
+        memcpy(&a, src + (i * 4), 16);
+        a = sni_pixel_rotate_v4(a);
+        memcpy(dst + (i * 4), &a, 16);
+    }
+    for (; i < n_pixels; i++) {
+        guint32 p;
+        memcpy(&p, src + (i * 4), 4);
+        p = sni_pixel_rotate(p);
+        memcpy(dst + (i * 4), &p, 4);
+    }
+}
+
+// FNV-1a over 64 bit words, good enough to tell animation frames apart and
+// cheap enough to run on every NewIcon signal.
+static guint64 sni_pixmap_hash(const guint8 *data, gsize size, gint width,
+                               gint height) {
+    guint64 h = 0xcbf29ce484222325ULL;
+    gsize i = 0;
+
+    h = (h ^ (guint64)width) * 0x100000001b3ULL;
+    h = (h ^ (guint64)height) * 0x100000001b3ULL;
+    for (; i + 8 <= size; i += 8) {
+        guint64 w;
+        memcpy(&w, data + i, 8);
+        h = (h ^ w) * 0x100000001b3ULL;
+    }
+    for (; i < size; i++) h = (h ^ data[i]) * 0x100000001b3ULL;
+    return h;
+}
+
+// Returns TRUE if a pixmap with the largest dimension `dim` is a better match
+// for `size` than the current best `best_dim`.
+//
+// The smallest pixmap at least `size` large wins, GTK only has to scale it
+// down. If every pixmap is smaller than `size` the largest one wins.
+static gboolean sni_pixmap_is_better(gint dim, gint best_dim, gint size) {
+    if (best_dim == 0) return TRUE;
+    if (dim >= size && best_dim < size) return TRUE;
+    if (dim >= size && best_dim >= size) return dim < best_dim;
+    if (dim < size && best_dim < size) return dim > best_dim;
+    return FALSE;
+}
+
+GdkTexture *sni_pixmap_cache_lookup(SNIPixmapCache *cache, GVariant *icon_data,
+                                    gint size) {
+    if (!icon_data) return NULL;
+    if (!g_variant_is_of_type(icon_data, G_VARIANT_TYPE("a(iiay)")))
+        return NULL;
+
+    GVariantIter it;
+    GVariant *val;
+    GVariant *best = NULL;
+    gint best_width = 0;
+    gint best_height = 0;
+    gint width;
+    gint height;
+
+    g_variant_iter_init(&it, icon_data);
+    while (g_variant_iter_next(&it, "(ii@ay)", &width, &height, &val)) {
+        /* Sanity check */
+        if (width <= 0 || height <= 0 ||
+            g_variant_get_size(val) != 4U * width * height ||
+            !sni_pixmap_is_better(MAX(width, height),
+                                  MAX(best_width, best_height), size)) {
+            g_variant_unref(val);
+            continue;
+        }
+        if (best) g_variant_unref(best);
+        best = val;
+        best_width = width;
+        best_height = height;
+    }
+    if (!best) return NULL;
+
+    gsize n = g_variant_get_size(best);
+    const guint8 *data = g_variant_get_data(best);
+    guint64 hash = sni_pixmap_hash(data, n, best_width, best_height);
+
+    for (guint i = 0; i < SNI_PIXMAP_CACHE_SIZE; i++) {
+        SNIPixmapCacheEntry *e = &cache->entries[i];
+        if (e->texture && e->hash == hash && e->width == best_width &&
+            e->height == best_height) {
+            g_variant_unref(best);
+            return g_object_ref(e->texture);
+        }
+    }
+
+    guint8 *rgba = g_malloc(n);
+    sni_pixmap_argb_to_rgba(data, rgba, (gsize)best_width * best_height);
+    g_variant_unref(best);
+
+    GBytes *bytes = g_bytes_new_take(rgba, n);
+    GdkTexture *texture =
+        gdk_memory_texture_new(best_width, best_height, GDK_MEMORY_R8G8B8A8,
+                               bytes, 4 * best_width);
+    g_bytes_unref(bytes);
+
+    SNIPixmapCacheEntry *e = &cache->entries[cache->next];
+    g_clear_object(&e->texture);
+    e->hash = hash;
+    e->width = best_width;
+    e->height = best_height;
+    e->texture = g_object_ref(texture);
+    cache->next = (cache->next + 1) % SNI_PIXMAP_CACHE_SIZE;
+
+    return texture;
+}
+
+void sni_pixmap_cache_clear(SNIPixmapCache *cache) {
+    for (guint i = 0; i < SNI_PIXMAP_CACHE_SIZE; i++)
+        g_clear_object(&cache->entries[i].texture);
+    cache->next = 0;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <adwaita.h>
+
+// The logical size, in pixels, a tray icon is displayed at in the panel.
+// Pixmaps are selected to be as close to this size (multiplied by the largest
+// monitor scale factor) as possible.
+#define SNI_ICON_SIZE 16
+
+// Number of converted frames kept per pixmap slot of a StatusNotifierItem.
+// Apps which animate their tray icon tend to cycle through a handful of
+// frames, once each frame is cached cycling through them costs only a hash.
+#define SNI_PIXMAP_CACHE_SIZE 8
+
+typedef struct SNIPixmapCacheEntry {
+    guint64 hash;
+    gint width;
+    gint height;
+    GdkTexture *texture;
+} SNIPixmapCacheEntry;
+
+// A small ring of converted pixmaps keyed by a hash of the raw ARGB32 data.
+typedef struct SNIPixmapCache {
+    SNIPixmapCacheEntry entries[SNI_PIXMAP_CACHE_SIZE];
+    guint next;
+} SNIPixmapCache;
+
+// Returns the target size in device pixels tray pixmaps are selected for.
+gint sni_pixmap_target_size();
+
+// Converts `n_pixels` ARGB32 (network byte order) pixels in `src` into RGBA
+// in `dst`. `src` and `dst` may alias.
+void sni_pixmap_argb_to_rgba(const guint8 *src, guint8 *dst, gsize n_pixels);
+
+// Selects the pixmap in `icon_data`, of type a(iiay), closest to `size`,
+// converts it to a GdkTexture and caches it in `cache`.
+//
+// Returns a new reference to the texture, or NULL if `icon_data` contains no
+// valid pixmaps. If an identical pixmap was converted before, the cached
+// texture is returned without any conversion.
+GdkTexture *sni_pixmap_cache_lookup(SNIPixmapCache *cache, GVariant *icon_data,
+                                    gint size);
+
+// Drops all textures held by `cache`.
+void sni_pixmap_cache_clear(SNIPixmapCache *cache);
@@ -0,0 +1,108 @@
+// Benchmarks tray icon pixmap conversion for 22px and 256px pixmaps: the
+// byte at a time swizzle way-shell used before sni_pixmap.c, the vector
+// kernel, and a sni_pixmap_cache_lookup() of a frame which is already cached.
+//
+//   make bench
+//   ./src/services/status_notifier_service/sni_pixmap_bench
+
+#include <adwaita.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sni_pixmap.h"
+
+// Total pixels converted per measurement, so both sizes run for a similar
+// amount of time.
+#define BENCH_PIXELS (64 * 1024 * 1024)
+
+// The conversion way-shell used before sni_pixmap.c, a copy of the pixmap
+// swizzled one byte at a time.
+static guint8 *bench_convert_reference(const guint8 *src, gsize n_pixels) {
+    guint8 *array = g_memdup2(src, n_pixels * 4);
+    for (gsize i = 0; i < n_pixels * 4; i += 4) {
+        guint8 alpha = array[i];
+        array[i] = array[i + 1];
+        array[i + 1] = array[i + 2];
+        array[i + 2] = array[i + 3];
+        array[i + 3] = alpha;
+    }
+    return array;
+}
+
+static guint8 *bench_convert_kernel(const guint8 *src, gsize n_pixels) {
+    guint8 *array = g_malloc(n_pixels * 4);
+    sni_pixmap_argb_to_rgba(src, array, n_pixels);
+    return array;
+}
+
+// Returns the average time, in nanoseconds, `convert` takes for one pixmap.
+static gdouble bench_run(guint8 *(*convert)(const guint8 *, gsize),
+                         const guint8 *src, gsize n_pixels) {
+    guint iterations = MAX(1, BENCH_PIXELS / n_pixels);
+    volatile guint8 sink = 0;
+
+    gint64 start = g_get_monotonic_time();
+    for (guint i = 0; i < iterations; i++) {
+        guint8 *out = convert(src, n_pixels);
+        sink ^= out[n_pixels * 2];
+        g_free(out);
+    }
+    return (gdouble)(g_get_monotonic_time() - start) * 1000 / iterations;
+}
+
+// Returns the average time, in nanoseconds, a cache hit for `icon_data`
+// takes, including the hash of the raw pixmap.
+static gdouble bench_run_cache_hit(GVariant *icon_data, gint size,
+                                   gsize n_pixels) {
+    guint iterations = MAX(1, BENCH_PIXELS / n_pixels);
+    SNIPixmapCache cache = {0};
+
+    g_object_unref(sni_pixmap_cache_lookup(&cache, icon_data, size));
+
+    gint64 start = g_get_monotonic_time();
+    for (guint i = 0; i < iterations; i++)
+        g_object_unref(sni_pixmap_cache_lookup(&cache, icon_data, size));
+    gdouble ns = (gdouble)(g_get_monotonic_time() - start) * 1000 / iterations;
+
+    sni_pixmap_cache_clear(&cache);
+    return ns;
+}
+
+static void bench_size(gint size) {
+    gsize n_pixels = (gsize)size * size;
+    guint8 *src = g_malloc(n_pixels * 4);
+    for (gsize i = 0; i < n_pixels * 4; i++) src[i] = g_random_int();
+
+    // the kernel must produce exactly what the reference does.
+    guint8 *want = bench_convert_reference(src, n_pixels);
+    guint8 *got = bench_convert_kernel(src, n_pixels);
+    if (memcmp(want, got, n_pixels * 4) != 0)
+        g_error("sni_pixmap_bench: conversion mismatch at %dpx", size);
+    g_free(want);
+    g_free(got);
+
+    GVariantBuilder builder;
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a(iiay)"));
+    g_variant_builder_add(
+        &builder, "(ii@ay)", size, size,
+        g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE, src, n_pixels * 4, 1));
+    GVariant *icon_data = g_variant_ref_sink(g_variant_builder_end(&builder));
+
+    gdouble reference = bench_run(bench_convert_reference, src, n_pixels);
+    gdouble kernel = bench_run(bench_convert_kernel, src, n_pixels);
+    gdouble hit = bench_run_cache_hit(icon_data, size, n_pixels);
+
+    printf("%dx%d pixmap\n", size, size);
+    printf("  byte swizzle:  %10.0f ns\n", reference);
+    printf("  vector kernel: %10.0f ns (%.1fx)\n", kernel, reference / kernel);
+    printf("  cache hit:     %10.0f ns (%.1fx)\n", hit, reference / hit);
+
+    g_variant_unref(icon_data);
+    g_free(src);
+}
+
+int main() {
+    bench_size(22);
+    bench_size(256);
+    return 0;
+}
@@ -168,77 +168,102 @@ static void set_item_actions(struct StatusNotifierItem *item,
                                     G_N_ELEMENTS(action_entries), self);
 }
 
-static void update_menu_layout(DbusDbusmenu *menu, StatusNotifierItem *item) {
-    g_debug("status_notifier_service.c:update_menu_layout() called");
-    GVariant *layout;
-    guint rev;
+static void on_get_layout_cb(GObject *source_object, GAsyncResult *res,
+                             gchar *bus_name);
+
+static void status_notifier_item_fetch_menu(StatusNotifierItem *item) {
+    if (!item->menu_proxy || item->menu_fetching) return;
+
+    g_debug("status_notifier_service.c:status_notifier_item_fetch_menu() %s",
+            item->bus_name);
+
+    item->menu_fetching = true;
+    item->menu_stale = false;
+    dbus_dbusmenu_call_get_layout(item->menu_proxy, 0, SNI_MENU_LAYOUT_DEPTH,
+                                  property_names, NULL,
+                                  (GAsyncReadyCallback)on_get_layout_cb,
+                                  g_strdup(item->bus_name));
+}
+
+// async callbacks are keyed by bus name, the item may be gone by the time
+// they run.
+static void on_get_layout_cb(GObject *source_object, GAsyncResult *res,
+                             gchar *bus_name) {
+    StatusNotifierService *self = status_notifier_service_get_global();
     GError *error = NULL;
-    dbus_dbusmenu_call_get_layout_sync(item->menu_proxy, 0, -1, property_names,
-                                       &rev, &layout, NULL, &error);
-    if (error) {
-        g_critical(
-            "status_notifier_service.c:update_menu_layout() failed to get "
+    GVariant *layout = NULL;
+    guint rev = 0;
+
+    g_debug("status_notifier_service.c:on_get_layout_cb() called");
+
+    gboolean ok = dbus_dbusmenu_call_get_layout_finish(
+        DBUS_DBUSMENU(source_object), &rev, &layout, res, &error);
+
+    StatusNotifierItem *item = g_hash_table_lookup(self->items, bus_name);
+    g_free(bus_name);
+    if (item) item->menu_fetching = false;
+
+    if (!ok) {
+        g_warning(
+            "status_notifier_service.c:on_get_layout_cb() failed to get "
             "layout: %s",
             error->message);
+        g_error_free(error);
+        // we still don't have this layout, retry on the next AboutToShow.
+        if (item) item->menu_stale = true;
+        return;
+    }
+    if (!item) {
+        g_variant_unref(layout);
         return;
     }
 
+    item->menu_revision = rev;
+
+    g_signal_emit(self, signals[status_notifier_item_menu_will_update], 0,
+                  item);
     libdbusmenu_parse_layout(layout, NULL, item);
+    g_variant_unref(layout);
+    g_signal_emit(self, signals[status_notifier_item_menu_updated], 0, item);
+
+    // the layout changed again while we were fetching it.
+    if (item->menu_stale && item->menu_visible)
+        status_notifier_item_fetch_menu(item);
+}
+
+static void status_notifier_item_invalidate_menu(StatusNotifierItem *item) {
+    item->menu_stale = true;
+    // hidden menus are fetched the next time they are shown.
+    if (item->menu_visible) status_notifier_item_fetch_menu(item);
 }
 
 static void on_property_update(DbusDbusmenu *menu, GVariant *arg_1,
                                GVariant *arg_2, StatusNotifierItem *item) {
     g_debug("status_notifier_service.c:on_property_update() called");
-    g_signal_emit(item, signals[status_notifier_item_menu_will_update], 0,
-                  item);
-    update_menu_layout(menu, item);
-    StatusNotifierService *s = status_notifier_service_get_global();
-    g_signal_emit(s, signals[status_notifier_item_menu_updated], 0, item);
+    status_notifier_item_invalidate_menu(item);
 }
 
 static void on_menu_layout_update(DbusDbusmenu *menu, guint arg_1, gint arg_2,
                                   StatusNotifierItem *item) {
-    g_debug("status_notifier_service.c:on_menu_layout_update() called");
-    g_signal_emit(item, signals[status_notifier_item_menu_will_update], 0,
-                  item);
-    update_menu_layout(menu, item);
-    StatusNotifierService *s = status_notifier_service_get_global();
-    g_signal_emit(s, signals[status_notifier_item_menu_updated], 0, item);
-}
-
-static void dbus_menu_parse_gmenu(StatusNotifierItem *item,
-                                  StatusNotifierService *self) {
-    GError *error = NULL;
-    guint rev;
-    GVariant *layout;
-
     g_debug(
-        "status_notifier_service.c:dbus_menu_extract_g_menu() proxy name: %s",
-        g_dbus_proxy_get_name(G_DBUS_PROXY(item->menu_proxy)));
-
-    dbus_dbusmenu_call_get_layout_sync(item->menu_proxy, 0, -1, property_names,
-                                       &rev, &layout, NULL, &error);
-    if (error) {
-        g_critical(
-            "status_notifier_service.c:dbus_menu_extract_g_menu() failed to "
-            "get layout: %s",
-            error->message);
-        return;
-    }
-
-    libdbusmenu_parse_layout(layout, NULL, item);
+        "status_notifier_service.c:on_menu_layout_update() revision %u, "
+        "have %u",
+        arg_1, item->menu_revision);
 
-    set_item_actions(item, self);
+    // menu_model was already built from this revision, or a newer one.
+    if (arg_1 != 0 && arg_1 <= item->menu_revision) return;
 
-    g_variant_unref(layout);
-};
+    status_notifier_item_invalidate_menu(item);
+}
 
 static void status_notifier_item_update(StatusNotifierItem *self,
                                         GVariant *props);
 
+static void status_notifier_item_refresh_properties(StatusNotifierItem *item);
+
 static void on_item_property_update_cb(GObject *source_object,
-                                       GAsyncResult *res, gpointer data) {
-    StatusNotifierItem *item = (StatusNotifierItem *)data;
+                                       GAsyncResult *res, gchar *bus_name) {
+    StatusNotifierService *self = status_notifier_service_get_global();
     GVariant *properties = NULL;
 
     g_debug("status_notifier_service.c:on_item_property_update_cb() called");
@@ -246,11 +271,21 @@ static void on_item_property_update_cb(GObject *source_object,
     GError *error = NULL;
     properties =
         g_dbus_proxy_call_finish(G_DBUS_PROXY(source_object), res, &error);
+
+    StatusNotifierItem *item = g_hash_table_lookup(self->items, bus_name);
+    g_free(bus_name);
+    if (item) item->props_fetching = false;
+
     if (error) {
         g_critical(
             "status_notifier_service.c:on_item_property_update_cb() failed to "
             "get properties: %s",
             error->message);
+        g_error_free(error);
+        return;
+    }
+    if (!item) {
+        g_variant_unref(properties);
         return;
     }
 
@@ -260,28 +295,56 @@ static void on_item_property_update_cb(GObject *source_object,
 
     status_notifier_item_update(item, properties);
     g_variant_unref(properties);
+
+    // invalidated again while the call was in flight.
+    if (item->props_stale) status_notifier_item_refresh_properties(item);
+}
+
+static void status_notifier_item_refresh_properties(StatusNotifierItem *item) {
+    // on_item_property_update_cb refreshes again if still stale.
+    if (item->props_fetching) return;
+
+    item->props_stale = false;
+    item->props_fetching = true;
+
+    GVariant *argument = g_variant_new("(s)", "org.kde.StatusNotifierItem");
+    g_dbus_proxy_call(G_DBUS_PROXY(item->proxy),
+                      "org.freedesktop.DBus.Properties.GetAll", argument,
+                      G_DBUS_CALL_FLAGS_NONE, SNI_CALL_TIMEOUT_MS, NULL,
+                      (GAsyncReadyCallback)on_item_property_update_cb,
+                      g_strdup(item->bus_name));
+}
+
+static gboolean on_item_properties_flush(StatusNotifierItem *item) {
+    item->props_flush_id = 0;
+    status_notifier_item_refresh_properties(item);
+    return G_SOURCE_REMOVE;
 }
 
-// we just use this as an opportunity to get all propeties for refresh, the
-// signals for a StatusNotifierItem are pretty coarse anyway...
-//
-// TODO: tune this when we do the next performance pass...
+// the New* signals carry no values, so they just invalidate our cached
+// properties. items tend to emit several of them at once, e.g. NewIcon and
+// NewTitle, so the refresh is deferred to idle and done with a single GetAll.
 static void on_item_property_update(DbusItemV0Gen *proxy,
                                     StatusNotifierItem *item) {
     g_debug("status_notifier_service.c:on_item_property_update() called");
-    GVariant *argument = g_variant_new("(s)", "org.kde.StatusNotifierItem");
-    g_dbus_proxy_call(G_DBUS_PROXY(item->proxy),
-                      "org.freedesktop.DBus.Properties.GetAll", argument, 0,
-                      300, NULL, on_item_property_update_cb, item);
+    item->props_stale = true;
+    if (item->props_fetching || item->props_flush_id) return;
+    item->props_flush_id =
+        g_idle_add((GSourceFunc)on_item_properties_flush, item);
 }
 
+// NewStatus is the one signal carrying its value, no need to fetch anything.
 static void on_item_property_status_update(DbusItemV0Gen *proxy, gchar *status,
                                            StatusNotifierItem *item) {
-    g_debug("status_notifier_service.c:on_item_property_update() called");
-    GVariant *argument = g_variant_new("(s)", "org.kde.StatusNotifierItem");
-    g_dbus_proxy_call(G_DBUS_PROXY(item->proxy),
-                      "org.freedesktop.DBus.Properties.GetAll", argument, 0,
-                      300, NULL, on_item_property_update_cb, item);
+    g_debug(
+        "status_notifier_service.c:on_item_property_status_update() called");
+    if (g_strcmp0(item->status, status) == 0) return;
+
+    g_free(item->status);
+    item->status = g_strdup(status);
+
+    StatusNotifierService *s = status_notifier_service_get_global();
+    g_signal_emit(s, signals[status_notifier_item_properties_changed], 0, item);
 }
 
 static void on_handle_menu_async_cb(GObject *source_object, GAsyncResult *res,
@@ -303,10 +366,21 @@ static void on_handle_menu_async_cb(GObject *source_object, GAsyncResult *res,
     StatusNotifierItem *item = g_hash_table_lookup(
         self->items, g_dbus_proxy_get_name(G_DBUS_PROXY(proxy)));
 
-    if (!item) return;
+    if (!item) {
+        g_object_unref(proxy);
+        return;
+    }
 
+    // bounds AboutToShow, GetLayout and Event calls, which all use the
+    // proxy's default timeout.
+    g_dbus_proxy_set_default_timeout(G_DBUS_PROXY(proxy), SNI_CALL_TIMEOUT_MS);
+
+    // the layout is not fetched until the menu is first shown, hand out an
+    // empty menu until then.
     item->menu_proxy = proxy;
-    dbus_menu_parse_gmenu(item, self);
+    item->menu_model = g_menu_new();
+    item->menu_stale = true;
+    set_item_actions(item, self);
 
     g_signal_connect(item->menu_proxy, "layout-updated",
                      G_CALLBACK(on_menu_layout_update), item);
@@ -381,7 +455,10 @@ static void on_handle_register_async_cb(GObject *source_object,
             item->bus_name, item->obj_name,
             status_notifier_item_get_menu(item));
         g_hash_table_insert(self->items, item->bus_name, item);
-        dbus_dbusmenu_proxy_new(self->conn, 0, item->bus_name,
+        // none of the menu's own properties are used, skip fetching them.
+        dbus_dbusmenu_proxy_new(self->conn,
+                                G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES,
+                                item->bus_name,
                                 status_notifier_item_get_menu(item), NULL,
                                 on_handle_menu_async_cb, self);
         return;
@@ -581,58 +658,6 @@ int status_notifier_service_global_init() {
 // NotifierItem Methods		//
 //							//
 
-// ripped from Waybar, thank you!!
-GdkPixbuf *pixbuf_from_icon_data(GVariant *icon_data) {
-    if (!icon_data) {
-        return NULL;
-    }
-
-    GVariantIter *it;
-    g_variant_get(icon_data, "a(iiay)", &it);
-    if (!it) return NULL;
-
-    GVariant *val;
-    gint lwidth = 0;
-    gint lheight = 0;
-    gint width;
-    gint height;
-    guchar *array = NULL;
-    while (g_variant_iter_loop(it, "(ii@ay)", &width, &height, &val)) {
-        if (width > 0 && height > 0 && val &&
-            width * height > lwidth * lheight) {
-            int size = g_variant_get_size(val);
-            /* Sanity check */
-            if (size == 4U * width * height) {
-                /* Find the largest image */
-                gconstpointer data = g_variant_get_data(val);
-                if (data) {
-                    if (array) {
-                        g_free(array);
-                    }
-                    array = g_memdup2(data, size);
-                    lwidth = width;
-                    lheight = height;
-                }
-            }
-        }
-    }
-    g_variant_iter_free(it);
-    if (array) {
-        /* argb to rgba */
-        for (uint32_t i = 0; i < 4U * lwidth * lheight; i += 4) {
-            guchar alpha = array[i];
-            array[i] = array[i + 1];
-            array[i + 1] = array[i + 2];
-            array[i + 2] = array[i + 3];
-            array[i + 3] = alpha;
-        }
-        return gdk_pixbuf_new_from_data(array, GDK_COLORSPACE_RGB, TRUE, 8,
-                                        lwidth, lheight, 4 * lwidth, NULL,
-                                        NULL);
-    }
-    return NULL;
-}
-
 const gchar *status_notifier_item_get_category(StatusNotifierItem *self) {
     return self->category;
 }
@@ -651,14 +676,14 @@ const int status_notifier_item_get_window_id(StatusNotifierItem *self) {
 const gchar *status_notifier_item_get_icon_name(StatusNotifierItem *self) {
     return self->icon_name;
 }
-GdkPixbuf *status_notifier_item_get_icon_pixmap(StatusNotifierItem *self) {
+GdkTexture *status_notifier_item_get_icon_pixmap(StatusNotifierItem *self) {
     return self->icon_pixmap;
 }
 const gchar *status_notifier_item_get_overlay_icon_name(
     StatusNotifierItem *self) {
     return self->overlay_icon_name;
 }
-GdkPixbuf *status_notifier_item_get_overlay_icon_pixmap(
+GdkTexture *status_notifier_item_get_overlay_icon_pixmap(
     StatusNotifierItem *self) {
     return self->overlay_icon_pixmap;
 }
@@ -666,7 +691,7 @@ const gchar *status_notifier_item_get_attention_icon_name(
     StatusNotifierItem *self) {
     return self->attention_icon_name;
 }
-GdkPixbuf *status_notifier_item_get_attention_icon_pixmap(
+GdkTexture *status_notifier_item_get_attention_icon_pixmap(
     StatusNotifierItem *self) {
     return self->attention_icon_pixmap;
 }
@@ -686,31 +711,104 @@ DbusItemV0Gen *status_notifier_item_get_proxy(StatusNotifierItem *self) {
     return self->proxy;
 }
 
-void status_notifier_item_about_to_show(StatusNotifierItem *self,
-                                        gint32 menu_item_id) {
-    g_debug(
-        "status_notifier_service.c:status_notifier_item_about_to_show() "
-        "called");
-    if (!self) {
-        return;
-    }
+static void status_notifier_item_call(StatusNotifierItem *self,
+                                      const gchar *method, GVariant *params,
+                                      GAsyncReadyCallback callback,
+                                      gpointer user_data) {
+    g_debug("status_notifier_service.c:status_notifier_item_call() %s.%s",
+            self->bus_name, method);
+
+    // the generated dbus_item_v0_gen_call_* functions always use the proxy's
+    // default timeout, go through the proxy directly to bound the call.
+    g_dbus_proxy_call(G_DBUS_PROXY(self->proxy), method, params,
+                      G_DBUS_CALL_FLAGS_NONE, SNI_CALL_TIMEOUT_MS, NULL,
+                      callback, user_data);
+}
+
+void status_notifier_item_activate(StatusNotifierItem *self, gint x, gint y,
+                                   GAsyncReadyCallback callback,
+                                   gpointer user_data) {
+    status_notifier_item_call(self, "Activate", g_variant_new("(ii)", x, y),
+                              callback, user_data);
+}
+
+void status_notifier_item_secondary_activate(StatusNotifierItem *self, gint x,
+                                             gint y,
+                                             GAsyncReadyCallback callback,
+                                             gpointer user_data) {
+    status_notifier_item_call(self, "SecondaryActivate",
+                              g_variant_new("(ii)", x, y), callback,
+                              user_data);
+}
+
+void status_notifier_item_context_menu(StatusNotifierItem *self, gint x,
+                                       gint y, GAsyncReadyCallback callback,
+                                       gpointer user_data) {
+    status_notifier_item_call(self, "ContextMenu",
+                              g_variant_new("(ii)", x, y), callback,
+                              user_data);
+}
+
+void status_notifier_item_scroll(StatusNotifierItem *self, gint delta,
+                                 const gchar *orientation,
+                                 GAsyncReadyCallback callback,
+                                 gpointer user_data) {
+    status_notifier_item_call(self, "Scroll",
+                              g_variant_new("(is)", delta, orientation),
+                              callback, user_data);
+}
+
+gboolean status_notifier_item_call_finish(GObject *source, GAsyncResult *res,
+                                          GError **error) {
+    GVariant *ret = g_dbus_proxy_call_finish(G_DBUS_PROXY(source), res, error);
+    if (!ret) return false;
+    g_variant_unref(ret);
+    return true;
+}
 
+static void on_about_to_show_cb(GObject *source_object, GAsyncResult *res,
+                                gchar *bus_name) {
+    StatusNotifierService *self = status_notifier_service_get_global();
     GError *error = NULL;
     gboolean need_update = FALSE;
 
-    dbus_dbusmenu_call_about_to_show_sync(self->menu_proxy, menu_item_id,
-                                          &need_update, NULL, &error);
-    if (error) {
-        g_warning(
-            "status_notifier_service.c:on_menu_about_to_show() failed to send "
+    // not every item implements AboutToShow, a failure still fetches the
+    // layout below if it's stale.
+    if (!dbus_dbusmenu_call_about_to_show_finish(
+            DBUS_DBUSMENU(source_object), &need_update, res, &error)) {
+        g_debug(
+            "status_notifier_service.c:on_about_to_show_cb() failed to send "
             "event: %s",
             error->message);
         g_error_free(error);
     }
 
-    if (need_update) {
-        update_menu_layout(self->menu_proxy, self);
+    StatusNotifierItem *item = g_hash_table_lookup(self->items, bus_name);
+    g_free(bus_name);
+    if (!item || !item->menu_visible) return;
+
+    if (need_update) item->menu_stale = true;
+    if (item->menu_stale) status_notifier_item_fetch_menu(item);
+}
+
+void status_notifier_item_about_to_show(StatusNotifierItem *self,
+                                        gint32 menu_item_id) {
+    g_debug(
+        "status_notifier_service.c:status_notifier_item_about_to_show() "
+        "called");
+    if (!self || !self->menu_proxy) {
+        return;
     }
+
+    self->menu_visible = true;
+    dbus_dbusmenu_call_about_to_show(self->menu_proxy, menu_item_id, NULL,
+                                     (GAsyncReadyCallback)on_about_to_show_cb,
+                                     g_strdup(self->bus_name));
+}
+
+void status_notifier_item_menu_hidden(StatusNotifierItem *self) {
+    if (!self) return;
+    self->menu_visible = false;
 }
 
 GdkPixbuf *icon_pixbuf_from_icon_theme(gchar *icon_name,
@@ -795,7 +893,8 @@ static void status_notifier_item_update(StatusNotifierItem *self,
         // IconPixmap
         else if (g_strcmp0(key, "IconPixmap") == 0) {
             if (self->icon_pixmap) g_object_unref(self->icon_pixmap);
-            self->icon_pixmap = pixbuf_from_icon_data(value);
+            self->icon_pixmap = sni_pixmap_cache_lookup(
+                &self->icon_pixmap_cache, value, sni_pixmap_target_size());
         }
         // OverlayIconName
         else if (g_strcmp0(key, "OverlayIconName") == 0) {
@@ -806,7 +905,9 @@ static void status_notifier_item_update(StatusNotifierItem *self,
         else if (g_strcmp0(key, "OverlayIconPixmap") == 0) {
             if (self->overlay_icon_pixmap)
                 g_object_unref(self->overlay_icon_pixmap);
-            self->overlay_icon_pixmap = pixbuf_from_icon_data(value);
+            self->overlay_icon_pixmap =
+                sni_pixmap_cache_lookup(&self->overlay_icon_pixmap_cache,
+                                        value, sni_pixmap_target_size());
         }
         // AttentionIconName
         else if (g_strcmp0(key, "AttentionIconName") == 0) {
@@ -817,7 +918,9 @@ static void status_notifier_item_update(StatusNotifierItem *self,
         else if (g_strcmp0(key, "AttentionIconPixmap") == 0) {
             if (self->attention_icon_pixmap)
                 g_object_unref(self->attention_icon_pixmap);
-            self->attention_icon_pixmap = pixbuf_from_icon_data(value);
+            self->attention_icon_pixmap =
+                sni_pixmap_cache_lookup(&self->attention_icon_pixmap_cache,
+                                        value, sni_pixmap_target_size());
         }
         // AttentionMovieName
         else if (g_strcmp0(key, "AttentionMovieName") == 0) {
@@ -857,17 +960,22 @@ void *status_notifier_item_init(StatusNotifierItem *self,
     self->title = g_strdup(dbus_item_v0_gen_get_title(proxy));
     self->status = g_strdup(dbus_item_v0_gen_get_status(proxy));
     self->window_id = dbus_item_v0_gen_get_window_id(proxy);
+    gint icon_size = sni_pixmap_target_size();
     self->icon_name = g_strdup(dbus_item_v0_gen_get_icon_name(proxy));
     self->icon_pixmap =
-        pixbuf_from_icon_data(dbus_item_v0_gen_get_icon_pixmap(proxy));
+        sni_pixmap_cache_lookup(&self->icon_pixmap_cache,
+                                dbus_item_v0_gen_get_icon_pixmap(proxy),
+                                icon_size);
     self->overlay_icon_name =
         g_strdup(dbus_item_v0_gen_get_overlay_icon_name(proxy));
-    self->overlay_icon_pixmap =
-        pixbuf_from_icon_data(dbus_item_v0_gen_get_icon_pixmap(proxy));
+    self->overlay_icon_pixmap = sni_pixmap_cache_lookup(
+        &self->overlay_icon_pixmap_cache,
+        dbus_item_v0_gen_get_overlay_icon_pixmap(proxy), icon_size);
     self->attention_icon_name =
         g_strdup(dbus_item_v0_gen_get_attention_icon_name(proxy));
-    self->attention_icon_pixmap = pixbuf_from_icon_data(
-        dbus_item_v0_gen_get_attention_icon_pixmap(proxy));
+    self->attention_icon_pixmap = sni_pixmap_cache_lookup(
+        &self->attention_icon_pixmap_cache,
+        dbus_item_v0_gen_get_attention_icon_pixmap(proxy), icon_size);
     self->attention_movie_name =
         g_strdup(dbus_item_v0_gen_get_attention_movie_name(proxy));
 
@@ -884,16 +992,16 @@ void *status_notifier_item_init(StatusNotifierItem *self,
 void status_notifier_item_free(StatusNotifierItem *self) {
     g_debug("status_notifier_service.c:status_notifier_item_free() called");
 
+    g_clear_handle_id(&self->props_flush_id, g_source_remove);
+
     // kill signals related to the item
     if (self->menu_proxy) {
-        g_signal_handlers_disconnect_by_func(self->menu_proxy,
-                                             on_menu_layout_update, self);
+        g_signal_handlers_disconnect_by_data(self->menu_proxy, self);
         g_object_unref(self->menu_proxy);
-        g_object_unref(self->menu_model);
+        g_clear_object(&self->menu_model);
     }
     if (self->proxy) {
-        g_signal_handlers_disconnect_by_func(self->proxy,
-                                             on_item_property_update, self);
+        g_signal_handlers_disconnect_by_data(self->proxy, self);
         g_clear_object(&self->proxy);
     }
 
@@ -906,6 +1014,9 @@ void status_notifier_item_free(StatusNotifierItem *self) {
     if (self->overlay_icon_pixmap) g_object_unref(self->overlay_icon_pixmap);
     if (self->attention_icon_pixmap)
         g_object_unref(self->attention_icon_pixmap);
+    sni_pixmap_cache_clear(&self->icon_pixmap_cache);
+    sni_pixmap_cache_clear(&self->overlay_icon_pixmap_cache);
+    sni_pixmap_cache_clear(&self->attention_icon_pixmap_cache);
     if (self->category) g_free(self->category);
     if (self->id) g_free(self->id);
     if (self->title) g_free(self->title);
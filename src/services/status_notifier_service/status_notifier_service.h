@@ -3,12 +3,23 @@
 #include <adwaita.h>
 
 #include "dbusmenu_dbus.h"
+#include "sni_pixmap.h"
 #include "status_notifier_item_dbus.h"
 
 #define SNI_GACTION_PREFIX "sni"
 #define SNI_GRACTION_ITEM_CLICKED "sni.item-clicked"
 #define SNI_GRACTION_MENU_ABOUT_TO_SHOW "sni.about-to-show"
 
+// Timeout, in milliseconds, for method calls on a StatusNotifierItem. Items
+// are ordinary applications and may be hung, calls must never wait on them
+// for the default D-Bus timeout.
+#define SNI_CALL_TIMEOUT_MS 2000
+
+// Depth of the menu layout requested from an item's com.canonical.dbusmenu
+// when its menu is opened. Bounds the size of the reply for items exporting
+// deep menu trees, submenus below this depth are not shown.
+#define SNI_MENU_LAYOUT_DEPTH 4
+
 typedef struct StatusNotifierItem {
     DbusItemV0Gen *proxy;
     DbusDbusmenu *menu_proxy;
@@ -28,20 +39,43 @@ typedef struct StatusNotifierItem {
     GdkPixbuf *icon_pixmap_from_theme;
     gchar *icon_theme_path;
     gchar *icon_name;
-    GdkPixbuf *icon_pixmap;
+    GdkTexture *icon_pixmap;
+    SNIPixmapCache icon_pixmap_cache;
 
     gchar *overlay_icon_name;
-    GdkPixbuf *overlay_icon_pixmap;
+    GdkTexture *overlay_icon_pixmap;
+    SNIPixmapCache overlay_icon_pixmap_cache;
 
     gchar *attention_icon_name;
-    GdkPixbuf *attention_icon_pixmap;
+    GdkTexture *attention_icon_pixmap;
+    SNIPixmapCache attention_icon_pixmap_cache;
     gchar *attention_movie_name;
+
+    // menu_model starts out empty and is only fetched while the menu is
+    // shown. menu_revision is the layout revision it was built from and
+    // menu_stale is set when the item reports a newer layout.
+    guint menu_revision;
+    gboolean menu_stale;
+    gboolean menu_fetching;
+    gboolean menu_visible;
+
+    // properties above are cached until one of the item's New* signals
+    // invalidates them, invalidations are coalesced into a single GetAll.
+    gboolean props_stale;
+    gboolean props_fetching;
+    guint props_flush_id;
 } StatusNotifierItem;
 
+// Called when the item's menu is shown, sends AboutToShow and fetches the
+// menu layout if it's stale. status-notifier-item-menu-updated is emitted
+// once the new layout is in menu_model.
 void status_notifier_item_about_to_show(StatusNotifierItem *self,
                                         gint32 menu_item_id);
 
-GdkPixbuf *pixbuf_from_icon_data(GVariant *icon_data);
+// Called when the item's menu is hidden, layout updates are no longer fetched
+// until it's shown again.
+void status_notifier_item_menu_hidden(StatusNotifierItem *self);
+
 void *status_notifier_item_init(StatusNotifierItem *self, DbusItemV0Gen *proxy);
 const gchar *status_notifier_item_get_category(StatusNotifierItem *self);
 const gchar *status_notifier_item_get_id(StatusNotifierItem *self);
@@ -49,14 +83,14 @@ const gchar *status_notifier_item_get_title(StatusNotifierItem *self);
 const gchar *status_notifier_item_get_status(StatusNotifierItem *self);
 const int status_notifier_item_get_window_id(StatusNotifierItem *self);
 const gchar *status_notifier_item_get_icon_name(StatusNotifierItem *self);
-GdkPixbuf *status_notifier_item_get_icon_pixmap(StatusNotifierItem *self);
+GdkTexture *status_notifier_item_get_icon_pixmap(StatusNotifierItem *self);
 const gchar *status_notifier_item_get_overlay_icon_name(
     StatusNotifierItem *self);
-GdkPixbuf *status_notifier_item_get_overlay_icon_pixmap(
+GdkTexture *status_notifier_item_get_overlay_icon_pixmap(
     StatusNotifierItem *self);
 const gchar *status_notifier_item_get_attention_icon_name(
     StatusNotifierItem *self);
-GdkPixbuf *status_notifier_item_get_attention_icon_pixmap(
+GdkTexture *status_notifier_item_get_attention_icon_pixmap(
     StatusNotifierItem *self);
 const gchar *status_notifier_item_get_attention_movie_name(
     StatusNotifierItem *self);
@@ -64,6 +98,28 @@ const gchar *status_notifier_item_get_attention_movie_name(
 const gboolean status_notifier_item_get_item_is_menu(StatusNotifierItem *self);
 const gchar *status_notifier_item_get_menu(StatusNotifierItem *self);
 DbusItemV0Gen *status_notifier_item_get_proxy(StatusNotifierItem *self);
+
+// Asynchronous StatusNotifierItem methods, all are issued with
+// SNI_CALL_TIMEOUT_MS. `callback` may be NULL, otherwise it should call
+// status_notifier_item_call_finish with the source object it is handed.
+// The item may be freed before `callback` runs.
+void status_notifier_item_activate(StatusNotifierItem *self, gint x, gint y,
+                                   GAsyncReadyCallback callback,
+                                   gpointer user_data);
+void status_notifier_item_secondary_activate(StatusNotifierItem *self, gint x,
+                                             gint y,
+                                             GAsyncReadyCallback callback,
+                                             gpointer user_data);
+void status_notifier_item_context_menu(StatusNotifierItem *self, gint x,
+                                       gint y, GAsyncReadyCallback callback,
+                                       gpointer user_data);
+// `orientation` is either "vertical" or "horizontal".
+void status_notifier_item_scroll(StatusNotifierItem *self, gint delta,
+                                 const gchar *orientation,
+                                 GAsyncReadyCallback callback,
+                                 gpointer user_data);
+gboolean status_notifier_item_call_finish(GObject *source, GAsyncResult *res,
+                                          GError **error);
 void status_notifier_item_free(StatusNotifierItem *self);
 
 G_BEGIN_DECLS
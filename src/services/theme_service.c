@@ -21,13 +21,29 @@ struct _ThemeService {
     GObject parent_instance;
     GSettings *setting;
     gboolean light_theme;
-    GtkCssProvider *provider;
+    // both themes are parsed once and kept resident, switching themes swaps
+    // which one is attached to the display.
+    GtkCssProvider *light_provider;
+    GtkCssProvider *dark_provider;
+    // provider currently attached to the display, NULL before the first
+    // theme is applied.
+    GtkCssProvider *active;
+    // watch the local theme overrides, reparsing only the theme which changed.
+    GFileMonitor *light_monitor;
+    GFileMonitor *dark_monitor;
 };
 static guint signals[signals_n] = {0};
 G_DEFINE_TYPE(ThemeService, theme_service, G_TYPE_OBJECT);
 
 // Stub out GObject's dispose, finalize, class_init, and init methods
 static void theme_service_dispose(GObject *gobject) {
+    ThemeService *self = THEME_SERVICE(gobject);
+
+    g_clear_object(&self->light_monitor);
+    g_clear_object(&self->dark_monitor);
+    g_clear_object(&self->light_provider);
+    g_clear_object(&self->dark_provider);
+
     // Chain-up
     G_OBJECT_CLASS(theme_service_parent_class)->dispose(gobject);
 };
@@ -72,67 +88,105 @@ static void theme_service_class_init(ThemeServiceClass *klass) {
         NULL, NULL, G_TYPE_NONE, 1, G_TYPE_INT);
 };
 
-static bool local_light_theme_present() {
-    const char *conf_dir = g_get_user_config_dir();
-    char *theme_path =
-        g_build_filename(conf_dir, CONFIG_DIR, LIGHT_THEME_CSS, NULL);
-    if (g_file_test(theme_path, G_FILE_TEST_EXISTS)) {
-        return true;
-    }
-    return false;
+static char *local_theme_path(enum ThemeServiceTheme theme) {
+    return g_build_filename(g_get_user_config_dir(), CONFIG_DIR,
+                            theme == THEME_LIGHT ? LIGHT_THEME_CSS
+                                                 : DARK_THEME_CSS,
+                            NULL);
 }
 
-static gboolean local_dark_theme_present() {
-    const char *conf_dir = g_get_user_config_dir();
-    char *theme_path =
-        g_build_filename(conf_dir, CONFIG_DIR, DARK_THEME_CSS, NULL);
-    if (g_file_test(theme_path, G_FILE_TEST_EXISTS)) {
-        return true;
-    }
-    return false;
+static GtkCssProvider *theme_provider(ThemeService *self,
+                                      enum ThemeServiceTheme theme) {
+    return theme == THEME_LIGHT ? self->light_provider : self->dark_provider;
 }
 
+// Parses `theme` into its resident provider, preferring a local override in
+// the config dir over the bundled resource.
 static void load_theme(ThemeService *self, enum ThemeServiceTheme theme) {
-    if (theme == THEME_LIGHT) {
-        if (local_light_theme_present()) {
-            const char *conf_dir = g_get_user_config_dir();
-            char *theme_path =
-                g_build_filename(conf_dir, CONFIG_DIR, LIGHT_THEME_CSS, NULL);
-            gtk_css_provider_load_from_file(self->provider,
-                                            g_file_new_for_path(theme_path));
-        } else {
-            GResource *resource = gresources_get_resource();
-            g_resources_register(resource);
-            gtk_css_provider_load_from_resource(self->provider,
-                                                LIGHT_THEME_RESOURCE);
-        }
+    GtkCssProvider *provider = theme_provider(self, theme);
+    char *theme_path = local_theme_path(theme);
+
+    if (g_file_test(theme_path, G_FILE_TEST_EXISTS)) {
+        g_debug("theme_service.c:load_theme(): loading %s", theme_path);
+        gtk_css_provider_load_from_path(provider, theme_path);
     } else {
-        if (local_dark_theme_present()) {
-            const char *conf_dir = g_get_user_config_dir();
-            char *theme_path =
-                g_build_filename(conf_dir, CONFIG_DIR, DARK_THEME_CSS, NULL);
-            gtk_css_provider_load_from_file(self->provider,
-                                            g_file_new_for_path(theme_path));
-        } else {
-            GResource *resource = gresources_get_resource();
-            g_resources_register(resource);
-            gtk_css_provider_load_from_resource(self->provider,
-                                                DARK_THEME_RESOURCE);
-        }
+        gtk_css_provider_load_from_resource(
+            provider,
+            theme == THEME_LIGHT ? LIGHT_THEME_RESOURCE : DARK_THEME_RESOURCE);
     }
+    g_free(theme_path);
 }
 
-void theme_service_set_light_theme(ThemeService *self, gboolean light_theme) {
+static void on_local_theme_changed(GFileMonitor *monitor, GFile *file,
+                                   GFile *other, GFileMonitorEvent event,
+                                   ThemeService *self) {
+    if (event != G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT &&
+        event != G_FILE_MONITOR_EVENT_DELETED)
+        return;
+
+    enum ThemeServiceTheme theme =
+        monitor == self->light_monitor ? THEME_LIGHT : THEME_DARK;
+
     g_debug(
-        "theme_service.c:theme_service_set_light_theme(): setting light theme");
+        "theme_service.c:on_local_theme_changed(): reloading %s theme",
+        theme == THEME_LIGHT ? "light" : "dark");
 
-    load_theme(self, THEME_LIGHT);
+    // reloading an attached provider restyles on its own, an unattached one
+    // is simply ready for the next switch.
+    load_theme(self, theme);
+}
+
+static GFileMonitor *watch_local_theme(ThemeService *self,
+                                       enum ThemeServiceTheme theme) {
+    char *theme_path = local_theme_path(theme);
+    GFile *file = g_file_new_for_path(theme_path);
+    GError *error = NULL;
+
+    // monitoring a file which does not exist yet is fine, it reports the
+    // override once it is created.
+    GFileMonitor *monitor =
+        g_file_monitor_file(file, G_FILE_MONITOR_NONE, NULL, &error);
+    if (!monitor) {
+        g_warning("theme_service.c:watch_local_theme(): failed to watch %s: %s",
+                  theme_path, error->message);
+        g_error_free(error);
+    } else {
+        g_signal_connect(monitor, "changed",
+                         G_CALLBACK(on_local_theme_changed), self);
+    }
+
+    g_object_unref(file);
+    g_free(theme_path);
+    return monitor;
+}
+
+// Attaches the resident provider for `theme` to the display. Returns FALSE
+// if it already was attached.
+static gboolean apply_theme(ThemeService *self, enum ThemeServiceTheme theme) {
+    GtkCssProvider *provider = theme_provider(self, theme);
+    if (self->active == provider) return FALSE;
 
     GdkSeat *seat = gdk_display_get_default_seat(gdk_display_get_default());
     GdkDisplay *display = gdk_seat_get_display(seat);
+
+    if (self->active)
+        gtk_style_context_remove_provider_for_display(
+            display, GTK_STYLE_PROVIDER(self->active));
     gtk_style_context_add_provider_for_display(
-        display, GTK_STYLE_PROVIDER(self->provider),
+        display, GTK_STYLE_PROVIDER(provider),
         GTK_STYLE_PROVIDER_PRIORITY_THEME);
+    self->active = provider;
+    self->light_theme = theme == THEME_LIGHT;
+    return TRUE;
+}
+
+void theme_service_set_light_theme(ThemeService *self, gboolean light_theme) {
+    g_debug(
+        "theme_service.c:theme_service_set_light_theme(): setting light theme");
+
+    // writing the setting below re-enters through on_settings_changed, which
+    // finds the theme already applied.
+    if (!apply_theme(self, THEME_LIGHT)) return;
 
     g_settings_set_boolean(self->setting, "light-theme", true);
     g_signal_emit_by_name(self, "theme-changed", THEME_LIGHT);
@@ -143,13 +197,7 @@ void theme_service_set_dark_theme(ThemeService *self, gboolean dark_theme) {
     g_debug(
         "theme_service.c:theme_service_set_dark_theme(): setting dark theme");
 
-    load_theme(self, THEME_DARK);
-
-    GdkSeat *seat = gdk_display_get_default_seat(gdk_display_get_default());
-    GdkDisplay *display = gdk_seat_get_display(seat);
-    gtk_style_context_add_provider_for_display(
-        display, GTK_STYLE_PROVIDER(self->provider),
-        GTK_STYLE_PROVIDER_PRIORITY_THEME);
+    if (!apply_theme(self, THEME_DARK)) return;
 
     g_settings_set_boolean(self->setting, "light-theme", false);
     g_signal_emit_by_name(self, "theme-changed", THEME_DARK);
@@ -180,8 +228,15 @@ enum ThemeServiceTheme theme_service_get_theme(ThemeService *self) {
 static void theme_service_init(ThemeService *self) {
     self->setting = g_settings_new("org.ldelossa.way-shell.system");
 
-    self->provider = gtk_css_provider_new();
-    g_object_ref(self->provider);
+    g_resources_register(gresources_get_resource());
+
+    self->light_provider = gtk_css_provider_new();
+    self->dark_provider = gtk_css_provider_new();
+    load_theme(self, THEME_LIGHT);
+    load_theme(self, THEME_DARK);
+
+    self->light_monitor = watch_local_theme(self, THEME_LIGHT);
+    self->dark_monitor = watch_local_theme(self, THEME_DARK);
 
     on_settings_changed(self->setting, "light-theme", self);
 
@@ -5,20 +5,29 @@
 
 static UPowerService *global = NULL;
 
+enum signals { battery_changed, peripherals_changed, signals_n };
+
 struct _UPowerService {
     GObject parent_instance;
     UpClient *client;
-    UpDevice *bat;
-    UpDevice *ac;
-    GPtrArray *devices;
-    gboolean on_bat;
+    // tracked UpDevices keyed by object path.
+    GHashTable *devices;
+    // last emitted snapshots, see upower_service_update().
+    UPowerBattery battery;
+    GHashTable *peripherals;
+    // devices notify for every property UPower refreshes, e.g. energy and
+    // voltage, updates are coalesced into one pass per main loop iteration.
+    guint update_id;
     gboolean enabled;
 };
+static guint signals[signals_n] = {0};
 G_DEFINE_TYPE(UPowerService, upower_service, G_TYPE_OBJECT);
 
 static void upower_service_dispose(GObject *gobject) {
     UPowerService *self = UPOWER_SERVICE(gobject);
 
+    g_clear_handle_id(&self->update_id, g_source_remove);
+
     // Chain-up
     G_OBJECT_CLASS(upower_service_parent_class)->dispose(gobject);
 };
@@ -32,56 +41,264 @@ static void upower_service_class_init(UPowerServiceClass *klass) {
     GObjectClass *object_class = G_OBJECT_CLASS(klass);
     object_class->dispose = upower_service_dispose;
     object_class->finalize = upower_service_finalize;
+
+    signals[battery_changed] = g_signal_new(
+        "battery-changed", G_TYPE_FROM_CLASS(klass), G_SIGNAL_RUN_FIRST, 0,
+        NULL, NULL, NULL, G_TYPE_NONE, 1, G_TYPE_POINTER);
+
+    signals[peripherals_changed] = g_signal_new(
+        "peripherals-changed", G_TYPE_FROM_CLASS(klass), G_SIGNAL_RUN_FIRST,
+        0, NULL, NULL, NULL, G_TYPE_NONE, 1, G_TYPE_HASH_TABLE);
 };
 
-static void upower_service_set_battery_device(UPowerService *self,
-                                              UpDevice *device) {
-    GValue kind = G_VALUE_INIT;
-    g_object_get_property(G_OBJECT(device), "kind", &kind);
-    if (g_value_get_uint(&kind) == UP_DEVICE_KIND_BATTERY) {
-        g_debug(
-            "upower_service.c:upower_service_init_is_battery() discovered "
-            "battery\n%s",
-            up_device_to_text(device));
-        self->bat = device;
+static void upower_battery_free(UPowerBattery *battery) {
+    g_free(battery->name);
+    g_free(battery);
+}
+
+static gboolean upower_battery_equal(const UPowerBattery *a,
+                                     const UPowerBattery *b) {
+    return a->present == b->present && a->kind == b->kind &&
+           a->percentage == b->percentage && a->state == b->state &&
+           g_strcmp0(a->icon_name, b->icon_name) == 0 &&
+           a->time_to_empty == b->time_to_empty &&
+           a->time_to_full == b->time_to_full &&
+           g_strcmp0(a->name, b->name) == 0;
+}
+
+static gboolean upower_state_is_charging(guint state) {
+    return (state == UP_DEVICE_STATE_CHARGING ||
+            state == UP_DEVICE_STATE_FULLY_CHARGED ||
+            state == UP_DEVICE_STATE_PENDING_CHARGE);
+}
+
+static gint64 upower_time_bucket(gint64 seconds) {
+    if (seconds <= 0) return 0;
+    return seconds - (seconds % UPOWER_SERVICE_TIME_BUCKET_S);
+}
+
+// a peripheral is any battery which does not power the system.
+static gboolean upower_device_is_peripheral(UpDevice *device) {
+    guint kind = UP_DEVICE_KIND_UNKNOWN;
+    gboolean power_supply = false;
+    gboolean is_present = false;
+
+    g_object_get(device, "kind", &kind, "power-supply", &power_supply,
+                 "is-present", &is_present, NULL);
+
+    return !power_supply && is_present && kind != UP_DEVICE_KIND_UNKNOWN &&
+           kind != UP_DEVICE_KIND_LINE_POWER;
+}
+
+static void upower_battery_from_device(UpDevice *device,
+                                       UPowerBattery *battery) {
+    gdouble percent = 0;
+    gint64 time_to_empty = 0;
+    gint64 time_to_full = 0;
+
+    g_object_get(device, "kind", &battery->kind, "model", &battery->name,
+                 "percentage", &percent, "state", &battery->state,
+                 "time-to-empty", &time_to_empty, "time-to-full",
+                 &time_to_full, NULL);
+
+    battery->present = true;
+    battery->percentage = (guint)(percent + 0.5);
+    battery->charging = upower_state_is_charging(battery->state);
+    battery->icon_name = upower_service_map_icon_name(
+        battery->percentage, battery->state, true);
+    battery->time_to_empty = upower_time_bucket(time_to_empty);
+    battery->time_to_full = upower_time_bucket(time_to_full);
+}
+
+// Aggregates every present battery which powers the system into `battery`.
+// Percentage and estimates are computed from summed energy, as UPower does
+// for its display device.
+static void upower_service_aggregate(UPowerService *self,
+                                     UPowerBattery *battery) {
+    gdouble energy = 0, energy_full = 0, energy_rate = 0, percent_sum = 0;
+    guint state = UP_DEVICE_STATE_UNKNOWN;
+    guint n = 0;
+
+    GHashTableIter iter;
+    UpDevice *device;
+    g_hash_table_iter_init(&iter, self->devices);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&device)) {
+        guint kind = UP_DEVICE_KIND_UNKNOWN, dev_state = 0;
+        gboolean power_supply = false, is_present = false;
+        gdouble dev_energy = 0, dev_energy_full = 0, dev_energy_rate = 0,
+                dev_percent = 0;
+
+        g_object_get(device, "kind", &kind, "power-supply", &power_supply,
+                     "is-present", &is_present, NULL);
+        if (kind != UP_DEVICE_KIND_BATTERY || !power_supply || !is_present)
+            continue;
+
+        g_object_get(device, "energy", &dev_energy, "energy-full",
+                     &dev_energy_full, "energy-rate", &dev_energy_rate,
+                     "percentage", &dev_percent, "state", &dev_state, NULL);
+
+        energy += dev_energy;
+        energy_full += dev_energy_full;
+        energy_rate += dev_energy_rate;
+        percent_sum += dev_percent;
+        n++;
+
+        // any battery charging means the system is charging, otherwise any
+        // battery discharging means its discharging.
+        if (dev_state == UP_DEVICE_STATE_CHARGING)
+            state = UP_DEVICE_STATE_CHARGING;
+        else if (dev_state == UP_DEVICE_STATE_DISCHARGING &&
+                 state != UP_DEVICE_STATE_CHARGING)
+            state = UP_DEVICE_STATE_DISCHARGING;
+        else if (state == UP_DEVICE_STATE_UNKNOWN)
+            state = dev_state;
     }
-};
 
-static void upower_service_set_ac_device(UPowerService *self,
-                                         UpDevice *device) {
-    GValue kind = G_VALUE_INIT;
-    g_object_get_property(G_OBJECT(device), "kind", &kind);
-    if (g_value_get_uint(&kind) == UP_DEVICE_KIND_LINE_POWER) {
-        // check if native-path is equal to "AC"
-        GValue native_path = G_VALUE_INIT;
-        g_object_get_property(G_OBJECT(device), "native-path", &native_path);
-        if (g_strcmp0(g_value_get_string(&native_path), "AC") != 0) {
-            return;
+    battery->kind = UP_DEVICE_KIND_BATTERY;
+    if (n == 0) {
+        battery->present = false;
+        battery->percentage = 100;
+        battery->icon_name = upower_service_map_icon_name(100, 0, false);
+        return;
+    }
+
+    gdouble percent =
+        (energy_full > 0) ? 100 * energy / energy_full : percent_sum / n;
+
+    battery->present = true;
+    battery->percentage = (guint)(percent + 0.5);
+    battery->state = state;
+    battery->charging = upower_state_is_charging(state);
+    battery->icon_name =
+        upower_service_map_icon_name(battery->percentage, state, true);
+
+    if (energy_rate > 0 && state == UP_DEVICE_STATE_DISCHARGING)
+        battery->time_to_empty =
+            upower_time_bucket(energy / energy_rate * 3600);
+    if (energy_rate > 0 && state == UP_DEVICE_STATE_CHARGING)
+        battery->time_to_full =
+            upower_time_bucket((energy_full - energy) / energy_rate * 3600);
+}
+
+// Recomputes the displayed snapshots and emits only for those which changed.
+static gboolean upower_service_update(UPowerService *self) {
+    self->update_id = 0;
+
+    g_debug("upower_service.c:upower_service_update() called.");
+
+    UPowerBattery battery = {0};
+    upower_service_aggregate(self, &battery);
+    if (!upower_battery_equal(&battery, &self->battery)) {
+        self->battery = battery;
+        g_signal_emit(self, signals[battery_changed], 0, &self->battery);
+    }
+
+    gboolean changed = false;
+    GHashTableIter iter;
+    const gchar *path;
+    UpDevice *device;
+
+    // drop peripherals which went away.
+    g_hash_table_iter_init(&iter, self->peripherals);
+    while (g_hash_table_iter_next(&iter, (gpointer *)&path, NULL)) {
+        device = g_hash_table_lookup(self->devices, path);
+        if (device && upower_device_is_peripheral(device)) continue;
+        g_hash_table_iter_remove(&iter);
+        changed = true;
+    }
+
+    g_hash_table_iter_init(&iter, self->devices);
+    while (g_hash_table_iter_next(&iter, (gpointer *)&path,
+                                  (gpointer *)&device)) {
+        if (!upower_device_is_peripheral(device)) continue;
+
+        UPowerBattery *peripheral = g_new0(UPowerBattery, 1);
+        upower_battery_from_device(device, peripheral);
+
+        UPowerBattery *old = g_hash_table_lookup(self->peripherals, path);
+        if (old && upower_battery_equal(old, peripheral)) {
+            upower_battery_free(peripheral);
+            continue;
         }
 
-        g_debug(
-            "upower_service.c:upower_service_init_is_battery() discovered "
-            "AC\n%s",
-            up_device_to_text(device));
-        self->ac = device;
+        g_hash_table_replace(self->peripherals, g_strdup(path), peripheral);
+        changed = true;
     }
-};
+
+    if (changed)
+        g_signal_emit(self, signals[peripherals_changed], 0, self->peripherals);
+
+    return G_SOURCE_REMOVE;
+}
+
+static void upower_service_queue_update(UPowerService *self) {
+    if (self->update_id) return;
+    self->update_id = g_idle_add((GSourceFunc)upower_service_update, self);
+}
+
+static void on_device_notify(UpDevice *device, GParamSpec *pspec,
+                             UPowerService *self) {
+    upower_service_queue_update(self);
+}
+
+static void upower_service_track_device(UPowerService *self,
+                                        UpDevice *device) {
+    const gchar *path = up_device_get_object_path(device);
+    if (!path || g_hash_table_contains(self->devices, path)) return;
+
+    g_debug("upower_service.c:upower_service_track_device() tracking\n%s",
+            up_device_to_text(device));
+
+    g_hash_table_insert(self->devices, g_strdup(path), g_object_ref(device));
+    g_signal_connect(device, "notify", G_CALLBACK(on_device_notify), self);
+    upower_service_queue_update(self);
+}
+
+static void on_device_added(UpClient *client, UpDevice *device,
+                            UPowerService *self) {
+    g_debug("upower_service.c:on_device_added() called.");
+    upower_service_track_device(self, device);
+}
+
+static void on_device_removed(UpClient *client, const gchar *path,
+                              UPowerService *self) {
+    g_debug("upower_service.c:on_device_removed() %s", path);
+
+    UpDevice *device = g_hash_table_lookup(self->devices, path);
+    if (!device) return;
+
+    g_signal_handlers_disconnect_by_func(device, on_device_notify, self);
+    g_hash_table_remove(self->devices, path);
+    upower_service_queue_update(self);
+}
 
 static void upower_service_init(UPowerService *self) {
     self->client = up_client_new();
     self->enabled = TRUE;
     if (self->client == NULL) {
         self->enabled = FALSE;
+        return;
     }
-    // get devices
-    self->devices = up_client_get_devices2(self->client);
-    // find battery device if it exist.
-    for (guint i = 0; i < self->devices->len; i++) {
-        if (!self->bat)
-            upower_service_set_battery_device(self, self->devices->pdata[i]);
-        if (!self->ac)
-            upower_service_set_ac_device(self, self->devices->pdata[i]);
-    }
+
+    self->devices =
+        g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_object_unref);
+    self->peripherals = g_hash_table_new_full(
+        g_str_hash, g_str_equal, g_free, (GDestroyNotify)upower_battery_free);
+
+    // track current devices, and any which are hot-plugged later.
+    GPtrArray *devices = up_client_get_devices2(self->client);
+    for (guint i = 0; devices && i < devices->len; i++)
+        upower_service_track_device(self, devices->pdata[i]);
+    if (devices) g_ptr_array_unref(devices);
+
+    g_signal_connect(self->client, "device-added",
+                     G_CALLBACK(on_device_added), self);
+    g_signal_connect(self->client, "device-removed",
+                     G_CALLBACK(on_device_removed), self);
+
+    // compute the initial snapshots now, consumers read them at init.
+    g_clear_handle_id(&self->update_id, g_source_remove);
+    upower_service_update(self);
 };
 
 int upower_service_global_init(void) {
@@ -103,56 +320,23 @@ UpClient *upower_service_get_up_client(UPowerService *self) {
 // Will return NULL if `clock_service_global_init` has not been called.
 UPowerService *upower_service_get_global() { return global; };
 
-// Returns the primary power source for the system.
-// If a battery is present this will be the first battery on the system.
-// If no battery is present this will be the AC line power device.
-UpDevice *upower_service_get_primary_device(UPowerService *self) {
-    if (!self) {
-        return NULL;
-    }
-    if (self->bat) {
-        return self->bat;
-    }
-    if (self->ac) {
-        return self->ac;
-    }
-    return NULL;
+const UPowerBattery *upower_service_get_battery(UPowerService *self) {
+    return &self->battery;
 }
 
-// Returns whether the primary device is a battery or an AC power supply.
-gboolean upower_service_primary_is_bat(UPowerService *self) {
-    if (self->bat) {
-        return TRUE;
-    }
-    return FALSE;
+GHashTable *upower_service_get_peripherals(UPowerService *self) {
+    return self->peripherals;
 }
 
-char *upower_device_map_icon_name(UpDevice *device) {
-    double percent = 0;
-    gboolean rechargable = 0;
-    guint state = 0;
-    gchar *icon = NULL;
+const gchar *upower_service_map_icon_name(gdouble percent, guint state,
+                                          gboolean rechargable) {
     gboolean charging = false;
 
-    g_debug("upower_service.c:upower_device_map_icon_name() called.");
-
-    g_object_get(device, "percentage", &percent, NULL);
-    g_object_get(device, "is-rechargeable", &rechargable, NULL);
-    g_object_get(device, "state", &state, NULL);
-    g_object_get(device, "icon-name", &icon, NULL);
-
-    g_debug(
-        "upower_service.c:upower_device_map_icon_name() icon: %s state: %d "
-        "rechargable: %d percent: %f",
-        icon, state, rechargable, percent);
-
     if (!rechargable) {
         return "ac-adapter-symbolic";
     }
 
-    charging = (state == UP_DEVICE_STATE_CHARGING ||
-                state == UP_DEVICE_STATE_FULLY_CHARGED ||
-                state == UP_DEVICE_STATE_PENDING_CHARGE);
+    charging = upower_state_is_charging(state);
 
     if (percent <= 10) {
         if (charging) return "battery-caution-charging-symbolic";
@@ -190,7 +374,7 @@ char *upower_device_map_icon_name(UpDevice *device) {
         if (charging) return "battery-level-80-charging-symbolic";
         return "battery-level-80-symbolic";
     }
-    if (percent > 90) {
+    if (percent >= 90) {
         if (charging) {
             if (state == UP_DEVICE_STATE_FULLY_CHARGED)
                 return "battery-full-charging-symbolic";
@@ -3,6 +3,30 @@
 #include <adwaita.h>
 #include <upower.h>
 
+// Granularity, in seconds, of the time-to-empty and time-to-full estimates in
+// a UPowerBattery. UPower recomputes these from the energy rate every few
+// seconds, bucketing them keeps jitter from reaching the displayed values.
+#define UPOWER_SERVICE_TIME_BUCKET_S 300
+
+// A displayed view of one or more UPower batteries. Values are rounded to
+// what the shell displays, so a snapshot only changes when something visible
+// does.
+typedef struct _UPowerBattery {
+    // NULL for the aggregated system battery, the device's model for
+    // peripherals.
+    gchar *name;
+    guint kind;
+    // false when no battery backs this snapshot, e.g. a desktop on AC.
+    gboolean present;
+    guint percentage;
+    guint state;
+    gboolean charging;
+    const gchar *icon_name;
+    // estimates, in seconds, rounded down to UPOWER_SERVICE_TIME_BUCKET_S.
+    gint64 time_to_empty;
+    gint64 time_to_full;
+} UPowerBattery;
+
 G_BEGIN_DECLS
 
 // Service which provides power state information for various devices.
@@ -21,14 +45,16 @@ UpClient *upower_service_get_up_client(UPowerService *self);
 // Will return NULL if `clock_service_global_init` has not been called.
 UPowerService *upower_service_get_global();
 
-// Returns the primary power source for the system.
-// If a battery is present this will be the first battery on the system.
-// If no battery is present this will be the AC line power device.
-UpDevice *upower_service_get_primary_device(UPowerService *self);
+// Returns the system battery, aggregated over every battery which powers the
+// system. "battery-changed" is emitted when it changes.
+const UPowerBattery *upower_service_get_battery(UPowerService *self);
 
-// Returns whether the primary device is a battery or an AC device.
-gboolean upower_service_primary_is_bat(UPowerService *self);
+// Returns peripheral batteries, e.g. mice and headsets, keyed by UPower
+// object path. "peripherals-changed" is emitted when one is added, removed or
+// changes.
+GHashTable *upower_service_get_peripherals(UPowerService *self);
 
-// Returns our application's preferred icon to represent the state of the
-// UpDevice.
-char *upower_device_map_icon_name(UpDevice *device);
\ No newline at end of file
+// Returns our application's preferred icon to represent a battery at
+// `percentage` in `state`.
+const gchar *upower_service_map_icon_name(gdouble percentage, guint state,
+                                          gboolean rechargeable);
@@ -7,6 +7,10 @@
 
 static WaylandForeignToplevelService *global = NULL;
 
+// Interval, in milliseconds, toplevel updates are coalesced over before
+// "top-level-changed" is emitted, roughly one frame at 60Hz.
+#define FOREIGN_TOPLEVEL_FLUSH_MS 16
+
 enum signals { top_level_changed, top_level_removed, signals_n };
 
 struct _WaylandForeignToplevelService {
@@ -21,6 +25,9 @@ struct _WaylandForeignToplevelService {
     GSettings *settings;
     GHashTable *ignored_toplevel_app_ids;
     GHashTable *ignored_toplevel_titles;
+    // toplevels with committed changes waiting to be signaled.
+    GPtrArray *dirty_toplevels;
+    guint flush_id;
 };
 
 static guint service_signals[signals_n] = {0};
@@ -49,7 +56,8 @@ static void wayland_foreign_toplevel_service_class_init(
 
     service_signals[top_level_changed] = g_signal_new(
         "top-level-changed", G_TYPE_FROM_CLASS(klass), G_SIGNAL_RUN_FIRST, 0,
-        NULL, NULL, NULL, G_TYPE_NONE, 2, G_TYPE_HASH_TABLE, G_TYPE_POINTER);
+        NULL, NULL, NULL, G_TYPE_NONE, 3, G_TYPE_HASH_TABLE, G_TYPE_POINTER,
+        G_TYPE_UINT);
 
     service_signals[top_level_removed] = g_signal_new(
         "top-level-removed", G_TYPE_FROM_CLASS(klass), G_SIGNAL_RUN_FIRST, 0,
@@ -107,6 +115,8 @@ static void wayland_foreign_toplevel_service_init(
     self->toplevels = g_hash_table_new(g_direct_hash, g_direct_equal);
     self->ignored_toplevel_app_ids = g_hash_table_new(g_str_hash, g_str_equal);
     self->ignored_toplevel_titles = g_hash_table_new(g_str_hash, g_str_equal);
+    self->dirty_toplevels = g_ptr_array_new();
+    self->flush_id = 0;
 
     self->settings = g_settings_new("org.ldelossa.way-shell.window-manager");
     on_ignored_toplevels_app_ids_changed(self->settings,
@@ -181,6 +191,63 @@ void wayland_foreign_toplevel_service_maximize(
     wl_display_flush(wayland_core_service_get_display(self->core));
 }
 
+static gboolean wayland_foreign_toplevel_service_is_ignored(
+    WaylandForeignToplevelService *self, WaylandWLRForeignTopLevel *toplevel) {
+    if (g_hash_table_contains(self->ignored_toplevel_app_ids,
+                              toplevel->app_id))
+        return TRUE;
+    return g_hash_table_contains(self->ignored_toplevel_titles,
+                                 toplevel->title);
+}
+
+static gboolean wayland_foreign_toplevel_service_flush(
+    WaylandForeignToplevelService *self) {
+    self->flush_id = 0;
+
+    // steal the array, handlers may dispatch Wayland events which dirty
+    // toplevels again.
+    GPtrArray *dirty = self->dirty_toplevels;
+    self->dirty_toplevels = g_ptr_array_new();
+
+    for (guint i = 0; i < dirty->len; i++) {
+        WaylandWLRForeignTopLevel *toplevel = g_ptr_array_index(dirty, i);
+        guint32 changes = toplevel->changes;
+        toplevel->changes = TOPLEVEL_CHANGE_NONE;
+
+        if (wayland_foreign_toplevel_service_is_ignored(self, toplevel))
+            continue;
+
+        if (!toplevel->advertised) changes |= TOPLEVEL_CHANGE_ALL;
+        toplevel->advertised = TRUE;
+
+        g_debug(
+            "foreign_toplevel.c:wayland_foreign_toplevel_service_flush(): "
+            "toplevel->app_id: %s, changes: 0x%x",
+            toplevel->app_id, changes);
+
+        g_signal_emit(self, service_signals[top_level_changed], 0,
+                      self->toplevels, toplevel, changes);
+    }
+    g_ptr_array_unref(dirty);
+
+    return G_SOURCE_REMOVE;
+}
+
+// Queues a "top-level-changed" emission for `toplevel`. Any number of 'done'
+// events arriving within FOREIGN_TOPLEVEL_FLUSH_MS result in a single emission
+// carrying the union of their changes.
+static void wayland_foreign_toplevel_service_mark_dirty(
+    WaylandForeignToplevelService *self, WaylandWLRForeignTopLevel *toplevel) {
+    if (toplevel->changes == TOPLEVEL_CHANGE_NONE)
+        g_ptr_array_add(self->dirty_toplevels, toplevel);
+    toplevel->changes |= toplevel->pending_changes;
+
+    if (!self->flush_id)
+        self->flush_id = g_timeout_add(
+            FOREIGN_TOPLEVEL_FLUSH_MS,
+            (GSourceFunc)wayland_foreign_toplevel_service_flush, self);
+}
+
 //			 					//
 // toplevel manager listener 	//
 //			 					//
@@ -231,7 +298,11 @@ static void toplevel_handle_app_id(
         return;
     }
 
+    if (g_strcmp0(top_level->app_id, app_id) == 0) return;
+
+    g_free(top_level->app_id);
     top_level->app_id = g_strdup(app_id);
+    top_level->pending_changes |= TOPLEVEL_CHANGE_APP_ID;
 
     g_debug("foreign_toplevel.c:toplevel_handle_app_id(): top_level->app_id: %s",
             top_level->app_id);
@@ -255,22 +326,16 @@ static void toplevel_handle_closed(
         "toplevel->title: %s",
         toplevel->app_id, toplevel->title);
 
-    // a toplevel without a valid app_id and title was never advertised to the
-    // rest of Way-Shell, so no reason to signal its removal.
-    if (!toplevel->app_id || !toplevel->title) goto remove;
-
-    gboolean ignored = false;
-    ignored =
-        g_hash_table_contains(self->ignored_toplevel_app_ids, toplevel->app_id);
-
-    if (!ignored)
-        ignored = g_hash_table_contains(self->ignored_toplevel_titles,
-                                        toplevel->title);
+    // drop any pending emission, the toplevel is freed below.
+    if (toplevel->changes != TOPLEVEL_CHANGE_NONE)
+        g_ptr_array_remove(self->dirty_toplevels, toplevel);
 
-    if (!ignored)
+    // a toplevel which was never advertised to the rest of Way-Shell, either
+    // because it lacked an app_id and title or was ignored, has no reason to
+    // signal its removal.
+    if (toplevel->advertised)
         g_signal_emit(self, service_signals[top_level_removed], 0, toplevel);
 
-remove:
     // remove it from our inventory
     g_hash_table_remove(self->toplevels, handle);
 
@@ -303,25 +368,16 @@ static void toplevel_handle_done(
         toplevel->activated);
 
     // if we don't have a valid app_id and title, don't bother signaling this
-    // toplevel, the rest of Way-Shell expects these fields.
-    if (!toplevel->app_id || !toplevel->title) goto reset;
+    // toplevel, the rest of Way-Shell expects these fields. pending changes
+    // are kept so they are signaled once both fields arrive.
+    if (!toplevel->app_id || !toplevel->title) return;
 
-    gboolean ignored = false;
-    ignored =
-        g_hash_table_contains(self->ignored_toplevel_app_ids, toplevel->app_id);
+    // nothing the rest of Way-Shell can observe changed, e.g. a client
+    // re-sent an identical title.
+    if (toplevel->pending_changes == TOPLEVEL_CHANGE_NONE) return;
 
-    if (!ignored)
-        ignored = g_hash_table_contains(self->ignored_toplevel_titles,
-                                        toplevel->title);
-
-    if (!ignored)
-        g_signal_emit(self, service_signals[top_level_changed], 0,
-                      self->toplevels, toplevel);
-
-reset:
-    // reset bools after handlers read event
-    toplevel->entered = FALSE;
-    toplevel->activated = FALSE;
+    wayland_foreign_toplevel_service_mark_dirty(self, toplevel);
+    toplevel->pending_changes = TOPLEVEL_CHANGE_NONE;
 }
 
 static void toplevel_handle_output_enter(
@@ -340,6 +396,7 @@ static void toplevel_handle_output_enter(
     }
 
     top_level->entered = TRUE;
+    top_level->pending_changes |= TOPLEVEL_CHANGE_OUTPUT;
 }
 
 static void toplevel_handle_output_leave(
@@ -358,6 +415,7 @@ static void toplevel_handle_output_leave(
     }
 
     top_level->entered = FALSE;
+    top_level->pending_changes |= TOPLEVEL_CHANGE_OUTPUT;
 }
 
 static void toplevel_handle_parent(
@@ -380,14 +438,19 @@ static void toplevel_handle_state(
         return;
     }
 
-    // check if activated
-    top_level->activated = FALSE;
-    for (size_t i = 0; i < state->size; i++) {
-        uint32_t *state_ptr = (uint32_t *)state->data + i;
-        if (*state_ptr == ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_ACTIVATED) {
-            top_level->activated = TRUE;
-        }
+    guint32 states = 0;
+    uint32_t *state_ptr;
+    wl_array_for_each(state_ptr, state) {
+        if (*state_ptr < 32) states |= 1u << *state_ptr;
     }
+
+    top_level->activated =
+        (states & (1u << ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_ACTIVATED)) != 0;
+
+    if (states == top_level->states) return;
+
+    top_level->states = states;
+    top_level->pending_changes |= TOPLEVEL_CHANGE_STATE;
 }
 
 static void toplevel_handle_title(
@@ -403,7 +466,11 @@ static void toplevel_handle_title(
         return;
     }
 
+    if (g_strcmp0(top_level->title, title) == 0) return;
+
+    g_free(top_level->title);
     top_level->title = g_strdup(title);
+    top_level->pending_changes |= TOPLEVEL_CHANGE_TITLE;
 
     g_debug("foreign_toplevel.c:toplevel_handle_title(): top_level->title: %s",
             top_level->title);
@@ -12,16 +12,38 @@ enum WaylandWLRForeignTopLevelState {
     TOPLEVEL_STATE_FULLSCEEN,
 };
 
+// Bits describing which fields of a WaylandWLRForeignTopLevel changed since it
+// was last signaled, passed as the last argument of "top-level-changed".
+enum WaylandWLRForeignTopLevelChange {
+    TOPLEVEL_CHANGE_NONE = 0,
+    // the toplevel is being advertised for the first time.
+    TOPLEVEL_CHANGE_NEW = 1 << 0,
+    TOPLEVEL_CHANGE_APP_ID = 1 << 1,
+    TOPLEVEL_CHANGE_TITLE = 1 << 2,
+    TOPLEVEL_CHANGE_STATE = 1 << 3,
+    TOPLEVEL_CHANGE_OUTPUT = 1 << 4,
+    TOPLEVEL_CHANGE_ALL = 0x1f,
+};
+
 typedef struct _WaylandWLRForeignTopLevel {
     WaylandHeader header;
     struct zwlr_foreign_toplevel_handle_v1 *toplevel;
     char *app_id;
     char *title;
     gboolean entered;
+    // TRUE while the toplevel holds the activated state.
     gboolean activated;
     gboolean closed;
     enum WaylandWLRForeignTopLevelState state;
-
+    // bitmask of ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_* values last sent.
+    guint32 states;
+    // WaylandWLRForeignTopLevelChange bits accumulated from events which have
+    // not been committed by a 'done' event yet.
+    guint32 pending_changes;
+    // WaylandWLRForeignTopLevelChange bits committed but not yet signaled.
+    guint32 changes;
+    // TRUE once "top-level-changed" has been emitted for this toplevel.
+    gboolean advertised;
 } WaylandWLRForeignTopLevel;
 
 G_BEGIN_DECLS
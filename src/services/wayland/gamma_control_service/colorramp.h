@@ -5,13 +5,14 @@
 
 /* All credit for the below code goes to the gammastep application
    https://gitlab.com/chinstrap/gammastep
-   The F macro is slightly modified from its original value:
+   gammastep computes every ramp entry as:
 
-   #define F(Y, C)  pow((Y) * setting->brightness
-            white_point[C], 1.0/setting->gamma[C])
+   pow(Y * setting->brightness * white_point[C], 1.0/setting->gamma[C])
 
-   to simplify our needs, we do not allow adjmust of brightness or
-   gamma in our calculation for internal bluelight filtering */
+   where Y is the identity ramp's value. We do not allow adjusting
+   brightness or gamma for internal bluelight filtering, both are fixed at
+   1.0, so an entry is simply Y scaled by the white point of its channel,
+   see colorramp_fill_channel below. */
 
 /* Whitepoint values for temperatures at 100K intervals.
    These will be interpolated for the actual temperature.
@@ -175,23 +176,56 @@ static void interpolate_color(float a, const float *c1, const float *c2,
     c[2] = (1.0 - a) * c1[2] + a * c2[2];
 }
 
-#define F(Y, C) pow((Y) * 1.0 * white_point[C], 1.0 / 1.0)
+typedef double colorramp_v4d __attribute__((vector_size(32)));
+typedef int32_t colorramp_v4i __attribute__((vector_size(16)));
 
+/* Fills one channel's ramp. Brightness and gamma are fixed at 1.0, so each
+   entry is the identity ramp's value scaled by the channel's white point,
+   computed four entries at a time. The math is done in double and identity
+   values are truncated before scaling, exactly as gammastep's per entry
+   pow() did, so the ramps are bit identical to it. */
+static void colorramp_fill_channel(uint16_t *ramp, int size,
+                                   float white_point) {
+    const colorramp_v4d vsize = {size, size, size, size};
+    const colorramp_v4d vmax = {UINT16_MAX + 1, UINT16_MAX + 1,
+                                UINT16_MAX + 1, UINT16_MAX + 1};
+    const colorramp_v4d vwp = {white_point, white_point, white_point,
+                               white_point};
+    const colorramp_v4d four = {4, 4, 4, 4};
+    colorramp_v4d idx = {0, 1, 2, 3};
+    int i = 0;
+
+    for (; i + 4 <= size; i += 4) {
+        colorramp_v4i id =
+            __builtin_convertvector(idx / vsize * vmax, colorramp_v4i);
+        colorramp_v4i out = __builtin_convertvector(
+            __builtin_convertvector(id, colorramp_v4d) * vwp, colorramp_v4i);
+        ramp[i] = out[0];
+        ramp[i + 1] = out[1];
+        ramp[i + 2] = out[2];
+        ramp[i + 3] = out[3];
+        idx += four;
+    }
+    for (; i < size; i++) {
+        uint16_t id = (double)i / size * (UINT16_MAX + 1);
+        ramp[i] = (double)id * white_point;
+    }
+}
+
+/* Fills the provided ramps, there is no need to initialize them to the
+   identity ramp first. */
 void colorramp_fill(uint16_t *gamma_r, uint16_t *gamma_g, uint16_t *gamma_b,
                     int size, int temperature) {
     /* Approximate white point */
     float white_point[3];
+    if (temperature < 1000) temperature = 1000;
+    if (temperature > 25000) temperature = 25000;
     float alpha = (temperature % 100) / 100.0;
     int temp_index = ((temperature - 1000) / 100) * 3;
     interpolate_color(alpha, &blackbody_color[temp_index],
                       &blackbody_color[temp_index + 3], white_point);
 
-    for (int i = 0; i < size; i++) {
-        gamma_r[i] =
-            F((double)gamma_r[i] / (UINT16_MAX + 1), 0) * (UINT16_MAX + 1);
-        gamma_g[i] =
-            F((double)gamma_g[i] / (UINT16_MAX + 1), 1) * (UINT16_MAX + 1);
-        gamma_b[i] =
-            F((double)gamma_b[i] / (UINT16_MAX + 1), 2) * (UINT16_MAX + 1);
-    }
+    colorramp_fill_channel(gamma_r, size, white_point[0]);
+    colorramp_fill_channel(gamma_g, size, white_point[1]);
+    colorramp_fill_channel(gamma_b, size, white_point[2]);
 }
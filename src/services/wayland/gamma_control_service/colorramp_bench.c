@@ -0,0 +1,100 @@
+// Benchmarks colorramp_fill against the per entry pow() ramp it replaced,
+// walking a sunset transition from 6500K to 3000K in 10K steps with
+// 4096 entry ramps.
+//
+//   make bench
+//   ./src/services/wayland/gamma_control_service/colorramp_bench
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "colorramp.h"
+
+#define BENCH_RAMP_SIZE 4096
+#define BENCH_TEMP_START 6500
+#define BENCH_TEMP_END 3000
+#define BENCH_TEMP_STEP 10
+#define BENCH_ROUNDS 20
+
+// The ramp computation way-shell used before colorramp_fill_channel, an
+// identity ramp filled with double math followed by a pow() per entry per
+// channel.
+static void bench_fill_reference(uint16_t *r, uint16_t *g, uint16_t *b,
+                                 int size, int temperature) {
+    float white_point[3];
+    float alpha = (temperature % 100) / 100.0;
+    int temp_index = ((temperature - 1000) / 100) * 3;
+    interpolate_color(alpha, &blackbody_color[temp_index],
+                      &blackbody_color[temp_index + 3], white_point);
+
+    for (int i = 0; i < size; i++) {
+        uint16_t value = (double)i / size * (UINT16_MAX + 1);
+        r[i] = value;
+        g[i] = value;
+        b[i] = value;
+    }
+    for (int i = 0; i < size; i++) {
+        r[i] = pow((double)r[i] / (UINT16_MAX + 1) * white_point[0], 1.0) *
+               (UINT16_MAX + 1);
+        g[i] = pow((double)g[i] / (UINT16_MAX + 1) * white_point[1], 1.0) *
+               (UINT16_MAX + 1);
+        b[i] = pow((double)b[i] / (UINT16_MAX + 1) * white_point[2], 1.0) *
+               (UINT16_MAX + 1);
+    }
+}
+
+static double bench_now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+typedef void (*bench_fill_func)(uint16_t *, uint16_t *, uint16_t *, int, int);
+
+// Returns the average time, in nanoseconds, `fill` takes for one ramp.
+static double bench_run(bench_fill_func fill, uint16_t *table) {
+    int ramps = 0;
+    double start = bench_now_ns();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (int t = BENCH_TEMP_START; t >= BENCH_TEMP_END;
+             t -= BENCH_TEMP_STEP) {
+            fill(table, table + BENCH_RAMP_SIZE, table + BENCH_RAMP_SIZE * 2,
+                 BENCH_RAMP_SIZE, t);
+            ramps++;
+        }
+    }
+    return (bench_now_ns() - start) / ramps;
+}
+
+int main() {
+    size_t table_size = BENCH_RAMP_SIZE * 3 * sizeof(uint16_t);
+    uint16_t *want = malloc(table_size);
+    uint16_t *got = malloc(table_size);
+
+    // the kernel must produce exactly the ramps the reference does.
+    for (int t = BENCH_TEMP_START; t >= BENCH_TEMP_END; t -= BENCH_TEMP_STEP) {
+        bench_fill_reference(want, want + BENCH_RAMP_SIZE,
+                             want + BENCH_RAMP_SIZE * 2, BENCH_RAMP_SIZE, t);
+        colorramp_fill(got, got + BENCH_RAMP_SIZE, got + BENCH_RAMP_SIZE * 2,
+                       BENCH_RAMP_SIZE, t);
+        if (memcmp(want, got, table_size) != 0) {
+            fprintf(stderr, "colorramp_bench: ramp mismatch at %dK\n", t);
+            return 1;
+        }
+    }
+
+    double reference = bench_run(bench_fill_reference, want);
+    double kernel = bench_run(colorramp_fill, got);
+
+    printf("%d entry ramp, %dK -> %dK in %dK steps\n", BENCH_RAMP_SIZE,
+           BENCH_TEMP_START, BENCH_TEMP_END, BENCH_TEMP_STEP);
+    printf("  pow() reference: %10.0f ns/ramp\n", reference);
+    printf("  colorramp_fill:  %10.0f ns/ramp (%.1fx)\n", kernel,
+           reference / kernel);
+
+    free(want);
+    free(got);
+    return 0;
+}
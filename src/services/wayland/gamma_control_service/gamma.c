@@ -1,9 +1,12 @@
+#define _GNU_SOURCE /* For memfd_create */
+
 #include "gamma.h"
 
 #include <adwaita.h>
 #include <fcntl.h> /* For O_* constants */
 #include <sys/mman.h>
 #include <sys/stat.h> /* For mode constants */
+#include <unistd.h>
 
 #include "../core.h"
 #include "colorramp.h"
@@ -26,6 +29,11 @@ struct _WaylandGammaControlService {
     GHashTable *controllers_by_proxy;
     // The last seen temperature
     double temperature;
+    // Computed gamma ramps keyed by (gamma_size << 32 | temperature), each
+    // value is a r, g, b table of gamma_size entries per channel.
+    GHashTable *ramp_cache;
+    // ramp_cache keys in insertion order, used to evict the oldest ramp.
+    GQueue *ramp_cache_order;
 };
 
 static guint service_signals[signals_n] = {0};
@@ -68,6 +76,9 @@ static void wayland_gamma_control_service_init(
         g_hash_table_new(g_direct_hash, g_direct_equal);
     self->controllers_by_proxy =
         g_hash_table_new(g_direct_hash, g_direct_equal);
+    self->ramp_cache =
+        g_hash_table_new_full(g_int64_hash, g_int64_equal, g_free, g_free);
+    self->ramp_cache_order = g_queue_new();
 };
 
 int wayland_gamma_control_service_global_init(
@@ -78,66 +89,84 @@ int wayland_gamma_control_service_global_init(
     return 0;
 };
 
-static void apply_gamma_control(WaylandGammaControlService *self,
-                                WaylandWLRGammaControl *ctrl) {
-    g_debug("gamma.c:wayland_wlr_gamma_control_apply() called");
-    // when we get here we must have the gamma ramp table size known
-    if (ctrl->gamma_size == 0) return;
+// Returns the r, g, b ramp for `gamma_size` and `temperature`, computing and
+// caching it if we haven't seen this combination yet. Animated transitions
+// walk the same temperatures on every output, so each ramp is computed once.
+static const uint16_t *gamma_ramp_lookup(WaylandGammaControlService *self,
+                                         uint32_t gamma_size,
+                                         int temperature) {
+    gint64 key = ((gint64)gamma_size << 32) | (guint32)temperature;
 
-    // get the total size needed for the gamma table.
-    size_t table_size = ctrl->gamma_size * 3 * sizeof(uint16_t);
+    uint16_t *ramp = g_hash_table_lookup(self->ramp_cache, &key);
+    if (ramp) return ramp;
 
-    // create unique name for our shared memory gamma table.
-    char shm_name[255];
-    snprintf(shm_name, 255, "/way-shell-ephemeral-gamma-table-%d", rand());
+    if (g_queue_get_length(self->ramp_cache_order) >= GAMMA_RAMP_CACHE_SIZE) {
+        gint64 *oldest = g_queue_pop_head(self->ramp_cache_order);
+        g_hash_table_remove(self->ramp_cache, oldest);
+    }
+
+    ramp = g_malloc(gamma_size * 3 * sizeof(uint16_t));
+    colorramp_fill(ramp, ramp + gamma_size, ramp + (gamma_size * 2),
+                   gamma_size, temperature);
+
+    gint64 *k = g_new(gint64, 1);
+    *k = key;
+    g_hash_table_insert(self->ramp_cache, k, ramp);
+    g_queue_push_tail(self->ramp_cache_order, k);
 
-    // we'll create a memory backed fd and share with Wayland.
-    int fd = shm_open(shm_name, O_RDWR | O_CREAT, 0666);
+    return ramp;
+}
+
+// Writes `ramp` to a new memfd and returns it rewound to the start, -1 on
+// error. Every set_gamma gets its own file, the compositor reads it from the
+// shared file offset at some later point, so a file must never be reused or
+// written to once sent.
+static int gamma_ramp_memfd(const uint16_t *ramp, size_t size) {
+    int fd = memfd_create("way-shell-gamma-table", MFD_CLOEXEC);
     if (fd < 0) {
-        g_error(
-            "gamma.c:wayland_wlr_gamma_control_apply() shm_open "
-            "failed: %s",
-            strerror(errno));
+        g_warning("gamma.c:gamma_ramp_memfd() memfd_create failed: %s",
+                  strerror(errno));
+        return -1;
     }
 
-    if (ftruncate(fd, table_size) < 0) {
-        g_error(
-            "gamma.c:wayland_wlr_gamma_control_apply() ftruncate "
-            "failed: %s",
-            strerror(errno));
+    const char *buf = (const char *)ramp;
+    while (size > 0) {
+        ssize_t n = write(fd, buf, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            g_warning("gamma.c:gamma_ramp_memfd() write failed: %s",
+                      strerror(errno));
+            close(fd);
+            return -1;
+        }
+        buf += n;
+        size -= n;
     }
 
-    uint16_t *table =
-        mmap(NULL, table_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-    if (table == MAP_FAILED) {
-        g_error(
-            "gamma.c:wayland_wlr_gamma_control_apply() mmap failed: "
-            "%s",
-            strerror(errno));
-    }
+    lseek(fd, 0, SEEK_SET);
+    return fd;
+}
 
-    // fill gammma table.
-    uint16_t *r = table;
-    uint16_t *g = table + ctrl->gamma_size;
-    uint16_t *b = table + (ctrl->gamma_size * 2);
-
-    /* Initialize gamma ramps to pure state */
-    for (int i = 0; i < ctrl->gamma_size; i++) {
-        uint16_t value = (double)i / ctrl->gamma_size * (UINT16_MAX + 1);
-        r[i] = value;
-        g[i] = value;
-        b[i] = value;
-    }
+static void apply_gamma_control(WaylandGammaControlService *self,
+                                WaylandWLRGammaControl *ctrl) {
+    g_debug("gamma.c:wayland_wlr_gamma_control_apply() called");
+    // when we get here we must have the gamma ramp table size known
+    if (ctrl->gamma_size == 0) return;
 
-    colorramp_fill(r, g, b, ctrl->gamma_size, ctrl->temperature);
+    // nothing to do, the compositor already has this ramp.
+    if (ctrl->applied_temperature == ctrl->temperature) return;
 
-    zwlr_gamma_control_v1_set_gamma(ctrl->control, fd);
+    const uint16_t *ramp =
+        gamma_ramp_lookup(self, ctrl->gamma_size, ctrl->temperature);
 
-    munmap(table, table_size);
-    shm_unlink(shm_name);
+    int fd = gamma_ramp_memfd(ramp, ctrl->gamma_size * 3 * sizeof(uint16_t));
+    if (fd < 0) return;
+
+    zwlr_gamma_control_v1_set_gamma(ctrl->control, fd);
+    // the request holds its own reference to the file until it is sent.
     close(fd);
 
-    ctrl->gamma_table_fd = fd;
+    ctrl->applied_temperature = ctrl->temperature;
 }
 
 static const struct zwlr_gamma_control_v1_listener gamma_control_listener;
@@ -152,7 +181,7 @@ static void on_wl_output_added(WaylandCoreService *core, GHashTable *outputs,
     ctrl->output = output;
     ctrl->temperature = self->temperature;
     ctrl->gamma_size = 0;
-    ctrl->gamma_table_fd = -1;
+    ctrl->applied_temperature = -1;
     ctrl->control = zwlr_gamma_control_manager_v1_get_gamma_control(
         self->mgr, output->output);
 
@@ -279,6 +308,8 @@ static void zwlr_gamma_control_handle_size(
 
     if (!ctrl) return;
 
+    // a new size requires a new ramp.
+    if (ctrl->gamma_size != size) ctrl->applied_temperature = -1;
     ctrl->gamma_size = size;
 
     if (self->enabled) {
@@ -304,6 +335,7 @@ static void zlwr_gamma_control_handle_failed(
     if (g) {
         g_hash_table_remove(self->controllers_by_output, g->output);
         g_hash_table_remove(self->controllers_by_proxy, ctrl);
+        g_free(g);
     }
 
     zwlr_gamma_control_v1_destroy(ctrl);
@@ -10,10 +10,14 @@ typedef struct _WaylandWLRGammaControl {
     struct zwlr_gamma_control_v1 *control;
     WaylandOutput *output;
     uint32_t gamma_size;
-    int gamma_table_fd;
     int temperature;
+    // the temperature last sent to the compositor, -1 if none.
+    int applied_temperature;
 } WaylandWLRGammaControl;
 
+// Maximum number of computed gamma ramps cached by (gamma_size, temperature).
+#define GAMMA_RAMP_CACHE_SIZE 128
+
 G_BEGIN_DECLS
 
 struct _WaylandGammaControlService;
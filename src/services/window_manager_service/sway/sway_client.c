@@ -259,18 +259,8 @@ int sway_client_parse_output_json(JsonObject *obj, WMOutput *o) {
     return 0;
 };
 
-static void free_output(gpointer data) {
-    WMOutput *o = (WMOutput *)data;
-    g_free(o->name);
-    g_free(o->make);
-    g_free(o->model);
-    g_free(o->serial);
-    g_free(o->current_workspace);
-    g_free(o);
-}
-
 GPtrArray *sway_client_ipc_get_outputs_resp(sway_client_ipc_msg *msg) {
-    GPtrArray *out = g_ptr_array_new_full(0, free_output);
+    GPtrArray *out = g_ptr_array_new_full(0, (GDestroyNotify)wm_output_free);
     JsonParser *parser = NULL;
     JsonReader *reader = NULL;
     GError *error = NULL;
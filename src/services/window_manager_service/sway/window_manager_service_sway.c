@@ -9,12 +9,22 @@
 #include "ipc.h"
 #include "sway_client.h"
 
-enum signals { workspaces_changed, outputs_changed, signals_n };
+enum signals {
+    workspaces_changed,
+    output_workspaces_changed,
+    outputs_changed,
+    signals_n
+};
 
 struct _WMServiceSway {
     GObject parent_instance;
     GPtrArray *workspaces;
+    // output name -> GPtrArray of WMWorkspace copies on that output, an
+    // output's array is only replaced when its workspaces change.
+    GHashTable *output_workspaces;
     GPtrArray *outputs;
+    // pending settle window for output events, see WM_SWAY_OUTPUT_SETTLE_MS.
+    guint output_settle_id;
     char *socket_path;
     int socket_fd;
     guint poll_id;
@@ -35,7 +45,11 @@ static void wm_service_sway_dispose(GObject *gobject) {
     // g_free socket path
     g_free(self->socket_path);
 
+    g_clear_handle_id(&self->output_settle_id, g_source_remove);
+
     if (self->workspaces) g_ptr_array_unref(self->workspaces);
+    if (self->outputs) g_ptr_array_unref(self->outputs);
+    g_clear_pointer(&self->output_workspaces, g_hash_table_unref);
 
     // Chain-up
     G_OBJECT_CLASS(wm_service_sway_parent_class)->dispose(gobject);
@@ -55,6 +69,13 @@ static void wm_service_sway_class_init(WMServiceSwayClass *klass) {
         "workspaces-changed", G_TYPE_FROM_CLASS(klass), G_SIGNAL_RUN_LAST, 0,
         NULL, NULL, NULL, G_TYPE_NONE, 1, G_TYPE_PTR_ARRAY);
 
+    // detailed by output name, handlers connected to
+    // "output-workspaces-changed::<output>" only run for that output.
+    service_signals[output_workspaces_changed] = g_signal_new(
+        "output-workspaces-changed", G_TYPE_FROM_CLASS(klass),
+        G_SIGNAL_RUN_LAST | G_SIGNAL_DETAILED, 0, NULL, NULL, NULL,
+        G_TYPE_NONE, 1, G_TYPE_PTR_ARRAY);
+
     service_signals[outputs_changed] = g_signal_new(
         "outputs-changed", G_TYPE_FROM_CLASS(klass), G_SIGNAL_RUN_LAST, 0, NULL,
         NULL, NULL, G_TYPE_NONE, 1, G_TYPE_PTR_ARRAY);
@@ -64,6 +85,83 @@ static gint compare_workspace_name(WMWorkspace **a, WMWorkspace **b) {
     return g_strcmp0((*a)->name, (*b)->name);
 }
 
+static gboolean workspace_list_equal(GPtrArray *a, GPtrArray *b) {
+    if (a->len != b->len) return FALSE;
+    for (guint i = 0; i < a->len; i++)
+        if (!wm_workspace_equal(g_ptr_array_index(a, i),
+                                g_ptr_array_index(b, i)))
+            return FALSE;
+    return TRUE;
+}
+
+// Splits self->workspaces by output and emits "output-workspaces-changed"
+// for each output whose workspaces differ from the last listing. Outputs
+// whose workspaces did not change keep their previous array, so pointers
+// consumers hold into it stay valid.
+static void wm_service_sway_partition_workspaces(WMServiceSway *self) {
+    GHashTable *partitions =
+        g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                              (GDestroyNotify)g_ptr_array_unref);
+    GPtrArray *changed = g_ptr_array_new_with_free_func(g_free);
+    GPtrArray *vanished = g_ptr_array_new_with_free_func(g_free);
+    GHashTableIter iter;
+    gchar *output;
+    GPtrArray *list;
+
+    for (guint i = 0; i < self->workspaces->len; i++) {
+        WMWorkspace *ws = g_ptr_array_index(self->workspaces, i);
+        if (!ws->output) continue;
+
+        list = g_hash_table_lookup(partitions, ws->output);
+        if (!list) {
+            list = g_ptr_array_new_with_free_func(
+                (GDestroyNotify)wm_workspace_free);
+            g_hash_table_insert(partitions, g_strdup(ws->output), list);
+        }
+        g_ptr_array_add(list, wm_workspace_copy(ws));
+    }
+
+    g_hash_table_iter_init(&iter, partitions);
+    while (g_hash_table_iter_next(&iter, (gpointer *)&output,
+                                  (gpointer *)&list)) {
+        GPtrArray *old = g_hash_table_lookup(self->output_workspaces, output);
+        if (old && workspace_list_equal(old, list))
+            g_hash_table_iter_replace(&iter, g_ptr_array_ref(old));
+        else
+            g_ptr_array_add(changed, g_strdup(output));
+    }
+
+    g_hash_table_iter_init(&iter, self->output_workspaces);
+    while (g_hash_table_iter_next(&iter, (gpointer *)&output, NULL)) {
+        if (!g_hash_table_contains(partitions, output))
+            g_ptr_array_add(vanished, g_strdup(output));
+    }
+
+    g_hash_table_unref(self->output_workspaces);
+    self->output_workspaces = partitions;
+
+    for (guint i = 0; i < changed->len; i++) {
+        output = g_ptr_array_index(changed, i);
+        list = g_hash_table_lookup(self->output_workspaces, output);
+        g_signal_emit(self, service_signals[output_workspaces_changed],
+                      g_quark_from_string(output), list);
+    }
+
+    // outputs left without workspaces are told so once, then forgotten.
+    if (vanished->len > 0) {
+        list = g_ptr_array_new();
+        for (guint i = 0; i < vanished->len; i++) {
+            output = g_ptr_array_index(vanished, i);
+            g_signal_emit(self, service_signals[output_workspaces_changed],
+                          g_quark_from_string(output), list);
+        }
+        g_ptr_array_unref(list);
+    }
+
+    g_ptr_array_unref(changed);
+    g_ptr_array_unref(vanished);
+}
+
 static void handle_ipc_get_workspaces(WMServiceSway *self,
                                       sway_client_ipc_msg *msg) {
     GPtrArray *tmp = sway_client_ipc_get_workspaces_resp(msg);
@@ -87,6 +185,36 @@ static void handle_ipc_get_workspaces(WMServiceSway *self,
     // emit signal
     g_signal_emit(self, service_signals[workspaces_changed], 0,
                   self->workspaces);
+
+    wm_service_sway_partition_workspaces(self);
+}
+
+// Returns the output in `list` which is the same physical output as `o`.
+static WMOutput *output_list_find(GPtrArray *list, WMOutput *o) {
+    for (guint i = 0; i < list->len; i++) {
+        WMOutput *candidate = g_ptr_array_index(list, i);
+        if (wm_output_same(candidate, o)) return candidate;
+    }
+    return NULL;
+}
+
+// Diffs `new` against `old` keyed by connector name and serial, returning the
+// number of outputs which were added, removed or changed. Order is ignored,
+// sway may list the same outputs in a different order across hotplugs.
+static guint output_list_diff(GPtrArray *old, GPtrArray *new) {
+    guint changes = 0;
+
+    if (!old) return new->len > 0 ? new->len : 1;
+
+    for (guint i = 0; i < new->len; i++) {
+        WMOutput *o = g_ptr_array_index(new, i);
+        WMOutput *prev = output_list_find(old, o);
+        if (!prev || !wm_output_equal(prev, o)) changes++;
+    }
+    for (guint i = 0; i < old->len; i++) {
+        if (!output_list_find(new, g_ptr_array_index(old, i))) changes++;
+    }
+    return changes;
 }
 
 static void handle_ipc_get_outputs(WMServiceSway *self,
@@ -94,11 +222,25 @@ static void handle_ipc_get_outputs(WMServiceSway *self,
     GPtrArray *tmp = sway_client_ipc_get_outputs_resp(msg);
 
     g_debug(
-        "window_manager_service_sway.c:handle_ipc_get_workspaces() "
+        "window_manager_service_sway.c:handle_ipc_get_outputs() "
         "called");
 
     if (!tmp) return;
 
+    guint changes = output_list_diff(self->outputs, tmp);
+    if (changes == 0) {
+        g_debug(
+            "window_manager_service_sway.c:handle_ipc_get_outputs() "
+            "outputs unchanged, not emitting.");
+        g_ptr_array_unref(tmp);
+        return;
+    }
+
+    g_debug(
+        "window_manager_service_sway.c:handle_ipc_get_outputs() "
+        "%u output(s) added, removed or changed.",
+        changes);
+
     if (self->outputs) {
         g_ptr_array_unref(self->outputs);
     }
@@ -152,12 +294,26 @@ static void handle_ipc_event_workspaces(WMServiceSway *self,
     sway_client_ipc_get_workspaces_req(self->socket_fd);
 };
 
+static gboolean on_output_settle(WMServiceSway *self) {
+    g_debug(
+        "window_manager_service_sway.c:on_output_settle() "
+        "outputs settled, getting latest output listing.");
+    self->output_settle_id = 0;
+    sway_client_ipc_get_outputs_req(self->socket_fd);
+    return G_SOURCE_REMOVE;
+}
+
 static void handle_ipc_event_outputs(WMServiceSway *self,
                                      sway_client_ipc_msg *msg) {
     g_debug(
         "window_manager_service_sway.c:handle_ipc_event_outputs() "
-        "received output event, getting latest output listing.");
-    sway_client_ipc_get_outputs_req(self->socket_fd);
+        "received output event, restarting settle window.");
+
+    // a hotplug storm only costs a single GET_OUTPUTS round trip once sway
+    // stops sending events.
+    g_clear_handle_id(&self->output_settle_id, g_source_remove);
+    self->output_settle_id = g_timeout_add(
+        WM_SWAY_OUTPUT_SETTLE_MS, (GSourceFunc)on_output_settle, self);
 };
 
 static void on_ipc_recv_dispatch(WMServiceSway *self,
@@ -250,6 +406,10 @@ static void on_sort_alphabetical_changed(GSettings *settings, gchar *key,
 }
 
 static void wm_service_sway_init(WMServiceSway *self) {
+    self->output_workspaces =
+        g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                              (GDestroyNotify)g_ptr_array_unref);
+
     self->socket_path = sway_client_find_socket_path();
     if (!self->socket_path)
         g_error(
@@ -297,6 +457,16 @@ GPtrArray *wm_service_sway_get_workspaces(WindowManager *wm) {
     return g_ptr_array_ref(self->workspaces);
 }
 
+GPtrArray *wm_service_sway_get_output_workspaces(WindowManager *wm,
+                                                 const gchar *output) {
+    WMServiceSway *self = wm->private;
+
+    GPtrArray *list = g_hash_table_lookup(self->output_workspaces, output);
+    if (!list) return NULL;
+
+    return g_ptr_array_ref(list);
+}
+
 GPtrArray *wm_service_sway_get_outputs(WindowManager *wm) {
     WMServiceSway *self = wm->private;
 
@@ -375,6 +545,30 @@ guint wm_service_sway_unregister_on_workspaces_changed(
     return g_signal_handlers_disconnect_by_func(self, cb, data);
 }
 
+guint wm_service_sway_register_on_output_workspaces_changed(
+    WindowManager *wm, const gchar *output, wm_on_workspaces_changed cb,
+    void *data) {
+    WMServiceSway *self = wm->private;
+
+    gchar *signal = g_strdup_printf("output-workspaces-changed::%s", output);
+    guint id = g_signal_connect_swapped(self, signal, G_CALLBACK(cb), data);
+    g_free(signal);
+
+    return id;
+}
+
+guint wm_service_sway_unregister_on_output_workspaces_changed(
+    WindowManager *wm, const gchar *output, wm_on_workspaces_changed cb,
+    void *data) {
+    WMServiceSway *self = wm->private;
+
+    return g_signal_handlers_disconnect_matched(
+        self, G_SIGNAL_MATCH_ID | G_SIGNAL_MATCH_DETAIL | G_SIGNAL_MATCH_FUNC |
+                  G_SIGNAL_MATCH_DATA,
+        service_signals[output_workspaces_changed],
+        g_quark_from_string(output), NULL, cb, data);
+}
+
 guint wm_service_sway_register_on_outputs_changed(WindowManager *wm,
                                                   wm_on_outputs_changed cb,
                                                   void *data) {
@@ -402,6 +596,7 @@ WindowManager *wm_service_sway_window_manager_init() {
     // write virt func table.
     wm->private = self;
     wm->get_workspaces = wm_service_sway_get_workspaces;
+    wm->get_output_workspaces = wm_service_sway_get_output_workspaces;
     wm->get_outputs = wm_service_sway_get_outputs;
     wm->focus_workspace = wm_service_sway_focus_workspace;
     wm->rename_workspace = wm_service_sway_rename_current_workspace;
@@ -411,6 +606,10 @@ WindowManager *wm_service_sway_window_manager_init() {
         wm_service_sway_register_on_workspaces_changed;
     wm->unregister_on_workspaces_changed =
         wm_service_sway_unregister_on_workspaces_changed;
+    wm->register_on_output_workspaces_changed =
+        wm_service_sway_register_on_output_workspaces_changed;
+    wm->unregister_on_output_workspaces_changed =
+        wm_service_sway_unregister_on_output_workspaces_changed;
     wm->register_on_outputs_changed =
         wm_service_sway_register_on_outputs_changed;
     wm->unregister_on_outputs_changed =
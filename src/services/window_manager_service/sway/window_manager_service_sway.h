@@ -4,6 +4,11 @@
 
 #include "../window_manager_service.h"
 
+// Sway sends a burst of output events when monitors are docked or undocked.
+// Output events restart a settle window of this many milliseconds and a
+// single GET_OUTPUTS request is issued once it expires.
+#define WM_SWAY_OUTPUT_SETTLE_MS 250
+
 G_BEGIN_DECLS
 
 struct _WMServiceSway;
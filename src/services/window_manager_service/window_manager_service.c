@@ -8,6 +8,56 @@ char *WMWorkspaceEventStringTbl[WMWORKSPACE_EVENT_LEN] = {
     "CREATED", "DESTROYED", "FOCUSED", "MOVED", "RENAMED", "URGENT", "RELOAD",
 };
 
+WMWorkspace *wm_workspace_copy(const WMWorkspace *ws) {
+    WMWorkspace *copy = g_memdup2(ws, sizeof(WMWorkspace));
+    copy->name = g_strdup(ws->name);
+    copy->output = g_strdup(ws->output);
+    return copy;
+}
+
+void wm_workspace_free(WMWorkspace *ws) {
+    g_free(ws->name);
+    g_free(ws->output);
+    g_free(ws);
+}
+
+gboolean wm_workspace_equal(const WMWorkspace *a, const WMWorkspace *b) {
+    return a->id == b->id && a->num == b->num && a->urgent == b->urgent &&
+           a->focused == b->focused && a->visible == b->visible &&
+           g_strcmp0(a->name, b->name) == 0 &&
+           g_strcmp0(a->output, b->output) == 0;
+}
+
+WMOutput *wm_output_copy(const WMOutput *o) {
+    WMOutput *copy = g_malloc0(sizeof(WMOutput));
+    copy->name = g_strdup(o->name);
+    copy->make = g_strdup(o->make);
+    copy->model = g_strdup(o->model);
+    copy->serial = g_strdup(o->serial);
+    copy->current_workspace = g_strdup(o->current_workspace);
+    return copy;
+}
+
+void wm_output_free(WMOutput *o) {
+    g_free(o->name);
+    g_free(o->make);
+    g_free(o->model);
+    g_free(o->serial);
+    g_free(o->current_workspace);
+    g_free(o);
+}
+
+gboolean wm_output_same(const WMOutput *a, const WMOutput *b) {
+    return g_strcmp0(a->name, b->name) == 0 &&
+           g_strcmp0(a->serial, b->serial) == 0;
+}
+
+gboolean wm_output_equal(const WMOutput *a, const WMOutput *b) {
+    return wm_output_same(a, b) && g_strcmp0(a->make, b->make) == 0 &&
+           g_strcmp0(a->model, b->model) == 0 &&
+           g_strcmp0(a->current_workspace, b->current_workspace) == 0;
+}
+
 // Initialize the window manager service
 int window_manager_service_init() {
     GSettings *settings =
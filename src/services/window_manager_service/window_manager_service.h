@@ -46,6 +46,15 @@ typedef struct _WMWorkspace {
     gboolean empty;
 } WMWorkspace;
 
+// Returns a deep copy of `ws`, free with `wm_workspace_free`.
+WMWorkspace *wm_workspace_copy(const WMWorkspace *ws);
+
+void wm_workspace_free(WMWorkspace *ws);
+
+// Returns TRUE if `a` and `b` would render identically, i.e. every field a
+// consumer displays or acts on is equal.
+gboolean wm_workspace_equal(const WMWorkspace *a, const WMWorkspace *b);
+
 typedef struct _WMWorkspaceEvent {
     WMWorkspaceEventType type;
     WMWorkspace workspace;
@@ -62,6 +71,18 @@ typedef struct _WMOutput {
     gchar *current_workspace;
 } WMOutput;
 
+// Returns a deep copy of `o`, free with `wm_output_free`.
+WMOutput *wm_output_copy(const WMOutput *o);
+
+void wm_output_free(WMOutput *o);
+
+// Returns TRUE if `a` and `b` describe the same physical output, i.e. they
+// share a connector name and serial.
+gboolean wm_output_same(const WMOutput *a, const WMOutput *b);
+
+// Returns TRUE if `a` and `b` are the same output with identical fields.
+gboolean wm_output_equal(const WMOutput *a, const WMOutput *b);
+
 // WinowManager is a virtual function table which abstracts an underlying
 // window manager implementation.
 //
@@ -70,6 +91,9 @@ typedef struct _WMOutput {
 typedef struct _WindowManager WindowManager;
 typedef GPtrArray *(*wm_get_workspaces_func)(WindowManager *self);
 
+typedef GPtrArray *(*wm_get_output_workspaces_func)(WindowManager *self,
+                                                    const gchar *output);
+
 typedef GPtrArray *(*wm_get_outputs_func)(WindowManager *self);
 
 typedef int (*wm_focus_workspace_func)(WindowManager *self, WMWorkspace *ws);
@@ -93,6 +117,14 @@ typedef guint (*wm_register_on_workspaces_changed)(WindowManager *self,
 typedef guint (*wm_unregister_on_workspaces_changed)(
     WindowManager *self, wm_on_workspaces_changed cb, void *data);
 
+typedef guint (*wm_register_on_output_workspaces_changed)(
+    WindowManager *self, const gchar *output, wm_on_workspaces_changed cb,
+    void *data);
+
+typedef guint (*wm_unregister_on_output_workspaces_changed)(
+    WindowManager *self, const gchar *output, wm_on_workspaces_changed cb,
+    void *data);
+
 typedef guint (*wm_register_on_outputs_changed)(WindowManager *self,
                                                 wm_on_outputs_changed cb,
                                                 void *data);
@@ -107,6 +139,9 @@ typedef struct _WindowManager {
     void *private;
     // Provide a list of currently available workspaces
     wm_get_workspaces_func get_workspaces;
+    // Provide a list of the workspaces on the named output, the list is kept
+    // by the service and identical until the output's workspaces change.
+    wm_get_output_workspaces_func get_output_workspaces;
     // Provide a list of currently available outputs
     wm_get_outputs_func get_outputs;
     // Focus the provided workspace
@@ -122,6 +157,15 @@ typedef struct _WindowManager {
     wm_register_on_workspaces_changed register_on_workspaces_changed;
     // unregister a callback when workspaces has changed.
     wm_unregister_on_workspaces_changed unregister_on_workspaces_changed;
+    // register a callback when the workspaces on the named output have
+    // changed, the callback is passed only that output's workspaces.
+    // returns the GObject signal ID on success.
+    wm_register_on_output_workspaces_changed
+        register_on_output_workspaces_changed;
+    // unregister a callback when the workspaces on the named output have
+    // changed.
+    wm_unregister_on_output_workspaces_changed
+        unregister_on_output_workspaces_changed;
     // register a callback when outputs has changed.
     // returns the GObject signal ID on success.
     wm_register_on_outputs_changed register_on_outputs_changed;
@@ -1,11 +1,8 @@
 #include "wireplumber_service.h"
 
 #include <adwaita.h>
+#include <math.h>
 #include <pipewire/keys.h>
-#include <pulse/context.h>
-#include <pulse/glib-mainloop.h>
-#include <pulse/introspect.h>
-#include <pulse/pulseaudio.h>
 #include <wireplumber-0.5/wp/component-loader.h>
 #include <wireplumber-0.5/wp/wp.h>
 
@@ -13,6 +10,7 @@
 #include "wp/global-proxy.h"
 #include "wp/iterator.h"
 #include "wp/link.h"
+#include "wp/metadata.h"
 #include "wp/node.h"
 #include "wp/object-interest.h"
 #include "wp/object-manager.h"
@@ -23,8 +21,16 @@ enum signals {
     // a particular node's detail has changed, a signal with the pointer to the
     // node is emitted.
     node_changed,
-    // an object has been added or removed from the object database, a signal
-    // with the GHashTable database is emitted.
+    // an object has been inventoried, a signal with the pointer to its
+    // WirePlumberServiceNodeHeader is emitted.
+    node_added,
+    // an object is about to be removed from the inventory, a signal with the
+    // pointer to its WirePlumberServiceNodeHeader is emitted, the pointer is
+    // freed once the handlers return.
+    node_removed,
+    // a batch of objects has been added or removed from the object database,
+    // a signal with the GHashTable database is emitted. Prefer node-added and
+    // node-removed, this is emitted after them.
     database_changed,
     // the default sink has changed, a signal with the default sink is emitted.
     default_sink_changed,
@@ -38,13 +44,57 @@ enum signals {
     // event fires on more then just volume changes (like link changes).
     default_source_volume_changed,
     // a signal emitted with a boolean informing if any microphone is currently
-    // listening.
+    // listening, emitted only when that changes.
     microphone_active,
     signals_n
 };
 
 static WirePlumberService *global = NULL;
 
+// Volumes closer than this are the same volume, the mixer round trips the
+// cubic volume through a float.
+#define VOLUME_EPSILON 0.0005
+
+// Number of recent writes remembered per node to recognize their echoes, about
+// WIRE_PLUMBER_SERVICE_VOLUME_ECHO_MS worth of writes.
+#define VOLUME_ECHO_HISTORY 16
+
+// A volume change queued by the volume controller. Volumes are in the same
+// cubic UI scale as WirePlumberServiceNode.volume, not linear.
+typedef struct _VolumeTarget {
+    guint32 id;
+    gdouble from;
+    gdouble target;
+    // monotonic time the ramp from -> target started and its length, both in
+    // microseconds, a zero duration jumps straight to target.
+    gint64 start;
+    gint64 duration;
+    // last volume written to the mixer and when, written is -1 until the
+    // first write.
+    gdouble written;
+    gint64 written_at;
+    // ring of the most recent writes, echoes of these are ours.
+    gdouble history[VOLUME_ECHO_HISTORY];
+    guint history_len;
+    guint history_head;
+} VolumeTarget;
+
+static void volume_target_record_write(VolumeTarget *t, gdouble volume,
+                                       gint64 now) {
+    t->written = volume;
+    t->written_at = now;
+    t->history[t->history_head] = volume;
+    t->history_head = (t->history_head + 1) % VOLUME_ECHO_HISTORY;
+    if (t->history_len < VOLUME_ECHO_HISTORY) t->history_len++;
+}
+
+// Whether `volume` is one we recently wrote for this node.
+static gboolean volume_target_wrote(VolumeTarget *t, gdouble volume) {
+    for (guint i = 0; i < t->history_len; i++)
+        if (fabs(t->history[i] - volume) <= VOLUME_EPSILON) return true;
+    return false;
+}
+
 struct _WirePlumberService {
     GObject parent_instance;
     WpCore *core;
@@ -56,27 +106,38 @@ struct _WirePlumberService {
     guint32 default_sink_id;
     guint32 default_source_id;
 
-    // we still need to use pulse audio because WirePlumber alone does not know
-    // how to restore stream sink/sources on flap.
-    struct pa_context *pa_ctx;
-    struct pa_glib_mainloop *pa_loop;
-    struct pa_mainloop_api *pa_api;
+    // the "default" metadata object, streams are routed by setting their
+    // target.object key, which WirePlumber's policy links and restores on
+    // flap. NULL until the session manager exports it.
+    WpMetadata *metadata;
 
     GPtrArray *sinks;
     GPtrArray *sources;
     GPtrArray *streams;
     GPtrArray *links;
     GHashTable *db;
-    guint32 pending_output_stream;
-    guint32 pending_sink;
-    guint32 pending_input_stream;
-    guint32 pending_source;
+    // WpObject -> bound id for every inventoried object, removed objects may
+    // already be unbound.
+    GHashTable *proxies;
+    // stream id -> target node id for moves requested before the metadata
+    // object was available, each stream has at most one move in flight and a
+    // newer request for the same stream replaces the older one.
+    GHashTable *pending_moves;
+    // node id -> VolumeTarget, volume changes waiting to be written or whose
+    // echoes are still expected.
+    GHashTable *volume_targets;
+    guint volume_flush_id;
+    // number of sources in the running state, a source runs while something
+    // captures from it.
+    guint running_sources;
     int pending_plugins;
 };
 
 static guint service_signals[signals_n] = {0};
 G_DEFINE_TYPE(WirePlumberService, wire_plumber_service, G_TYPE_OBJECT);
 
+static void wire_plumber_service_flush_moves(WirePlumberService *self);
+
 // stub out dispose, finalize, class init and init methods for this GObject
 // class.
 static void wire_plumber_service_dispose(GObject *gobject) {
@@ -99,6 +160,14 @@ static void wire_plumber_service_class_init(WirePlumberServiceClass *klass) {
         "node-changed", G_TYPE_FROM_CLASS(object_class), G_SIGNAL_RUN_FIRST, 0,
         NULL, NULL, NULL, G_TYPE_NONE, 1, G_TYPE_POINTER);
 
+    service_signals[node_added] = g_signal_new(
+        "node-added", G_TYPE_FROM_CLASS(object_class), G_SIGNAL_RUN_FIRST, 0,
+        NULL, NULL, NULL, G_TYPE_NONE, 1, G_TYPE_POINTER);
+
+    service_signals[node_removed] = g_signal_new(
+        "node-removed", G_TYPE_FROM_CLASS(object_class), G_SIGNAL_RUN_FIRST, 0,
+        NULL, NULL, NULL, G_TYPE_NONE, 1, G_TYPE_POINTER);
+
     // define 'database_changed' signal
     service_signals[database_changed] = g_signal_new(
         "database-changed", G_TYPE_FROM_CLASS(object_class), G_SIGNAL_RUN_FIRST,
@@ -134,15 +203,19 @@ static void wire_plumber_service_class_init(WirePlumberServiceClass *klass) {
 };
 
 gboolean wire_plumber_service_microphone_active(WirePlumberService *self) {
-    gboolean active = false;
-    for (int i = 0; i < self->sources->len; i++) {
-        WirePlumberServiceNode *node = g_ptr_array_index(self->sources, i);
-        if (node->state == WP_NODE_STATE_RUNNING) {
-            active = true;
-            break;
-        }
-    }
-    return active;
+    return self->running_sources > 0;
+}
+
+// Accounts for a source moving between running and not running. Returns TRUE
+// when this flips whether any microphone is active.
+static gboolean wire_plumber_service_count_running_source(
+    WirePlumberService *self, gboolean was_running, gboolean running) {
+    if (was_running == running) return false;
+
+    if (running) return ++self->running_sources == 1;
+
+    g_return_val_if_fail(self->running_sources > 0, false);
+    return --self->running_sources == 0;
 }
 
 static void wire_plumber_service_clean_audio_node(
@@ -153,6 +226,8 @@ static void wire_plumber_service_clean_audio_node(
     node->name = NULL;
     g_free((void *)node->app_name);
     node->app_name = NULL;
+    g_free((void *)node->media_name);
+    node->media_name = NULL;
 }
 
 static void wire_plumber_service_fill_audio_stream(
@@ -211,6 +286,10 @@ static void wire_plumber_service_clean_source_sink_node(
     node->name = NULL;
     g_free((void *)node->nick_name);
     node->nick_name = NULL;
+    g_free((void *)node->proper_name);
+    node->proper_name = NULL;
+    g_free((void *)node->serial);
+    node->serial = NULL;
 }
 
 static void wire_plumber_service_fill_node(WirePlumberServiceNode *node,
@@ -249,6 +328,8 @@ static void wire_plumber_service_fill_node(WirePlumberServiceNode *node,
         WP_PIPEWIRE_OBJECT(proxy), PW_KEY_NODE_NICK));
     node->proper_name = g_strdup(wp_pipewire_object_get_property(
         WP_PIPEWIRE_OBJECT(proxy), PW_KEY_NODE_NAME));
+    node->serial = g_strdup(wp_pipewire_object_get_property(
+        WP_PIPEWIRE_OBJECT(proxy), PW_KEY_OBJECT_SERIAL));
 
     // check media type and set actual type
     if (g_strcmp0(node->media_class, "Audio/Sink") == 0) {
@@ -309,6 +390,8 @@ WirePlumberServiceLink *wire_plumber_service_link_new(
 }
 
 static void on_mixer_changed(void *_, guint id, WirePlumberService *self) {
+    gboolean microphone_edge = false;
+
     g_debug("wireplumber_service.c:on_mixer_changed() called");
 
     WpGlobalProxy *pw = wp_object_manager_lookup(self->om, WP_TYPE_GLOBAL_PROXY,
@@ -336,6 +419,7 @@ static void on_mixer_changed(void *_, guint id, WirePlumberService *self) {
 
         double old_volume = node->volume;
         gboolean old_mute = node->mute;
+        WpNodeState old_state = node->state;
 
         g_debug(
             "wireplumber_service.c:on_node_property_change() id: %d, name: %s, "
@@ -348,6 +432,37 @@ static void on_mixer_changed(void *_, guint id, WirePlumberService *self) {
         wire_plumber_service_fill_node((WirePlumberServiceNode *)node,
                                        WP_GLOBAL_PROXY(pw), self);
 
+        if (node->type == WIRE_PLUMBER_SERVICE_TYPE_SOURCE)
+            microphone_edge = wire_plumber_service_count_running_source(
+                self, old_state == WP_NODE_STATE_RUNNING,
+                node->state == WP_NODE_STATE_RUNNING);
+
+        // while the controller is writing this node the mixer echoes every
+        // intermediate value back, sometimes late. only the echo of the most
+        // recent write is news, older ones would drag listeners backwards.
+        VolumeTarget *t =
+            g_hash_table_lookup(self->volume_targets, GUINT_TO_POINTER(id));
+        if (t && t->written >= 0 && node->mute == old_mute &&
+            node->state == old_state &&
+            fabs(node->volume - t->written) > VOLUME_EPSILON) {
+            if (volume_target_wrote(t, node->volume)) {
+                g_debug(
+                    "wireplumber_service.c:on_mixer_changed() dropping stale "
+                    "volume echo id: %d volume: %f written: %f",
+                    id, node->volume, t->written);
+                node->volume = old_volume;
+                return;
+            }
+
+            // a volume we never wrote, someone else changed it. stop the
+            // controller so it doesn't fight the change and let it through.
+            g_debug(
+                "wireplumber_service.c:on_mixer_changed() external volume "
+                "change id: %d volume: %f",
+                id, node->volume);
+            g_hash_table_remove(self->volume_targets, GUINT_TO_POINTER(id));
+        }
+
         if (node == self->default_sink) {
             g_signal_emit(self, service_signals[default_sink_changed], 0, node);
             if (node->volume != old_volume || node->mute != old_mute) {
@@ -386,10 +501,9 @@ static void on_mixer_changed(void *_, guint id, WirePlumberService *self) {
 
     g_signal_emit(self, service_signals[node_changed], 0, header);
 
-    if (wire_plumber_service_microphone_active(self))
-        g_signal_emit(self, service_signals[microphone_active], 0, true);
-    else
-        g_signal_emit(self, service_signals[microphone_active], 0, false);
+    if (microphone_edge)
+        g_signal_emit(self, service_signals[microphone_active], 0,
+                      wire_plumber_service_microphone_active(self));
 }
 
 static void on_state_change(WpNode *node, WpNodeState old_state,
@@ -399,81 +513,6 @@ static void on_state_change(WpNode *node, WpNodeState old_state,
     on_mixer_changed(NULL, id, self);
 }
 
-static void wire_plumber_service_prune_db(WirePlumberService *self) {
-    g_auto(GValue) value = G_VALUE_INIT;
-    WpIterator *it = NULL;
-    GHashTable *set = g_hash_table_new(g_direct_hash, g_direct_equal);
-
-    // create set
-    it = wp_object_manager_new_iterator(self->om);
-
-    for (; wp_iterator_next(it, &value); g_value_unset(&value)) {
-        GObject *obj = g_value_get_object(&value);
-        guint32 id = wp_proxy_get_bound_id(WP_PROXY(obj));
-        g_hash_table_add(set, GUINT_TO_POINTER(id));
-    }
-
-    GHashTableIter iter;
-    gpointer key, val;
-    GList *keys_to_remove = NULL;
-    GList *i;
-
-    g_hash_table_iter_init(&iter, self->db);
-    while (g_hash_table_iter_next(&iter, &key, &val)) {
-        if (!g_hash_table_contains(set, key)) {
-            keys_to_remove = g_list_prepend(keys_to_remove, key);
-        }
-    }
-    for (i = keys_to_remove; i != NULL; i = i->next) {
-        g_hash_table_remove(self->db, i->data);
-    }
-    g_list_free(keys_to_remove);
-
-    // prune sinks array
-    if (self->sinks->len > 0)
-        for (int i = self->sinks->len - 1; i >= 0; i--) {
-            WirePlumberServiceNode *node = g_ptr_array_index(self->sinks, i);
-            if (!g_hash_table_contains(set, GUINT_TO_POINTER(node->id))) {
-                g_ptr_array_remove_index(self->sinks, i);
-                wire_plumber_service_clean_source_sink_node(node);
-                g_free(node);
-            }
-        }
-
-    // prune source array
-    if (self->sinks->len > 0)
-        for (int i = self->sources->len - 1; i >= 0; i--) {
-            WirePlumberServiceNode *node = g_ptr_array_index(self->sources, i);
-            if (!g_hash_table_contains(set, GUINT_TO_POINTER(node->id))) {
-                g_ptr_array_remove_index(self->sources, i);
-                wire_plumber_service_clean_source_sink_node(node);
-                g_free(node);
-            }
-        }
-
-    // prune streams
-    if (self->streams->len > 0)
-        for (int i = self->streams->len - 1; i >= 0; i--) {
-            WirePlumberServiceAudioStream *stream =
-                g_ptr_array_index(self->streams, i);
-            if (!g_hash_table_contains(set, GUINT_TO_POINTER(stream->id))) {
-                g_ptr_array_remove_index(self->streams, i);
-                wire_plumber_service_clean_audio_node(stream);
-                g_free(stream);
-            }
-        }
-
-    // prune links
-    if (self->links->len > 0)
-        for (int i = self->links->len - 1; i >= 0; i--) {
-            WirePlumberServiceLink *link = g_ptr_array_index(self->links, i);
-            if (!g_hash_table_contains(set, GUINT_TO_POINTER(link->id))) {
-                g_ptr_array_remove_index(self->links, i);
-                g_free(link);
-            }
-        }
-}
-
 WirePlumberServiceNode *wire_plumber_service_node_new(
     WpGlobalProxy *proxy, WirePlumberService *self) {
     g_debug("wireplumber_service.c:set_default_source() called");
@@ -497,157 +536,243 @@ WirePlumberServiceAudioStream *wire_plumber_service_audio_stream_new(
     return node;
 }
 
-static void on_object_manager_change_get_source_sinks(WpObjectManager *om,
-                                                      WirePlumberService *self,
-                                                      char *media_class) {
-    g_auto(GValue) value = G_VALUE_INIT;
-    WpIterator *it = NULL;
-    GPtrArray *node_array = NULL;
-    WirePlumberServiceNode **default_node;
-    guint32 default_node_id = 0;
-
-    g_debug("wireplumber_service.c:on_object_manager_change() called");
+// Returns the typed array objects of `type` are indexed in.
+static GPtrArray *wire_plumber_service_index(WirePlumberService *self,
+                                            enum WirePlumberServiceType type) {
+    switch (type) {
+        case WIRE_PLUMBER_SERVICE_TYPE_SINK:
+            return self->sinks;
+        case WIRE_PLUMBER_SERVICE_TYPE_SOURCE:
+            return self->sources;
+        case WIRE_PLUMBER_SERVICE_TYPE_INPUT_AUDIO_STREAM:
+        case WIRE_PLUMBER_SERVICE_TYPE_OUTPUT_AUDIO_STREAM:
+            return self->streams;
+        case WIRE_PLUMBER_SERVICE_TYPE_LINK:
+            return self->links;
+        default:
+            return NULL;
+    }
+}
 
-    if (g_strcmp0(media_class, "Audio/Sink") == 0) {
-        node_array = self->sinks;
-        default_node = &self->default_sink;
-        default_node_id = self->default_sink_id;
+static void wire_plumber_service_free_object(
+    WirePlumberServiceNodeHeader *header) {
+    switch (header->type) {
+        case WIRE_PLUMBER_SERVICE_TYPE_SINK:
+        case WIRE_PLUMBER_SERVICE_TYPE_SOURCE:
+            wire_plumber_service_clean_source_sink_node(
+                (WirePlumberServiceNode *)header);
+            break;
+        case WIRE_PLUMBER_SERVICE_TYPE_INPUT_AUDIO_STREAM:
+        case WIRE_PLUMBER_SERVICE_TYPE_OUTPUT_AUDIO_STREAM:
+            wire_plumber_service_clean_audio_node(
+                (WirePlumberServiceAudioStream *)header);
+            break;
+        default:
+            break;
     }
+    g_free(header);
+}
 
-    if (g_strcmp0(media_class, "Audio/Source") == 0) {
-        node_array = self->sources;
-        default_node = &self->default_source;
-        default_node_id = self->default_source_id;
+static void on_node_properties_changed(WpNode *node, GParamSpec *pspec,
+                                       WirePlumberService *self) {
+    g_debug("wireplumber_service.c:on_node_properties_changed() called");
+    guint32 id = wp_proxy_get_bound_id(WP_PROXY(node));
+    on_mixer_changed(NULL, id, self);
+}
+
+// Inventories a single object from the object manager, inserting it into the
+// db and its typed array. Returns NULL if the object is not one we track or
+// is already inventoried.
+static WirePlumberServiceNodeHeader *wire_plumber_service_add_object(
+    WirePlumberService *self, GObject *obj) {
+    WirePlumberServiceNodeHeader *header = NULL;
+    guint32 id = wp_proxy_get_bound_id(WP_PROXY(obj));
+
+    if (g_hash_table_contains(self->db, GUINT_TO_POINTER(id))) return NULL;
+
+    if (WP_IS_LINK(obj)) {
+        header = (WirePlumberServiceNodeHeader *)wire_plumber_service_link_new(
+            WP_GLOBAL_PROXY(obj), self);
+    } else if (WP_IS_NODE(obj)) {
+        const gchar *media_class = wp_pipewire_object_get_property(
+            WP_PIPEWIRE_OBJECT(obj), PW_KEY_MEDIA_CLASS);
+
+        switch (wire_plumber_service_media_class_to_type(media_class)) {
+            case WIRE_PLUMBER_SERVICE_TYPE_SINK:
+            case WIRE_PLUMBER_SERVICE_TYPE_SOURCE:
+                header = (WirePlumberServiceNodeHeader *)
+                    wire_plumber_service_node_new(WP_GLOBAL_PROXY(obj), self);
+                break;
+            case WIRE_PLUMBER_SERVICE_TYPE_INPUT_AUDIO_STREAM:
+            case WIRE_PLUMBER_SERVICE_TYPE_OUTPUT_AUDIO_STREAM:
+                header = (WirePlumberServiceNodeHeader *)
+                    wire_plumber_service_audio_stream_new(WP_GLOBAL_PROXY(obj),
+                                                          self);
+                break;
+            default:
+                return NULL;
+        }
+
+        // connect to state changes to monitor devices state.
+        g_signal_connect(obj, "state-changed", G_CALLBACK(on_state_change),
+                         self);
+        // descriptions and nicks can change after the node is bound.
+        g_signal_connect(obj, "notify::properties",
+                         G_CALLBACK(on_node_properties_changed), self);
+    } else {
+        return NULL;
     }
 
-    it = wp_object_manager_new_filtered_iterator(
-        self->om, WP_TYPE_NODE, WP_CONSTRAINT_TYPE_PW_PROPERTY,
-        PW_KEY_MEDIA_CLASS, "=s", media_class, NULL);
+    g_hash_table_insert(self->db, GUINT_TO_POINTER(id), header);
+    g_hash_table_insert(self->proxies, obj, GUINT_TO_POINTER(id));
+    g_ptr_array_add(wire_plumber_service_index(self, header->type), header);
 
-    for (; wp_iterator_next(it, &value); g_value_unset(&value)) {
-        GObject *obj = g_value_get_object(&value);
-        guint32 id = wp_proxy_get_bound_id(WP_PROXY(obj));
-        WirePlumberServiceNode *node = NULL;
+    if (header->type == WIRE_PLUMBER_SERVICE_TYPE_SOURCE)
+        wire_plumber_service_count_running_source(
+            self, false,
+            ((WirePlumberServiceNode *)header)->state ==
+                WP_NODE_STATE_RUNNING);
+    return header;
+}
 
-        node = g_hash_table_lookup(self->db, GUINT_TO_POINTER(id));
-        if (node) {
-            wire_plumber_service_fill_node(node, WP_GLOBAL_PROXY(obj), self);
-        } else {
-            node = wire_plumber_service_node_new(WP_GLOBAL_PROXY(obj), self);
+// Points the default sink and source at their inventoried nodes, emitting
+// the matching signal when `emit` is set and a default changed.
+static void wire_plumber_service_sync_defaults(WirePlumberService *self,
+                                               gboolean emit) {
+    WirePlumberServiceNodeHeader *header;
 
-            // connect to state changes to monitor devices state.
-            g_signal_connect(WP_NODE(obj), "state-changed",
-                             G_CALLBACK(on_state_change), self);
+    // fill in default sink and source ids.
+    g_signal_emit_by_name(self->default_nodes_api, "get-default-node",
+                          "Audio/Sink", &self->default_sink_id);
 
-            g_hash_table_insert(self->db, GUINT_TO_POINTER(id), node);
-            g_ptr_array_add(node_array, node);
-        }
+    g_signal_emit_by_name(self->default_nodes_api, "get-default-node",
+                          "Audio/Source", &self->default_source_id);
 
-        if (node->id == default_node_id) *default_node = node;
+    header = g_hash_table_lookup(self->db,
+                                 GUINT_TO_POINTER(self->default_sink_id));
+    if (header && header->type == WIRE_PLUMBER_SERVICE_TYPE_SINK &&
+        (WirePlumberServiceNode *)header != self->default_sink) {
+        self->default_sink = (WirePlumberServiceNode *)header;
+        if (emit)
+            g_signal_emit(self, service_signals[default_sink_changed], 0,
+                          self->default_sink);
     }
-}
 
-static void on_object_manager_change_get_links(WpObjectManager *om,
-                                               WirePlumberService *self) {
-    g_auto(GValue) value = G_VALUE_INIT;
-    WpIterator *it = NULL;
+    header = g_hash_table_lookup(self->db,
+                                 GUINT_TO_POINTER(self->default_source_id));
+    if (header && header->type == WIRE_PLUMBER_SERVICE_TYPE_SOURCE &&
+        (WirePlumberServiceNode *)header != self->default_source) {
+        self->default_source = (WirePlumberServiceNode *)header;
+        if (emit)
+            g_signal_emit(self, service_signals[default_source_changed], 0,
+                          self->default_source);
+    }
 
+    // debug default nodes ids
     g_debug(
-        "wireplumber_service.c:on_object_manager_change_get_links() called");
+        "wireplumber_service.c:wire_plumber_service_sync_defaults() default "
+        "sink id: %d default source id: %d",
+        self->default_sink_id, self->default_source_id);
+}
 
-    it = wp_object_manager_new_filtered_iterator(self->om, WP_TYPE_LINK, NULL);
+static void wire_plumber_service_emit_microphone_active(
+    WirePlumberService *self) {
+    g_signal_emit(self, service_signals[microphone_active], 0,
+                  wire_plumber_service_microphone_active(self));
+}
 
-    for (; wp_iterator_next(it, &value); g_value_unset(&value)) {
-        GObject *obj = g_value_get_object(&value);
-        guint32 id = wp_proxy_get_bound_id(WP_PROXY(obj));
-        WirePlumberServiceLink *link = NULL;
-
-        link = g_hash_table_lookup(self->db, GUINT_TO_POINTER(id));
-        if (link) {
-            wire_plumber_service_fill_link(link, WP_GLOBAL_PROXY(obj), self);
-        } else {
-            link = wire_plumber_service_link_new(WP_GLOBAL_PROXY(obj), self);
-            g_hash_table_insert(self->db, GUINT_TO_POINTER(id), link);
-            g_ptr_array_add(self->links, link);
-        }
+static void on_object_added(WpObjectManager *om, GObject *obj,
+                            WirePlumberService *self) {
+    if (WP_IS_METADATA(obj)) {
+        g_set_object(&self->metadata, WP_METADATA(obj));
+        wire_plumber_service_flush_moves(self);
+        return;
     }
-}
 
-static void on_object_manager_change_get_audio_streams(
-    WpObjectManager *om, WirePlumberService *self) {
-    g_auto(GValue) value = G_VALUE_INIT;
-    WpIterator *it = NULL;
+    WirePlumberServiceNodeHeader *header =
+        wire_plumber_service_add_object(self, obj);
+    if (!header) return;
 
-    g_debug(
-        "wireplumber_service.c:on_object_manager_change_get_audio_streams() "
-        "called");
+    g_debug("wireplumber_service.c:on_object_added() id: %d type: %d",
+            header->id, header->type);
 
-    it = wp_object_manager_new_filtered_iterator(
-        self->om, WP_TYPE_NODE, WP_CONSTRAINT_TYPE_PW_PROPERTY,
-        PW_KEY_MEDIA_CLASS, "#s", "Stream/*", NULL);
+    g_signal_emit(self, service_signals[node_added], 0, header);
 
-    for (; wp_iterator_next(it, &value); g_value_unset(&value)) {
-        GObject *obj = g_value_get_object(&value);
-        guint32 id = wp_proxy_get_bound_id(WP_PROXY(obj));
-        WirePlumberServiceAudioStream *node = NULL;
-
-        node = g_hash_table_lookup(self->db, GUINT_TO_POINTER(id));
-        if (node) {
-            wire_plumber_service_fill_audio_stream(node, WP_GLOBAL_PROXY(obj),
-                                                   self);
-        } else {
-            node = wire_plumber_service_audio_stream_new(WP_GLOBAL_PROXY(obj),
-                                                         self);
-
-            // connect to state changes to monitor devices state.
-            g_signal_connect(WP_NODE(obj), "state-changed",
-                             G_CALLBACK(on_state_change), self);
-
-            g_hash_table_insert(self->db, GUINT_TO_POINTER(id), node);
-            g_ptr_array_add(self->streams, node);
-        }
-    }
+    if (header->type == WIRE_PLUMBER_SERVICE_TYPE_SINK ||
+        header->type == WIRE_PLUMBER_SERVICE_TYPE_SOURCE)
+        wire_plumber_service_sync_defaults(self, true);
+
+    // add_object counted a running source, the first one is an edge.
+    if (header->type == WIRE_PLUMBER_SERVICE_TYPE_SOURCE &&
+        ((WirePlumberServiceNode *)header)->state == WP_NODE_STATE_RUNNING &&
+        self->running_sources == 1)
+        wire_plumber_service_emit_microphone_active(self);
 }
 
-static void on_object_manager_change(WpObjectManager *om,
-                                     WirePlumberService *self) {
-    g_auto(GValue) value = G_VALUE_INIT;
+static void on_object_removed(WpObjectManager *om, GObject *obj,
+                              WirePlumberService *self) {
+    gpointer id;
 
-    g_debug("wireplumber_service.c:on_object_manager_change() called");
+    if ((GObject *)self->metadata == obj) {
+        g_clear_object(&self->metadata);
+        return;
+    }
 
-    // fill in default sink and source ids.
-    g_signal_emit_by_name(self->default_nodes_api, "get-default-node",
-                          "Audio/Sink", &self->default_sink_id);
+    // the proxy may already be unbound, use the id it was inventoried with.
+    if (!g_hash_table_lookup_extended(self->proxies, obj, NULL, &id)) return;
+    g_hash_table_remove(self->proxies, obj);
+    g_signal_handlers_disconnect_by_data(obj, self);
 
-    g_signal_emit_by_name(self->default_nodes_api, "get-default-node",
-                          "Audio/Source", &self->default_source_id);
+    WirePlumberServiceNodeHeader *header = g_hash_table_lookup(self->db, id);
+    if (!header) return;
 
-    // prune the database first
-    wire_plumber_service_prune_db(self);
+    g_debug("wireplumber_service.c:on_object_removed() id: %d type: %d",
+            header->id, header->type);
 
-    // find sinks
-    on_object_manager_change_get_source_sinks(om, self, "Audio/Sink");
+    // consumers drop their references to the node before it's freed.
+    g_signal_emit(self, service_signals[node_removed], 0, header);
 
-    // find sources
-    on_object_manager_change_get_source_sinks(om, self, "Audio/Source");
+    g_hash_table_remove(self->db, id);
+    g_hash_table_remove(self->pending_moves, id);
+    g_hash_table_remove(self->volume_targets, id);
+    g_ptr_array_remove(wire_plumber_service_index(self, header->type), header);
 
-    // find audio streams
-    on_object_manager_change_get_audio_streams(om, self);
+    if ((WirePlumberServiceNode *)header == self->default_sink)
+        self->default_sink = NULL;
+    if ((WirePlumberServiceNode *)header == self->default_source)
+        self->default_source = NULL;
 
-    // find links
-    on_object_manager_change_get_links(om, self);
+    gboolean microphone_edge =
+        header->type == WIRE_PLUMBER_SERVICE_TYPE_SOURCE &&
+        wire_plumber_service_count_running_source(
+            self,
+            ((WirePlumberServiceNode *)header)->state ==
+                WP_NODE_STATE_RUNNING,
+            false);
+    wire_plumber_service_free_object(header);
+
+    if (microphone_edge) wire_plumber_service_emit_microphone_active(self);
+}
+
+// Runs once after a batch of objects were added or removed, the db and typed
+// arrays are already up to date.
+static void on_object_manager_change(WpObjectManager *om,
+                                     WirePlumberService *self) {
+    g_debug("wireplumber_service.c:on_object_manager_change() called");
 
     // emit database-changed signal
     g_signal_emit(self, service_signals[database_changed], 0, self->db);
+}
 
-    // debug default nodes ids
-    g_debug(
-        "wireplumber_service.c:on_object_manager_change() default sink id: %d "
-        "default source id: %d",
-        self->default_sink_id, self->default_source_id);
+static void on_default_nodes_changed(WpPlugin *api, WirePlumberService *self) {
+    g_debug("wireplumber_service.c:on_default_nodes_changed() called");
+    wire_plumber_service_sync_defaults(self, true);
 }
 
 static void on_installed(WirePlumberService *self) {
+    g_auto(GValue) value = G_VALUE_INIT;
+    WpIterator *it = NULL;
+
     g_info(
         "wireplumber_service.c:wire_plumber_service_init() WirePlumberService "
         "initialized "
@@ -655,21 +780,41 @@ static void on_installed(WirePlumberService *self) {
         wp_core_get_remote_name(self->core),
         wp_core_get_remote_version(self->core));
 
-    on_object_manager_change(self->om, self);
+    // inventory the initial graph, after this objects are tracked one at a
+    // time as they come and go.
+    it = wp_object_manager_new_iterator(self->om);
+    for (; wp_iterator_next(it, &value); g_value_unset(&value)) {
+        GObject *obj = g_value_get_object(&value);
+        if (WP_IS_METADATA(obj))
+            g_set_object(&self->metadata, WP_METADATA(obj));
+        else
+            wire_plumber_service_add_object(self, obj);
+    }
+    wp_iterator_unref(it);
+    wire_plumber_service_flush_moves(self);
+
+    wire_plumber_service_sync_defaults(self, false);
 
     // emit initial signals
     g_signal_emit(self, service_signals[default_sink_changed], 0,
                   self->default_sink);
     g_signal_emit(self, service_signals[default_source_changed], 0,
                   self->default_source);
-    g_signal_emit(self, service_signals[node_changed], 0, self->db);
-    g_signal_emit(self, service_signals[microphone_active], 0,
-                  wire_plumber_service_microphone_active(self));
+    g_signal_emit(self, service_signals[database_changed], 0, self->db);
+    wire_plumber_service_emit_microphone_active(self);
 
     // listen for object being added or removed from the pipewire server.
+    g_signal_connect(self->om, "object-added", G_CALLBACK(on_object_added),
+                     self);
+    g_signal_connect(self->om, "object-removed", G_CALLBACK(on_object_removed),
+                     self);
     g_signal_connect(self->om, "objects-changed",
                      G_CALLBACK(on_object_manager_change), self);
 
+    // listen for the default sink or source changing.
+    g_signal_connect(self->default_nodes_api, "changed",
+                     G_CALLBACK(on_default_nodes_changed), self);
+
     // listen for audio events (volume, mute, etc...) from WirePlumber's mixer
     // api.
     g_signal_connect(self->mixer_api, "changed", G_CALLBACK(on_mixer_changed),
@@ -694,45 +839,6 @@ static void on_plugin_activate(WpObject *p, GAsyncResult *res,
         wp_core_install_object_manager(self->core, self->om);
 }
 
-void context_state_cb(pa_context *c, void *self) {
-    g_debug("wireplumber_service.c:context_state_cb() called");
-
-    switch (pa_context_get_state(c)) {
-        case PA_CONTEXT_READY: {
-            g_debug(
-                "wireplumber_service.c:context_state_cb() pulseaudio context "
-                "ready");
-            break;
-        }
-        case PA_CONTEXT_FAILED:
-        case PA_CONTEXT_TERMINATED:
-            g_critical(
-                "wireplumber_service.c:context_state_cb() pulseaudio context "
-                "failed");
-            break;
-
-        default:
-            break;
-    }
-}
-
-static void wire_plumber_service_init_pulseaudio(WirePlumberService *self) {
-    g_debug(
-        "wireplumber_service.c:wire_plumber_service_init_pulseaudio() called");
-
-    self->pa_loop = pa_glib_mainloop_new(g_main_context_default());
-    self->pa_api = pa_glib_mainloop_get_api(self->pa_loop);
-    self->pa_ctx = pa_context_new(self->pa_api, "org.ldelossa.way-shell");
-
-    pa_context_set_state_callback(self->pa_ctx, context_state_cb, self);
-
-    if (pa_context_connect(self->pa_ctx, NULL, PA_CONTEXT_NOFLAGS, NULL) < 0) {
-        g_error(
-            "wireplumber_service.c:wire_plumber_service_init_pulseaudio() "
-            "failed to connect to pulseaudio");
-    }
-}
-
 static gboolean wire_plumber_service_connect_retry(gpointer user_data);
 
 static void on_core_disconnect(WpCore *core, WirePlumberService *self) {
@@ -800,18 +906,28 @@ gboolean wire_plumber_service_connect(WirePlumberService *self) {
 
     // cleanup all existing arrays, hashtables, core and om
     if (self->db) g_hash_table_destroy(self->db);
+    if (self->proxies) g_hash_table_destroy(self->proxies);
     if (self->sinks) g_ptr_array_free(self->sinks, true);
     if (self->sources) g_ptr_array_free(self->sources, true);
     if (self->streams) g_ptr_array_free(self->streams, true);
     if (self->links) g_ptr_array_free(self->links, true);
+    if (self->pending_moves) g_hash_table_destroy(self->pending_moves);
+    if (self->volume_targets) g_hash_table_destroy(self->volume_targets);
+    g_clear_handle_id(&self->volume_flush_id, g_source_remove);
+    g_clear_object(&self->metadata);
     if (self->core) g_object_unref(self->core);
     if (self->om) g_object_unref(self->om);
 
     self->db = g_hash_table_new(g_direct_hash, g_direct_equal);
+    self->proxies = g_hash_table_new(g_direct_hash, g_direct_equal);
     self->sources = g_ptr_array_new();
     self->sinks = g_ptr_array_new();
     self->streams = g_ptr_array_new();
     self->links = g_ptr_array_new();
+    self->pending_moves = g_hash_table_new(g_direct_hash, g_direct_equal);
+    self->running_sources = 0;
+    self->volume_targets =
+        g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
 
     self->core = wp_core_new(NULL, NULL, NULL);
     self->om = wp_object_manager_new();
@@ -831,8 +947,16 @@ gboolean wire_plumber_service_connect(WirePlumberService *self) {
     wp_object_manager_request_object_features(self->om, WP_TYPE_LINK,
                                               WP_PROXY_FEATURE_BOUND);
 
+    // the session manager's "default" metadata carries stream targets.
+    WpObjectInterest *default_metadata = wp_object_interest_new(
+        WP_TYPE_METADATA, WP_CONSTRAINT_TYPE_PW_GLOBAL_PROPERTY,
+        "metadata.name", "=s", "default", NULL);
+    wp_object_manager_request_object_features(self->om, WP_TYPE_METADATA,
+                                              WP_METADATA_FEATURE_DATA);
+
     wp_object_manager_add_interest_full(self->om, all_nodes);
     wp_object_manager_add_interest_full(self->om, all_links);
+    wp_object_manager_add_interest_full(self->om, default_metadata);
 
     // load the mixer and default nodes apis.
     wp_core_load_component(self->core,
@@ -856,8 +980,6 @@ gboolean wire_plumber_service_connect(WirePlumberService *self) {
     g_signal_connect_swapped(self->om, "installed", G_CALLBACK(on_installed),
                              self);
 
-    wire_plumber_service_init_pulseaudio(self);
-
     // attach to core's disconnect signal
     g_signal_connect(self->core, "disconnected", G_CALLBACK(on_core_disconnect),
                      self);
@@ -935,80 +1057,36 @@ GPtrArray *wire_plumber_service_get_links(WirePlumberService *self) {
     return self->links;
 }
 
-void sink_input_info_cb(pa_context *c, const pa_sink_input_info *i, int eol,
-                        void *userdata) {
-    if (eol > 0) {
-        return;
-    }
-
-    WirePlumberService *self = (WirePlumberService *)userdata;
-
-    // we want to find the sink-input that matches our pending output stream.
-    const char *key = "object.id";
-    const char *value;
-
-    value = pa_proplist_gets(i->proplist, key);
-    if (!value) return;
-
-    guint32 id = g_ascii_strtoull(value, NULL, 10);
-    if (id != self->pending_output_stream) return;
-
-    g_debug(
-        "wireplumber_service.c:sink_input_info_cb() found sink-input id: %d, "
-        "for wireplumber sink id: %d",
-        i->index, id);
-
-    // we found the sink-input, now get our WirePlumberServiceNode for the sink
-    // we are linking to.
+// Routes a stream to a sink or source by pointing the stream's target.object
+// at the node's serial, WirePlumber relinks the stream and remembers the
+// target for the next time the stream appears.
+static void wire_plumber_service_move_stream(WirePlumberService *self,
+                                             guint32 stream_id,
+                                             guint32 node_id) {
     WirePlumberServiceNode *node =
-        g_hash_table_lookup(self->db, GUINT_TO_POINTER(self->pending_sink));
+        g_hash_table_lookup(self->db, GUINT_TO_POINTER(node_id));
+    if (!node || !node->serial) return;
 
-    if (!node) return;
+    g_debug(
+        "wireplumber_service.c:wire_plumber_service_move_stream() stream: %d "
+        "target: %d serial: %s",
+        stream_id, node_id, node->serial);
 
-    // perform move-sink-input pa operation
-    pa_operation *o = pa_context_move_sink_input_by_name(
-        self->pa_ctx, i->index, node->proper_name, NULL, NULL);
-    if (o) {
-        pa_operation_unref(o);
-    }
+    wp_metadata_set(self->metadata, stream_id, "target.object", "Spa:Id",
+                    node->serial);
 }
 
-void source_output_info_cb(pa_context *c, const pa_source_output_info *i,
-                           int eol, void *userdata) {
-    if (eol > 0) {
-        return;
-    }
-
-    WirePlumberService *self = (WirePlumberService *)userdata;
-
-    const char *key = "object.id";
-    const char *value;
-
-    value = pa_proplist_gets(i->proplist, key);
-    if (!value) return;
-
-    guint32 id = g_ascii_strtoull(value, NULL, 10);
-    if (id != self->pending_input_stream) return;
-
-    g_debug(
-        "wireplumber_service.c:source_output_info_cb() found source-output id: "
-        "%d, "
-        "for wireplumber sink id: %d",
-        i->index, id);
-
-    // we found the output source, now find the WirePlumberServiceNode for the
-    // source.
-    WirePlumberServiceNode *node =
-        g_hash_table_lookup(self->db, GUINT_TO_POINTER(self->pending_source));
+static void wire_plumber_service_flush_moves(WirePlumberService *self) {
+    GHashTableIter iter;
+    gpointer stream_id, node_id;
 
-    if (!node) return;
+    if (!self->metadata) return;
 
-    // perform move-sink-input pa operation
-    pa_operation *o = pa_context_move_source_output_by_name(
-        self->pa_ctx, i->index, node->proper_name, NULL, NULL);
-    if (o) {
-        pa_operation_unref(o);
-    }
+    g_hash_table_iter_init(&iter, self->pending_moves);
+    while (g_hash_table_iter_next(&iter, &stream_id, &node_id))
+        wire_plumber_service_move_stream(self, GPOINTER_TO_UINT(stream_id),
+                                         GPOINTER_TO_UINT(node_id));
+    g_hash_table_remove_all(self->pending_moves);
 }
 
 void wire_plumber_service_set_link(WirePlumberService *self,
@@ -1016,65 +1094,35 @@ void wire_plumber_service_set_link(WirePlumberService *self,
                                    WirePlumberServiceNodeHeader *input) {
     g_debug("wireplumber_service.c:wire_plumber_service_set_link() called");
 
-    // TODO: this should really be data tied to a 'request-id', such that
-    // multiple link changes can occur at once, creating a new 'request' each
-    // time.
-    self->pending_input_stream = 0;
-    self->pending_output_stream = 0;
-    self->pending_sink = 0;
-    self->pending_source = 0;
+    WirePlumberServiceNodeHeader *node = NULL;
+    WirePlumberServiceNodeHeader *stream = NULL;
 
     // determine which one is our stream
-    WirePlumberServiceNode *node;
-    WirePlumberServiceAudioStream *stream;
-
-    switch (output->type) {
-        case WIRE_PLUMBER_SERVICE_TYPE_SINK:
-        case WIRE_PLUMBER_SERVICE_TYPE_SOURCE:
-            node = (WirePlumberServiceNode *)output;
-            break;
-        case WIRE_PLUMBER_SERVICE_TYPE_INPUT_AUDIO_STREAM:
-        case WIRE_PLUMBER_SERVICE_TYPE_OUTPUT_AUDIO_STREAM:
-            stream = (WirePlumberServiceAudioStream *)output;
-            break;
-        default:
-            break;
-    }
-
-    switch (input->type) {
-        case WIRE_PLUMBER_SERVICE_TYPE_SINK:
-        case WIRE_PLUMBER_SERVICE_TYPE_SOURCE:
-            node = (WirePlumberServiceNode *)input;
-            break;
-        case WIRE_PLUMBER_SERVICE_TYPE_INPUT_AUDIO_STREAM:
-        case WIRE_PLUMBER_SERVICE_TYPE_OUTPUT_AUDIO_STREAM:
-            stream = (WirePlumberServiceAudioStream *)input;
-            break;
-        default:
-            break;
-    }
-
-    // we need to now query the pulse audio api to find the 'sink-input' or
-    // 'source-outputs' which refer to our stream and move it to our discovered
-    // node.
-    if (stream->type == WIRE_PLUMBER_SERVICE_TYPE_INPUT_AUDIO_STREAM) {
-        self->pending_input_stream = stream->id;
-        self->pending_source = node->id;
-        pa_operation *o = pa_context_get_source_output_info_list(
-            self->pa_ctx, source_output_info_cb, self);
-        if (o) {
-            pa_operation_unref(o);
+    WirePlumberServiceNodeHeader *ends[] = {output, input};
+    for (guint i = 0; i < G_N_ELEMENTS(ends); i++) {
+        switch (ends[i]->type) {
+            case WIRE_PLUMBER_SERVICE_TYPE_SINK:
+            case WIRE_PLUMBER_SERVICE_TYPE_SOURCE:
+                node = ends[i];
+                break;
+            case WIRE_PLUMBER_SERVICE_TYPE_INPUT_AUDIO_STREAM:
+            case WIRE_PLUMBER_SERVICE_TYPE_OUTPUT_AUDIO_STREAM:
+                stream = ends[i];
+                break;
+            default:
+                break;
         }
     }
-    if (stream->type == WIRE_PLUMBER_SERVICE_TYPE_OUTPUT_AUDIO_STREAM) {
-        self->pending_output_stream = stream->id;
-        self->pending_sink = node->id;
-        pa_operation *o = pa_context_get_sink_input_info_list(
-            self->pa_ctx, sink_input_info_cb, self);
-        if (o) {
-            pa_operation_unref(o);
-        }
+    if (!node || !stream) return;
+
+    // moves are independent per stream, so any number may be in flight.
+    // until the metadata object shows up they're queued keyed by stream.
+    if (!self->metadata) {
+        g_hash_table_insert(self->pending_moves, GUINT_TO_POINTER(stream->id),
+                            GUINT_TO_POINTER(node->id));
+        return;
     }
+    wire_plumber_service_move_stream(self, stream->id, node->id);
 }
 
 GHashTable *wire_plumber_service_get_db(WirePlumberService *self) {
@@ -1082,15 +1130,8 @@ GHashTable *wire_plumber_service_get_db(WirePlumberService *self) {
     return self->db;
 }
 
-void wire_plumber_service_set_volume(WirePlumberService *self,
-                                     const WirePlumberServiceNode *node,
-                                     double volume) {
-    g_debug(
-        "wireplumber_service.c:wire_plumber_service_set_volume() called: %f",
-        volume);
-
-    if (!node) return;
-
+static void wire_plumber_service_write_volume(WirePlumberService *self,
+                                              guint32 id, double volume) {
     g_auto(GVariantBuilder) b = G_VARIANT_BUILDER_INIT(G_VARIANT_TYPE_VARDICT);
     GVariant *variant = NULL;
     gboolean res = FALSE;
@@ -1102,12 +1143,103 @@ void wire_plumber_service_set_volume(WirePlumberService *self,
         g_variant_new_double(volume_to_linear(volume, SCALE_CUBIC)));
     variant = g_variant_builder_end(&b);
 
-    g_signal_emit_by_name(self->mixer_api, "set-volume", node->id, variant,
-                          &res);
+    g_signal_emit_by_name(self->mixer_api, "set-volume", id, variant, &res);
     g_debug(
-        "wireplumber_service.c:wire_plumber_service_set_volume() id: %d, "
-        "res: %d",
-        node->id, res);
+        "wireplumber_service.c:wire_plumber_service_write_volume() id: %d, "
+        "volume: %f, res: %d",
+        id, volume, res);
+}
+
+// Volume the target's ramp is at, at monotonic time `now`.
+static double volume_target_value(VolumeTarget *t, gint64 now) {
+    if (t->duration <= 0 || now >= t->start + t->duration) return t->target;
+    return t->from +
+           (t->target - t->from) * (double)(now - t->start) / t->duration;
+}
+
+// Writes every queued volume at most once per interval. Targets stay queued
+// for a short while after reaching their volume so their echoes can be
+// recognized, the timer stops once nothing is queued.
+static gboolean wire_plumber_service_flush_volumes(WirePlumberService *self) {
+    GHashTableIter iter;
+    VolumeTarget *t;
+    gint64 now = g_get_monotonic_time();
+
+    g_hash_table_iter_init(&iter, self->volume_targets);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&t)) {
+        double volume = volume_target_value(t, now);
+
+        if (t->written < 0 || fabs(volume - t->written) > VOLUME_EPSILON) {
+            wire_plumber_service_write_volume(self, t->id, volume);
+            volume_target_record_write(t, volume, now);
+            continue;
+        }
+
+        if (now - t->written_at >=
+            WIRE_PLUMBER_SERVICE_VOLUME_ECHO_MS * G_TIME_SPAN_MILLISECOND)
+            g_hash_table_iter_remove(&iter);
+    }
+
+    if (g_hash_table_size(self->volume_targets) > 0) return G_SOURCE_CONTINUE;
+
+    self->volume_flush_id = 0;
+    return G_SOURCE_REMOVE;
+}
+
+// The volume the controller is taking a node to, or its current volume if
+// nothing is queued. Relative changes build on this so repeated steps
+// aren't lost while earlier ones are still queued.
+static double wire_plumber_service_volume_target(
+    WirePlumberService *self, const WirePlumberServiceNode *node) {
+    VolumeTarget *t =
+        g_hash_table_lookup(self->volume_targets, GUINT_TO_POINTER(node->id));
+    return t ? t->target : node->volume;
+}
+
+void wire_plumber_service_set_volume_ramped(WirePlumberService *self,
+                                            const WirePlumberServiceNode *node,
+                                            double volume, guint ramp_ms) {
+    g_debug(
+        "wireplumber_service.c:wire_plumber_service_set_volume_ramped() "
+        "called: %f ramp: %d",
+        volume, ramp_ms);
+
+    if (!node) return;
+
+    gint64 now = g_get_monotonic_time();
+    VolumeTarget *t =
+        g_hash_table_lookup(self->volume_targets, GUINT_TO_POINTER(node->id));
+
+    if (!t) {
+        t = g_new0(VolumeTarget, 1);
+        t->id = node->id;
+        t->target = node->volume;
+        t->written = -1;
+        g_hash_table_insert(self->volume_targets, GUINT_TO_POINTER(node->id),
+                            t);
+    }
+
+    // retargeting mid ramp continues from wherever the ramp is now.
+    t->from = volume_target_value(t, now);
+    t->target = CLAMP(volume, 0.0, 1.0);
+    t->start = now;
+    t->duration = (gint64)ramp_ms * G_TIME_SPAN_MILLISECOND;
+
+    if (!self->volume_flush_id)
+        self->volume_flush_id =
+            g_timeout_add(WIRE_PLUMBER_SERVICE_VOLUME_INTERVAL_MS,
+                          (GSourceFunc)wire_plumber_service_flush_volumes,
+                          self);
+}
+
+void wire_plumber_service_set_volume(WirePlumberService *self,
+                                     const WirePlumberServiceNode *node,
+                                     double volume) {
+    g_debug(
+        "wireplumber_service.c:wire_plumber_service_set_volume() called: %f",
+        volume);
+
+    wire_plumber_service_set_volume_ramped(self, node, volume, 0);
 }
 
 void wire_plumber_service_volume_up(WirePlumberService *self,
@@ -1116,16 +1248,18 @@ void wire_plumber_service_volume_up(WirePlumberService *self,
 
     if (!node) return;
 
-    if (node->volume >= 1.0) {
+    double volume = wire_plumber_service_volume_target(self, node);
+    if (volume >= 1.0) {
         g_debug(
             "wireplumber_service.c:wire_plumber_service_volume_up() volume is "
             "already at max");
         return;
     }
-    double volume = node->volume + .05;
+    volume += .05;
     g_debug("wireplumber_service.c:wire_plumber_service_volume_up() volume: %f",
             volume);
-    wire_plumber_service_set_volume(self, node, volume);
+    wire_plumber_service_set_volume_ramped(self, node, volume,
+                                           WIRE_PLUMBER_SERVICE_VOLUME_RAMP_MS);
 }
 
 void wire_plumber_service_volume_down(WirePlumberService *self,
@@ -1134,17 +1268,19 @@ void wire_plumber_service_volume_down(WirePlumberService *self,
 
     if (!node) return;
 
-    if (node->volume <= 0.0) {
+    double volume = wire_plumber_service_volume_target(self, node);
+    if (volume <= 0.0) {
         g_debug(
             "wireplumber_service.c:wire_plumber_service_volume_down() volume "
             "is already at min");
         return;
     }
-    double volume = node->volume - .05;
+    volume -= .05;
     g_debug(
         "wireplumber_service.c:wire_plumber_service_volume_down() volume: %f",
         volume);
-    wire_plumber_service_set_volume(self, node, volume);
+    wire_plumber_service_set_volume_ramped(self, node, volume,
+                                           WIRE_PLUMBER_SERVICE_VOLUME_RAMP_MS);
 }
 
 void wire_plumber_service_volume_mute(WirePlumberService *self,
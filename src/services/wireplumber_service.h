@@ -3,6 +3,17 @@
 #include <sys/cdefs.h>
 #include <wireplumber-0.5/wp/wp.h>
 
+// Interval, in milliseconds, queued volume changes are written to the mixer
+// at, about once per frame.
+#define WIRE_PLUMBER_SERVICE_VOLUME_INTERVAL_MS 16
+
+// Duration, in milliseconds, volume up and down steps ramp over.
+#define WIRE_PLUMBER_SERVICE_VOLUME_RAMP_MS 80
+
+// Time, in milliseconds, after its last write that mixer updates for a node
+// are checked against the volume written.
+#define WIRE_PLUMBER_SERVICE_VOLUME_ECHO_MS 250
+
 enum {
     SCALE_LINEAR,
     SCALE_CUBIC,
@@ -119,6 +130,8 @@ typedef struct WirePlumberServiceNode {
     const gchar *proper_name;
     const gchar *media_class;
     const gchar *nick_name;
+    // object.serial, how stream targets refer to this node.
+    const gchar *serial;
     gdouble volume;
     gboolean mute;
     gboolean active;
@@ -172,11 +185,21 @@ int wire_plumber_service_global_init(void);
 WirePlumberService *wire_plumber_service_get_global(void);
 
 // Volume control methods.
+//
+// Volume changes are queued per node and written to the mixer at most once
+// every WIRE_PLUMBER_SERVICE_VOLUME_INTERVAL_MS, only the latest target for a
+// node is written.
 
 void wire_plumber_service_set_volume(WirePlumberService *self,
                                      const WirePlumberServiceNode *node,
                                      double volume);
 
+// Like wire_plumber_service_set_volume but ramps from the node's current
+// volume to `volume` over `ramp_ms` milliseconds.
+void wire_plumber_service_set_volume_ramped(WirePlumberService *self,
+                                            const WirePlumberServiceNode *node,
+                                            double volume, guint ramp_ms);
+
 void wire_plumber_service_volume_up(WirePlumberService *self,
                                     const WirePlumberServiceNode *node);
 
@@ -205,10 +228,15 @@ GPtrArray *wire_plumber_service_get_streams(WirePlumberService *self);
 
 GPtrArray *wire_plumber_service_get_links(WirePlumberService *self);
 
+// Routes the stream end of output -> input to the sink or source end.
+// Moves for different streams may overlap, a newer move for a stream
+// supersedes an older one.
 void wire_plumber_service_set_link(WirePlumberService *self,
                                    WirePlumberServiceNodeHeader *output,
                                    WirePlumberServiceNodeHeader *input);
 
+// Returns TRUE while any source is capturing. The "microphone-active" signal
+// is emitted only when this flips.
 gboolean wire_plumber_service_microphone_active(WirePlumberService *self);
 
 char *wire_plumber_service_map_source_vol_icon(float vol, gboolean mute);
@@ -23,7 +23,10 @@ typedef struct _WorkspaceSwitcher {
     GObject parent_instance;
     Switcher switcher;
     enum mode mode;
-
+    // WorkspaceSwitcherWorkspaceWidget(s) keyed by their workspace's id.
+    GHashTable *rows;
+    // latest workspace listing received while hidden, applied on show.
+    GPtrArray *pending_workspaces;
 } WorkspaceSwitcher;
 
 static guint workspace_switcher_signals[signals_n] = {0};
@@ -246,29 +249,96 @@ static void on_search_changed(GtkSearchEntry *entry, WorkspaceSwitcher *self) {
     }
 }
 
+// Applies `workspaces` to the list box as a diff against the current rows.
+// Rows are created, renamed, moved or removed only when their workspace was.
+static void workspace_switcher_apply_workspaces(WorkspaceSwitcher *self,
+                                                GPtrArray *workspaces) {
+    GtkListBox *list = SWITCHER(self).list;
+    GHashTable *seen = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+    for (guint i = 0; i < workspaces->len; i++) {
+        WMWorkspace *ws = g_ptr_array_index(workspaces, i);
+        gpointer key = GUINT_TO_POINTER(ws->id);
+        g_hash_table_add(seen, key);
+
+        WorkspaceSwitcherWorkspaceWidget *widget =
+            g_hash_table_lookup(self->rows, key);
+        GtkWidget *child;
+
+        if (!widget) {
+            widget =
+                g_object_new(WORKSPACE_SWITCHER_WORKSPACE_WIDGET_TYPE, NULL);
+            workspace_switcher_workspace_widget_set_workspace_name(widget,
+                                                                   ws->name);
+            child = workspace_switcher_workspace_widget_get_widget(widget);
+            // rows outlive the window manager's workspace array, each keeps
+            // its own copy of the workspace it filters and focuses on.
+            g_object_set_data_full(G_OBJECT(child), "workspace",
+                                   wm_workspace_copy(ws),
+                                   (GDestroyNotify)wm_workspace_free);
+            gtk_list_box_insert(list, child, i);
+            g_hash_table_insert(self->rows, key, widget);
+            continue;
+        }
+
+        child = workspace_switcher_workspace_widget_get_widget(widget);
+        WMWorkspace *copy = g_object_get_data(G_OBJECT(child), "workspace");
+        if (g_strcmp0(copy->name, ws->name) != 0) {
+            g_free(copy->name);
+            copy->name = g_strdup(ws->name);
+            workspace_switcher_workspace_widget_set_workspace_name(widget,
+                                                                   ws->name);
+        }
+        copy->num = ws->num;
+
+        // rows before `i` already match, so a row elsewhere moved.
+        GtkListBoxRow *row = GTK_LIST_BOX_ROW(gtk_widget_get_parent(child));
+        if (gtk_list_box_row_get_index(row) != (gint)i) {
+            g_object_ref(child);
+            gtk_list_box_remove(list, GTK_WIDGET(row));
+            gtk_list_box_insert(list, child, i);
+            g_object_unref(child);
+        }
+    }
+
+    GHashTableIter iter;
+    gpointer key;
+    WorkspaceSwitcherWorkspaceWidget *widget;
+    g_hash_table_iter_init(&iter, self->rows);
+    while (g_hash_table_iter_next(&iter, &key, (gpointer *)&widget)) {
+        if (g_hash_table_contains(seen, key)) continue;
+        gtk_list_box_remove(
+            list, gtk_widget_get_parent(
+                      workspace_switcher_workspace_widget_get_widget(widget)));
+        g_hash_table_iter_remove(&iter);
+    }
+
+    g_hash_table_unref(seen);
+}
+
+static void workspace_switcher_apply_pending(WorkspaceSwitcher *self) {
+    if (!self->pending_workspaces) return;
+
+    workspace_switcher_apply_workspaces(self, self->pending_workspaces);
+    g_clear_pointer(&self->pending_workspaces, g_ptr_array_unref);
+}
+
 static void on_workspaces_changed(void *data, GPtrArray *workspaces) {
     WorkspaceSwitcher *self = (WorkspaceSwitcher *)data;
 
     g_debug("workspace_switcher.c:on_workspaces_changed() called.");
     if (!workspaces) return;
 
-    gtk_list_box_remove_all(SWITCHER(self).list);
-
-    for (guint i = 0; i < workspaces->len; i++) {
-        WMWorkspace *workspace = g_ptr_array_index(workspaces, i);
-
-        WorkspaceSwitcherWorkspaceWidget *widget =
-            g_object_new(WORKSPACE_SWITCHER_WORKSPACE_WIDGET_TYPE, NULL);
-        workspace_switcher_workspace_widget_set_workspace_name(widget,
-                                                               workspace->name);
-
-        g_object_set_data(
-            G_OBJECT(workspace_switcher_workspace_widget_get_widget(widget)),
-            "workspace", workspace);
-        gtk_list_box_append(
-            SWITCHER(self).list,
-            workspace_switcher_workspace_widget_get_widget(widget));
+    // the Sway backend refetches workspaces on every focus change, nobody
+    // sees the rows while hidden so only keep the latest listing around.
+    if (!gtk_widget_get_visible(GTK_WIDGET(SWITCHER(self).win))) {
+        if (self->pending_workspaces)
+            g_ptr_array_unref(self->pending_workspaces);
+        self->pending_workspaces = g_ptr_array_ref(workspaces);
+        return;
     }
+
+    workspace_switcher_apply_workspaces(self, workspaces);
 }
 
 static void on_row_activated(GtkListBox *box, GtkListBoxRow *row,
@@ -369,7 +439,10 @@ static void workspace_switcher_init_layout(WorkspaceSwitcher *self) {
     // get listings of workspaces
     WindowManager *wm = window_manager_service_get_global();
     GPtrArray *workspaces = wm->get_workspaces(wm);
-    on_workspaces_changed(self, workspaces);
+    if (workspaces) {
+        on_workspaces_changed(self, workspaces);
+        g_ptr_array_unref(workspaces);
+    }
 
     wm->register_on_workspaces_changed(wm, on_workspaces_changed, self);
 
@@ -383,6 +456,9 @@ static void workspace_switcher_init_layout(WorkspaceSwitcher *self) {
 }
 
 static void workspace_switcher_init(WorkspaceSwitcher *self) {
+    self->rows = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+                                       g_object_unref);
+    self->pending_workspaces = NULL;
     workspace_switcher_init_layout(self);
 }
 
@@ -397,6 +473,8 @@ void workspace_switcher_activate(AdwApplication *app, gpointer user_data) {
 void workspace_switcher_show(WorkspaceSwitcher *self) {
     g_debug("workspace_switcher.c:workspace_switcher_show() called.");
 
+    workspace_switcher_apply_pending(self);
+
     GtkListBoxRow *row = gtk_list_box_get_row_at_index(SWITCHER(self).list, 0);
     if (row) gtk_list_box_select_row(SWITCHER(self).list, row);
 
@@ -428,6 +506,8 @@ void workspace_switcher_toggle(WorkspaceSwitcher *self) {
 void workspace_switcher_show_app_mode(WorkspaceSwitcher *self) {
     g_debug("workspace_switcher.c:workspace_switcher_show() called.");
 
+    workspace_switcher_apply_pending(self);
+
     GtkListBoxRow *row = gtk_list_box_get_row_at_index(SWITCHER(self).list, 0);
     if (row) gtk_list_box_select_row(SWITCHER(self).list, row);
 
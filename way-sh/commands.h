@@ -11,8 +11,16 @@
     ret = sendto(way_ctx->client_sock, &msg, sizeof(msg), 0, addr, \
                  sizeof(addr_un))
 
+// Receives Way-Shell's one byte response into `bool`. The sender's address is
+// not needed, `addr` is ignored.
 #define IPC_RECV_MSG(way_ctx, addr, bool) \
-    recvfrom(way_ctx->client_sock, bool, sizeof(bool), 0, addr, 0)
+    recvfrom(way_ctx->client_sock, bool, sizeof(*(bool)), 0, NULL, NULL)
+
+// cmd_tree_node_t flags understood by way-sh.
+//
+// WAY_SH_CMD_LOCAL commands run entirely in way-sh and do not need Way-Shell's
+// IPC socket.
+#define WAY_SH_CMD_LOCAL (1 << 0)
 
 typedef struct _ctx {
     char *server_socket_path;
@@ -39,6 +47,12 @@ cmd_tree_node_t *message_tray_cmd();
 // volume.
 cmd_tree_node_t *volume_cmd();
 
+// The microphone command root.
+//
+// Subcommands off this node report microphone activity, for privacy
+// indicators outside Way-Shell.
+cmd_tree_node_t *microphone_cmd();
+
 // The Brightness command
 //
 // Subcommands off this node deal with adjusting the default display's
@@ -88,3 +102,14 @@ cmd_tree_node_t *bluelight_filter_cmd();
 //
 // Subcommands off this node deal with showing and hiding the Rename Switcher
 cmd_tree_node_t *rename_switcher_cmd();
+
+// The Completion command
+//
+// Prints a bash, zsh or fish completion script generated from the command
+// tree.
+cmd_tree_node_t *completion_cmd();
+
+// The Commands command
+//
+// Prints a machine readable listing of every command and its arguments.
+cmd_tree_node_t *commands_cmd();
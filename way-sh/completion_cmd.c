@@ -0,0 +1,53 @@
+#include <stdio.h>
+
+#include "../lib/cmd_tree/include/cmd_tree.h"
+#include "commands.h"
+
+static const char *const completion_shells[] = {"bash", "zsh", "fish", NULL};
+
+static const cmd_tree_arg_t completion_args[] = {
+    {.name = "shell",
+     .type = CMD_TREE_ARG_ENUM,
+     .choices = completion_shells},
+};
+
+static int completion_exec(void *ctx, uint8_t argc, char **argv) {
+    if (cmd_tree_dump_completion(&root_cmd, "way-sh", argv[0], stdout) != 1) {
+        printf("Unsupported shell: %s\n", argv[0]);
+        return 0;
+    }
+    return 1;
+};
+
+// Prints a completion script for the given shell, generated from the command
+// tree so it never drifts from the commands way-sh actually accepts.
+//
+// bash: way-sh completion bash > ~/.local/share/bash-completion/completions/way-sh
+// zsh:  way-sh completion zsh > ~/.zfunc/_way-sh
+// fish: way-sh completion fish > ~/.config/fish/completions/way-sh.fish
+cmd_tree_node_t completion_root = {
+    .name = "completion",
+    .exec = completion_exec,
+    .help = "print a shell completion script",
+    .args = completion_args,
+    .args_n = 1,
+    .flags = WAY_SH_CMD_LOCAL,
+};
+
+static int commands_exec(void *ctx, uint8_t argc, char **argv) {
+    cmd_tree_dump_commands(&root_cmd, stdout);
+    return 1;
+};
+
+// Prints every command way-sh accepts along with its argument specs, one per
+// line, for tools which want to validate key bindings ahead of time.
+cmd_tree_node_t commands_root = {
+    .name = "commands",
+    .exec = commands_exec,
+    .help = "list all commands in a machine readable form",
+    .flags = WAY_SH_CMD_LOCAL,
+};
+
+cmd_tree_node_t *completion_cmd() { return &completion_root; }
+
+cmd_tree_node_t *commands_cmd() { return &commands_root; }
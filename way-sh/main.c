@@ -44,6 +44,7 @@ int client_socket_create(way_sh_ctx *ctx) {
 static void build_command_tree() {
     cmd_tree_node_t *message_tray = message_tray_cmd();
     cmd_tree_node_t *volume = volume_cmd();
+    cmd_tree_node_t *microphone = microphone_cmd();
     cmd_tree_node_t *brightness = brightness_cmd();
     cmd_tree_node_t *theme = theme_cmd();
     cmd_tree_node_t *activities = activities_cmd();
@@ -53,9 +54,12 @@ static void build_command_tree() {
     cmd_tree_node_t *output_switcher = output_switcher_cmd();
     cmd_tree_node_t *bluelight_filter = bluelight_filter_cmd();
 	cmd_tree_node_t *rename_switcher = rename_switcher_cmd();
+    cmd_tree_node_t *completion = completion_cmd();
+    cmd_tree_node_t *commands = commands_cmd();
 
     cmd_tree_node_add_child(&root_cmd, message_tray);
     cmd_tree_node_add_child(&root_cmd, volume);
+    cmd_tree_node_add_child(&root_cmd, microphone);
     cmd_tree_node_add_child(&root_cmd, brightness);
     cmd_tree_node_add_child(&root_cmd, theme);
     cmd_tree_node_add_child(&root_cmd, activities);
@@ -65,6 +69,14 @@ static void build_command_tree() {
     cmd_tree_node_add_child(&root_cmd, output_switcher);
     cmd_tree_node_add_child(&root_cmd, bluelight_filter);
 	cmd_tree_node_add_child(&root_cmd, rename_switcher);
+    cmd_tree_node_add_child(&root_cmd, completion);
+    cmd_tree_node_add_child(&root_cmd, commands);
+
+    // sort each level so commands resolve with a binary search.
+    if (cmd_tree_compile(&root_cmd) != 1) {
+        printf("[Error] Failed to compile command tree\n");
+        exit(1);
+    }
 }
 
 int main(int argc, char **argv) {
@@ -72,7 +84,28 @@ int main(int argc, char **argv) {
     int ret = 0;
     char socket_path[256] = {0};
     struct stat statsbuf = {0};
-    cmd_tree_node_t *cmd = {0};
+    cmd_tree_match_t match = {0};
+    char err[256] = {0};
+
+    build_command_tree();
+
+    // adjust argc and argv one past binary name.
+    // garbage in argv is fine, cmd_tree api handles this.
+    if (cmd_tree_resolve(&root_cmd, argc - 1, argv + 1, &match) != 1) {
+        printf("Failed to find command");
+        return -1;
+    }
+
+    // reject malformed arguments before anything is sent over the socket.
+    if (cmd_tree_validate(&match, err, sizeof(err)) != 1) {
+        printf("[Error] %s\n", err);
+        return 1;
+    }
+
+    if (match.node->flags & WAY_SH_CMD_LOCAL) {
+        ret = match.node->exec(&ctx, match.argc, match.argv);
+        return ret ? 0 : 1;
+    }
 
     // check if XDG_RUNTIME_DIR is set
     char *xdg_runtime_dir = getenv("XDG_RUNTIME_DIR");
@@ -101,21 +134,7 @@ int main(int argc, char **argv) {
 
     client_socket_create(&ctx);
 
-    build_command_tree();
-
-    // adjust argc and argv one past binary name.
-    // garbage in argv is fine, cmd_tree api handles this.
-    if (cmd_tree_search(&root_cmd, argc - 1, argv + 1, &cmd) != 1) {
-        printf("Failed to find command");
-        return -1;
-    }
-
-    if (!cmd) {
-        printf("Failed to find command");
-        return -1;
-    }
-
-    ret = cmd->exec(&ctx, cmd->argc, cmd->argv);
+    ret = match.node->exec(&ctx, match.argc, match.argv);
 
     close(ctx.client_sock);
 
@@ -0,0 +1,65 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../lib/cmd_tree/include/cmd_tree.h"
+#include "../src/services/ipc_service/ipc_commands.h"
+#include "commands.h"
+
+// Exit status of `microphone active` when Way-Shell could not be asked, kept
+// apart from 1 so scripts don't take a broken connection for "inactive".
+#define MICROPHONE_ACTIVE_EXIT_ERROR 2
+
+static int microphone_root_exec(void *ctx, uint8_t argc, char **argv) {
+    printf(
+        "Summary:\n"
+        "\tQuery microphone activity for the desktop session.\n"
+        "Commands: \n"
+        "\tactive - print whether any microphone is capturing, exits 0 when "
+        "one is, 1 when none is and 2 when way-shell could not be asked\n");
+    return 0;
+};
+
+// The microphone command for way-sh and is displayed when no other arguments
+// are provided to the CLI.
+//
+// A short help blurb is presented along with a list of all available
+// microphone level commands.
+cmd_tree_node_t microphone_cmd_root = {.name = "microphone",
+                                       .exec = microphone_root_exec};
+
+static int microphone_active_exec(void *ctx, uint8_t argc, char **argv) {
+    int ret = 0;
+    way_sh_ctx *way_ctx = ctx;
+
+    IPCMicrophoneActive msg = {
+        .header = {.type = IPC_CMD_MICROPHONE_ACTIVE},
+    };
+
+    IPC_SEND_MSG(way_ctx, msg);
+
+    if (ret == -1) {
+        perror("[Error] Failed to send IPCMicrophoneActive");
+        exit(MICROPHONE_ACTIVE_EXIT_ERROR);
+    }
+
+    bool response = false;
+    if (IPC_RECV_MSG(way_ctx, addr, &response) == -1) {
+        perror("[Error] Failed to receive IPCMicrophoneActive response");
+        exit(MICROPHONE_ACTIVE_EXIT_ERROR);
+    }
+
+    printf("%s\n", response ? "active" : "inactive");
+
+    return response;
+};
+cmd_tree_node_t microphone_cmd_active = {.name = "active",
+                                         .exec = microphone_active_exec};
+
+cmd_tree_node_t *microphone_cmd() {
+    cmd_tree_node_add_child(&microphone_cmd_root, &microphone_cmd_active);
+    return &microphone_cmd_root;
+};
@@ -1,6 +1,7 @@
 #include <stdio.h>
 
 #include "../lib/cmd_tree/include/cmd_tree.h"
+#include "commands.h"
 
 static int root_exec(void *ctx, uint8_t argc, char **argv) {
     printf(
@@ -9,6 +10,7 @@ static int root_exec(void *ctx, uint8_t argc, char **argv) {
         "Commands: \n"
         "\tmessage-tray\n"
         "\tvolume\n"
+        "\tmicrophone\n"
         "\tbrightness\n"
         "\ttheme\n"
         "\tactivities\n"
@@ -18,6 +20,8 @@ static int root_exec(void *ctx, uint8_t argc, char **argv) {
         "\toutput-switcher\n"
 		"\tbluelight-filter\n"
 		"\trename-switcher\n"
+		"\tcompletion\n"
+		"\tcommands\n"
 	);
     return 0;
 };
@@ -27,4 +31,4 @@ static int root_exec(void *ctx, uint8_t argc, char **argv) {
 //
 // A short help blurb is presented along with a list of all available root level
 // commands.
-cmd_tree_node_t root_cmd = {.exec = root_exec};
+cmd_tree_node_t root_cmd = {.exec = root_exec, .flags = WAY_SH_CMD_LOCAL};
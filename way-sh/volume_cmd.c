@@ -73,26 +73,20 @@ static int volume_down_exec(void *ctx, uint8_t argc, char **argv) {
 };
 cmd_tree_node_t volume_cmd_down = {.name = "down", .exec = volume_down_exec};
 
+static const cmd_tree_arg_t volume_set_args[] = {
+    {.name = "volume", .type = CMD_TREE_ARG_FLOAT, .min = 0.0, .max = 1.0},
+};
+
 static int volume_set_exec(void *ctx, uint8_t argc, char **argv) {
     int ret = 0;
-    char *endptr = NULL;
     way_sh_ctx *way_ctx = ctx;
 
-    if (argc != 1) {
-        printf("Usage: volume set <volume>\n");
-        return -1;
-    }
-
     IPCVolumeSet msg = {
         .header = {.type = IPC_CMD_VOLUME_SET},
     };
 
-    msg.volume = strtof(argv[0], &endptr);
-
-    if (msg.volume < 0.0 || msg.volume > 1.0) {
-        printf("Volume must be a float between 0.0 and 1.0\n");
-        return -1;
-    }
+    // validated against volume_set_args before we are exec'd.
+    msg.volume = strtof(argv[0], NULL);
 
     IPC_SEND_MSG(way_ctx, msg);
 
@@ -106,7 +100,11 @@ static int volume_set_exec(void *ctx, uint8_t argc, char **argv) {
 
     return response;
 };
-cmd_tree_node_t volume_cmd_set = {.name = "set", .exec = volume_set_exec};
+cmd_tree_node_t volume_cmd_set = {.name = "set",
+                                  .exec = volume_set_exec,
+                                  .help = "set the volume (0.0-1.0)",
+                                  .args = volume_set_args,
+                                  .args_n = 1};
 
 static int volume_mute_exec(void *ctx, uint8_t argc, char **argv) {
     int ret = 0;
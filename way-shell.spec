@@ -23,9 +23,7 @@ BuildRequires: pkgconfig(upower-glib)
 BuildRequires: pkgconfig(wireplumber-0.5)
 BuildRequires: pkgconfig(json-glib-1.0)
 BuildRequires: pkgconfig(libnm)
-BuildRequires: pkgconfig(libpulse)
-BuildRequires: pkgconfig(libpulse-simple)
-BuildRequires: pkgconfig(libpulse-mainloop-glib)
+BuildRequires: pkgconfig(gudev-1.0)
 BuildRequires: pkgconfig(wayland-client)
 BuildRequires: pkgconfig(wayland-protocols)
 BuildRequires: pkgconfig(gio-unix-2.0)